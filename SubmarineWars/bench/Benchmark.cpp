@@ -0,0 +1,101 @@
+//
+//  Benchmark.cpp
+//  SubmarineWarsBench
+//
+//  Created by FireWolf on 2019-12-06.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "Benchmark.hpp"
+#include <algorithm>
+#include <numeric>
+
+///
+/// [Constructor] Create a benchmark runner
+///
+/// @param filter Only run benchmarks whose names contain this string; pass `nullptr` to run all benchmarks
+/// @param samples The number of samples of each benchmark
+///
+Benchmark::Benchmark(const char* filter, uint32_t samples) : filter(filter == nullptr ? "" : filter), samples(std::max<uint32_t>(samples, 1))
+{
+
+}
+
+///
+/// Run a benchmark
+///
+/// @param name The benchmark name
+/// @param parameter The benchmark parameter, e.g. the number of entities; 0 if not applicable
+/// @param iterations The number of operations per sample
+/// @param body The benchmark body that performs the given number of operations
+/// @note The body is called once before sampling to warm up caches and lazily initialized resources.
+///
+void Benchmark::run(const char* name, uint32_t parameter, uint64_t iterations, const Body& body)
+{
+    // Guard: The benchmark must match the filter
+    if (!this->filter.empty() && std::string(name).find(this->filter) == std::string::npos)
+    {
+        return;
+    }
+
+    body(iterations);
+
+    std::vector<double> nanoseconds(this->samples);
+
+    for (auto& sample : nanoseconds)
+    {
+        auto start = Clock::now();
+
+        body(iterations);
+
+        sample = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    }
+
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+
+    Result result;
+
+    result.name = name;
+
+    result.parameter = parameter;
+
+    result.iterations = iterations;
+
+    result.samples = this->samples;
+
+    result.min = nanoseconds.front();
+
+    result.median = nanoseconds[nanoseconds.size() / 2];
+
+    result.mean = std::accumulate(nanoseconds.begin(), nanoseconds.end(), 0.0) / nanoseconds.size();
+
+    result.max = nanoseconds.back();
+
+    // Progress goes to stderr; The JSON report is written to its own file
+    fprintf(stderr, "%-40s %8u %14.1f ns/op (min %.1f, max %.1f)\n", name, parameter, result.median, result.min, result.max);
+
+    this->results.push_back(result);
+}
+
+///
+/// Write all results in JSON
+///
+/// @param file The output file
+///
+void Benchmark::write(FILE* file)
+{
+    auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    fprintf(file, "{\"timestamp\":%lld,\"unit\":\"ns/op\",\"benchmarks\":[\n", (long long) timestamp);
+
+    for (size_t index = 0; index < this->results.size(); index++)
+    {
+        const Result& result = this->results[index];
+
+        fprintf(file, "{\"name\":\"%s\",\"parameter\":%u,\"iterations\":%llu,\"samples\":%u,\"min\":%.3f,\"median\":%.3f,\"mean\":%.3f,\"max\":%.3f}%s\n",
+                result.name.c_str(), result.parameter, (unsigned long long) result.iterations, result.samples,
+                result.min, result.median, result.mean, result.max, index + 1 < this->results.size() ? "," : "");
+    }
+
+    fprintf(file, "]}\n");
+}
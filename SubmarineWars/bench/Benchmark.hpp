@@ -0,0 +1,108 @@
+//
+//  Benchmark.hpp
+//  SubmarineWarsBench
+//
+//  Created by FireWolf on 2019-12-06.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef Benchmark_hpp
+#define Benchmark_hpp
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+
+/// A minimal microbenchmark runner that reports the time per operation in JSON
+class Benchmark
+{
+public:
+    /// The clock used to time the benchmarks
+    using Clock = std::chrono::steady_clock;
+
+    /// A benchmark body that performs the given number of operations
+    using Body = std::function<void(uint64_t iterations)>;
+
+    /// The default number of samples of each benchmark
+    static constexpr uint32_t DEF_NUM_SAMPLES = 15;
+
+    /// The result of a benchmark in nanoseconds per operation
+    struct Result
+    {
+        /// The benchmark name
+        std::string name;
+
+        /// The benchmark parameter, e.g. the number of entities; 0 if not applicable
+        uint32_t parameter;
+
+        /// The number of operations per sample
+        uint64_t iterations;
+
+        /// The number of samples
+        uint32_t samples;
+
+        double min;
+
+        double median;
+
+        double mean;
+
+        double max;
+    };
+
+    ///
+    /// [Constructor] Create a benchmark runner
+    ///
+    /// @param filter Only run benchmarks whose names contain this string; pass `nullptr` to run all benchmarks
+    /// @param samples The number of samples of each benchmark
+    ///
+    Benchmark(const char* filter = nullptr, uint32_t samples = DEF_NUM_SAMPLES);
+
+    ///
+    /// Run a benchmark
+    ///
+    /// @param name The benchmark name
+    /// @param parameter The benchmark parameter, e.g. the number of entities; 0 if not applicable
+    /// @param iterations The number of operations per sample
+    /// @param body The benchmark body that performs the given number of operations
+    /// @note The body is called once before sampling to warm up caches and lazily initialized resources.
+    ///
+    void run(const char* name, uint32_t parameter, uint64_t iterations, const Body& body);
+
+    ///
+    /// Write all results in JSON
+    ///
+    /// @param file The output file
+    ///
+    void write(FILE* file);
+
+private:
+    /// The name filter; empty if all benchmarks are run
+    std::string filter;
+
+    /// The number of samples of each benchmark
+    uint32_t samples;
+
+    /// Results of all benchmarks run so far
+    std::vector<Result> results;
+};
+
+///
+/// Prevent the compiler from optimizing away the given value
+///
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+    static const void* volatile sink;
+
+    sink = &value;
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+#endif /* Benchmark_hpp */
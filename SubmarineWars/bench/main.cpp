@@ -0,0 +1,2225 @@
+//
+//  main.cpp
+//  SubmarineWarsBench
+//
+//  Created by FireWolf on 2019-12-06.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string.h>
+#include <math.h>
+
+#define GL3W_IMPLEMENTATION
+#include <gl3w.h>
+#include <GLFW/glfw3.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+#include <SDL_mixer.h>
+
+#include "Foundations/Foundations.hpp"
+#include "World.hpp"
+#include "Benchmark.hpp"
+#include "Systems/CollisionBands.hpp"
+#include "Systems/CollisionBounds.hpp"
+#include "Systems/CollisionBroadphase.hpp"
+#include "Systems/CollisionGrid.hpp"
+#include "Systems/CollisionLayers.hpp"
+#include "Systems/CollisionMask.hpp"
+#include "Systems/CollisionNarrowphase.hpp"
+#include "Systems/CollisionSweep.hpp"
+#include "Systems/SpatialIndex.hpp"
+#include "Systems/SpriteBatch.hpp"
+#include "Systems/ContactCache.hpp"
+
+/// Microbenchmarks of the engine hot paths
+/// @note This class is a friend of the world and the entity manager so that private paths can be measured directly.
+class Benchmarks
+{
+public:
+    ///
+    /// Allocate and release identifiers in batches
+    ///
+    static void freeList(Benchmark& benchmark)
+    {
+        static constexpr uint32_t BATCH_SIZE = 512;
+
+        EntityManager::FreeList freelist;
+
+        int identifiers[BATCH_SIZE];
+
+        benchmark.run("FreeList/AllocFree", BATCH_SIZE, 100 * BATCH_SIZE, [&] (uint64_t iterations)
+        {
+            for (uint64_t batch = 0; batch < iterations / BATCH_SIZE; batch++)
+            {
+                for (auto& identifier : identifiers)
+                {
+                    identifier = freelist.alloc();
+                }
+
+                for (auto identifier : identifiers)
+                {
+                    freelist.free(identifier);
+                }
+            }
+        });
+    }
+
+    ///
+    /// Make, add and remove submarines in batches of varying sizes
+    ///
+    static void entityChurn(Benchmark& benchmark, World& world)
+    {
+        EntityManager* entityManager = world.entityManager;
+
+        for (uint32_t count : {16, 64, 256})
+        {
+            std::vector<Entity::Identifier> identifiers(count);
+
+            benchmark.run("EntityManager/SubmarineChurn", count, 16 * count, [&] (uint64_t iterations)
+            {
+                for (uint64_t batch = 0; batch < iterations / count; batch++)
+                {
+                    for (uint32_t index = 0; index < count; index++)
+                    {
+                        SubmarineI submarine;
+
+                        Position position(64.f + index % 1024, 200.f + index % 400);
+
+                        passert(entityManager->makeSubmarine(submarine, position, Direction::Right, 50.f, Submarine::Type::I, 3),
+                                "Failed to make a submarine.");
+
+                        entityManager->addSubmarine(submarine, Submarine::Type::I);
+
+                        identifiers[index] = submarine.getIdentifier();
+                    }
+
+                    for (auto identifier : identifiers)
+                    {
+                        entityManager->removeSubmarine(identifier);
+                    }
+                }
+            });
+        }
+    }
+
+    ///
+    /// Look up component arrays by their types
+    ///
+    static void componentsForType(Benchmark& benchmark, World& world)
+    {
+        EntityManager* entityManager = world.entityManager;
+
+        benchmark.run("EntityManager/ComponentsForType", 0, 300000, [&] (uint64_t iterations)
+        {
+            for (uint64_t index = 0; index < iterations / 3; index++)
+            {
+                doNotOptimize(entityManager->componentsForType<Position>());
+
+                doNotOptimize(entityManager->componentsForType<Velocity>());
+
+                doNotOptimize(entityManager->componentsForType<Collision>());
+            }
+        });
+    }
+
+    ///
+    /// Update a formatted number label with a new value every time
+    ///
+    static void formattedNumberLabel(Benchmark& benchmark, World& world)
+    {
+        EntityManager* entityManager = world.entityManager;
+
+        uint64_t value = 0;
+
+        benchmark.run("EntityManager/UpdateFormattedNumberLabel", 0, 100000, [&] (uint64_t iterations)
+        {
+            for (uint64_t index = 0; index < iterations; index++)
+            {
+                entityManager->updateScoreLabel(++value);
+            }
+        });
+
+        entityManager->updateScoreLabel(0);
+    }
+
+    ///
+    /// Load and parse stage files
+    ///
+    static void stageLoad(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_STAGES = 26;
+
+        benchmark.run("Stage/Load", NUM_STAGES, NUM_STAGES, [&] (uint64_t iterations)
+        {
+            for (uint64_t index = 0; index < iterations; index++)
+            {
+                Stage stage;
+
+                passert(stage.load(1 + index % NUM_STAGES), "Failed to load the stage %llu.", (unsigned long long) (1 + index % NUM_STAGES));
+            }
+        });
+    }
+
+    ///
+    /// Write and read the save file
+    ///
+    /// @note The save file of the player is preserved.
+    ///
+    static void saveGame(Benchmark& benchmark, World& world)
+    {
+        const char* path = SWDataPath "/SaveData.json";
+
+        // Back up the save file
+        std::ifstream backupFile(path);
+
+        bool hasBackup = backupFile.good();
+
+        std::stringstream backup;
+
+        backup << backupFile.rdbuf();
+
+        backupFile.close();
+
+        benchmark.run("World/SaveGame", 0, 50, [&] (uint64_t iterations)
+        {
+            for (uint64_t index = 0; index < iterations; index++)
+            {
+                world.saveGame();
+            }
+        });
+
+        benchmark.run("World/ReadSaveFromFile", 0, 50, [&] (uint64_t iterations)
+        {
+            World::SaveGame data;
+
+            for (uint64_t index = 0; index < iterations; index++)
+            {
+                passert(world.ReadSaveFromFile(&data), "Failed to read the save file.");
+
+                doNotOptimize(data);
+            }
+        });
+
+        // Restore the save file
+        if (hasBackup)
+        {
+            std::ofstream(path) << backup.str();
+        }
+        else
+        {
+            remove(path);
+        }
+    }
+
+    ///
+    /// Run the collision system on a varying number of submarines spread over the screen
+    ///
+    static void collision(Benchmark& benchmark, World& world)
+    {
+        EntityManager* entityManager = world.entityManager;
+
+        for (uint32_t count : {64, 128, 256, 512, 768})
+        {
+            std::vector<Entity::Identifier> identifiers;
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                SubmarineI submarine;
+
+                // A deterministic grid-like layout that keeps all submarines on screen
+                Position position(64.f + (index * 37) % 1152, 200.f + (index * 53) % 480);
+
+                if (!entityManager->makeSubmarine(submarine, position, Direction::Right, 50.f, Submarine::Type::I, 3))
+                {
+                    pwarning("Only %zu submarines fit in the entity manager.", identifiers.size());
+
+                    break;
+                }
+
+                entityManager->addSubmarine(submarine, Submarine::Type::I);
+
+                identifiers.push_back(submarine.getIdentifier());
+            }
+
+            benchmark.run("CollisionSystem/Update", (uint32_t) identifiers.size(), 100, [&] (uint64_t iterations)
+            {
+                for (uint64_t index = 0; index < iterations; index++)
+                {
+                    world.collisionSystem->update(16.f);
+                }
+            });
+
+            for (auto identifier : identifiers)
+            {
+                entityManager->removeSubmarine(identifier);
+            }
+        }
+    }
+
+    ///
+    /// Rebuild the collision grid and find candidate pairs for a varying number of colliders spread over the screen
+    ///
+    static void collisionGrid(Benchmark& benchmark)
+    {
+        for (uint32_t count : {100, 1000, 10000, 50000})
+        {
+            std::vector<CollisionGrid::AABB> boxes(count);
+
+            // A deterministic pseudo-random layout of boxes between 8 and 24 pixels wide
+            uint32_t seed = 1;
+
+            auto next = [&seed] (float range) -> float
+            {
+                seed = seed * 1664525 + 1013904223;
+
+                return (float) (seed >> 8) / (1 << 24) * range;
+            };
+
+            for (auto& box : boxes)
+            {
+                box.minX = next(1280.f);
+
+                box.minY = next(720.f);
+
+                box.maxX = box.minX + 8.f + next(16.f);
+
+                box.maxY = box.minY + 8.f + next(16.f);
+            }
+
+            CollisionGrid grid;
+
+            passert(grid.init(1280.f, 720.f, 32.f, count), "Failed to initialize the collision grid.");
+
+            benchmark.run("CollisionGrid/Build", count, 20, [&] (uint64_t iterations)
+            {
+                for (uint64_t index = 0; index < iterations; index++)
+                {
+                    grid.build(boxes.data(), count);
+                }
+            });
+
+            benchmark.run("CollisionGrid/CandidatePairs", count, 20, [&] (uint64_t iterations)
+            {
+                for (uint64_t index = 0; index < iterations; index++)
+                {
+                    doNotOptimize(grid.findCandidatePairs().size());
+                }
+            });
+
+            CollisionNarrowphase narrowphase;
+
+            const std::vector<CollisionGrid::Pair>& candidates = grid.findCandidatePairs();
+
+            benchmark.run("CollisionNarrowphase/FindCollisions", count, 20, [&] (uint64_t iterations)
+            {
+                for (uint64_t index = 0; index < iterations; index++)
+                {
+                    doNotOptimize(narrowphase.findCollisions(boxes.data(), candidates).size());
+                }
+            });
+        }
+    }
+
+    ///
+    /// Draw a stress scene of 10k sprites spread over a few textures and layers
+    ///
+    /// @note Requires the GL context of the world; The number of draw calls is logged once.
+    ///
+    static void spriteBatch(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_SPRITES = 10000;
+
+        static constexpr uint32_t NUM_TEXTURES = 4;
+
+        static constexpr uint32_t NUM_LAYERS = 2;
+
+        // 1 x 1 textures keep the fill rate out of the measurement
+        GLuint textures[NUM_TEXTURES];
+
+        glGenTextures(NUM_TEXTURES, textures);
+
+        for (uint32_t index = 0; index < NUM_TEXTURES; index++)
+        {
+            uint8_t pixel[4] = { (uint8_t) (index * 64), 128, 255, 255 };
+
+            glBindTexture(GL_TEXTURE_2D, textures[index]);
+
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        }
+
+        std::vector<GLuint> spriteTextures(NUM_SPRITES);
+
+        std::vector<SpriteBatch::Instance> instances(NUM_SPRITES);
+
+        for (uint32_t index = 0; index < NUM_SPRITES; index++)
+        {
+            vec2 position = { (float) ((index * 37) % 1280), (float) ((index * 53) % 720) };
+
+            spriteTextures[index] = textures[(index * 7) % NUM_TEXTURES];
+
+            instances[index] = { SpriteBatch::makeTransform(position, index * 0.01f, {24.f, 16.f}), {1.f, 1.f, 1.f, 1.f}, (float) (index % 2), 0.f };
+        }
+
+        // Maps the screen in pixels to the normalized device coordinates
+        mat3 projection = { { 2.f / 1280.f, 0.f, 0.f }, { 0.f, -2.f / 720.f, 0.f }, { -1.f, 1.f, 1.f } };
+
+        // The game does not set up the batch, so the benchmark does
+        auto batch = SpriteBatch::shared();
+
+        if (!batch->init())
+        {
+            pserror("Failed to initialize the sprite batch.");
+
+            glDeleteTextures(NUM_TEXTURES, textures);
+
+            return;
+        }
+
+        benchmark.run("SpriteBatch/Draw", NUM_SPRITES, 10, [&] (uint64_t iterations)
+        {
+            for (uint64_t iteration = 0; iteration < iterations; iteration++)
+            {
+                batch->begin(projection, (float) iteration);
+
+                for (uint32_t index = 0; index < NUM_SPRITES; index++)
+                {
+                    batch->draw(spriteTextures[index], instances[index], index % NUM_LAYERS);
+                }
+
+                batch->end();
+
+                // Include the time the driver needs to consume the batch
+                glFinish();
+            }
+        });
+
+        pinfo("The sprite batch draws %u sprites with %u draw calls.", batch->getNumInstances(), batch->getNumDrawCalls());
+
+        glDeleteTextures(NUM_TEXTURES, textures);
+
+        batch->destroy();
+    }
+
+    ///
+    /// Feed the contact cache with overlaps that mostly persist, e.g. explosions sitting over a crowd of fish
+    ///
+    /// @note One in 16 overlaps is replaced every frame.
+    ///
+    static void contactCache(Benchmark& benchmark)
+    {
+        for (uint32_t count : {100, 1000, 10000})
+        {
+            std::vector<CollisionGrid::Pair> overlaps(count);
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                overlaps[index] = {index, count + index};
+            }
+
+            ContactCache cache;
+
+            cache.reserve(count);
+
+            uint32_t next = 2 * count;
+
+            benchmark.run("ContactCache/Update", count, 100, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    for (uint32_t index = (uint32_t) iteration % 16; index < count; index += 16)
+                    {
+                        overlaps[index].second = next++;
+                    }
+
+                    doNotOptimize(cache.update(overlaps.data(), count).size());
+                }
+            });
+        }
+    }
+
+    ///
+    /// Test two submarine-sized masks at increasing horizontal offsets, as upright, flipped and rotated pairs
+    ///
+    /// @note The masks are hull-shaped ellipses, so the corners of overlapping boxes are empty.
+    ///
+    static void collisionMask(Benchmark& benchmark)
+    {
+        static constexpr uint32_t WIDTH = 128;
+
+        static constexpr uint32_t HEIGHT = 48;
+
+        std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4, 0);
+
+        for (uint32_t y = 0; y < HEIGHT; y++)
+        {
+            for (uint32_t x = 0; x < WIDTH; x++)
+            {
+                float dx = (x + 0.5f) / WIDTH - 0.5f;
+
+                float dy = (y + 0.5f) / HEIGHT - 0.5f;
+
+                pixels[(y * WIDTH + x) * 4 + 3] = dx * dx + dy * dy < 0.25f ? 255 : 0;
+            }
+        }
+
+        CollisionMask mask;
+
+        passert(mask.initFromAlpha(pixels.data(), WIDTH, HEIGHT), "Failed to build the collision mask.");
+
+        const CollisionMask& flipped = mask.getVariant(true, 0);
+
+        const CollisionMask& rotated = mask.getVariant(false, 0.5f);
+
+        for (uint32_t offset : {0, 32, 96, 120})
+        {
+            benchmark.run("CollisionMask/Overlaps", offset, 1000, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    float dy = (float) (iteration % 8);
+
+                    doNotOptimize(CollisionMask::overlaps(mask, 0, 0, mask, (float) offset, dy));
+
+                    doNotOptimize(CollisionMask::overlaps(mask, 0, 0, flipped, (float) offset, dy));
+
+                    doNotOptimize(CollisionMask::overlaps(mask, 0, 0, rotated, (float) offset, dy));
+                }
+            });
+        }
+    }
+
+    ///
+    /// Compare the broadphases on layouts derived from all stages
+    ///
+    /// @note Submarines keep to the y-coordinate ranges and move at the velocities of each stage,
+    ///       fish are spread over the water, and a few explosions are scattered among them.
+    ///       Each layout runs with and without the collision layers of the game.
+    ///
+    static void broadphaseStages(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_STAGES = 26;
+
+        // Stages without a submarine count limit keep spawning, so assume a full screen
+        static constexpr uint32_t MAX_NUM_SUBMARINES = 64;
+
+        static constexpr uint32_t NUM_EXPLOSIONS = 8;
+
+        CollisionLayers layers = CollisionLayers::makeDefault();
+
+        for (uint32_t number = 1; number <= NUM_STAGES; number++)
+        {
+            Stage stage;
+
+            passert(stage.load(number), "Failed to load the stage %u.", number);
+
+            std::vector<CollisionGrid::AABB> boxes;
+
+            std::vector<float> velocities;
+
+            std::vector<CollisionBroadphase::Filter> filters;
+
+            uint32_t seed = number;
+
+            auto next = [&seed] (float lower, float upper) -> float
+            {
+                seed = seed * 1664525 + 1013904223;
+
+                return lower + (float) (seed >> 8) / (1 << 24) * (upper - lower);
+            };
+
+            for (auto& type : Submarine::allTypes)
+            {
+                uint32_t limit = stage.getSubmarineCountLimits().at(type);
+
+                uint32_t count = limit == 0 ? MAX_NUM_SUBMARINES : std::min(limit, MAX_NUM_SUBMARINES);
+
+                const Range<float>& yrange = stage.getSubmarineYcoordRange(type);
+
+                const Range<float>& vrange = stage.getSubmarineVelocityRange(type);
+
+                for (uint32_t index = 0; index < count; index++)
+                {
+                    float x = next(0.f, 1280.f);
+
+                    float y = next(yrange.lower, yrange.upper);
+
+                    boxes.push_back({x, y, x + 96.f, y + 32.f});
+
+                    velocities.push_back(next(vrange.lower, vrange.upper) * (index % 2 == 0 ? 1.f : -1.f));
+
+                    filters.push_back(layers.getFilter(Collision::submarine));
+                }
+            }
+
+            for (uint32_t index = 0; index < stage.getFishCount(); index++)
+            {
+                float x = next(0.f, 1280.f);
+
+                float y = next(250.f, 700.f);
+
+                boxes.push_back({x, y, x + 32.f, y + 16.f});
+
+                velocities.push_back(next(-40.f, 40.f));
+
+                filters.push_back(layers.getFilter(Collision::fish));
+            }
+
+            for (uint32_t index = 0; index < NUM_EXPLOSIONS; index++)
+            {
+                float x = next(0.f, 1280.f);
+
+                float y = next(250.f, 700.f);
+
+                boxes.push_back({x, y, x + 64.f, y + 64.f});
+
+                velocities.push_back(0.f);
+
+                filters.push_back(layers.getFilter(Collision::explosion));
+            }
+
+            Benchmarks::broadphases(benchmark, "Stage", number, boxes, velocities);
+
+            Benchmarks::broadphases(benchmark, "StageLayered", number, boxes, velocities, filters.data());
+        }
+    }
+
+    ///
+    /// Compare the broadphases on a varying number of colliders that live in horizontal bands and move along x
+    ///
+    static void broadphaseBands(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_BANDS = 8;
+
+        for (uint32_t count : {1000, 5000, 20000})
+        {
+            std::vector<CollisionGrid::AABB> boxes(count);
+
+            std::vector<float> velocities(count);
+
+            uint32_t seed = count;
+
+            auto next = [&seed] (float range) -> float
+            {
+                seed = seed * 1664525 + 1013904223;
+
+                return (float) (seed >> 8) / (1 << 24) * range;
+            };
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                float x = next(1280.f);
+
+                float y = 250.f + (index % NUM_BANDS) * 56.f + next(16.f);
+
+                boxes[index] = {x, y, x + 8.f + next(16.f), y + 8.f + next(16.f)};
+
+                velocities[index] = next(200.f) - 100.f;
+            }
+
+            Benchmarks::broadphases(benchmark, "Bands", count, boxes, velocities);
+        }
+    }
+
+    ///
+    /// [Helper] Run all broadphases on frames of boxes that move along x and wrap around the screen
+    ///
+    /// @param benchmark The benchmark runner
+    /// @param layout The name of the layout appended to the benchmark names
+    /// @param parameter The benchmark parameter, e.g. the stage number
+    /// @param boxes The initial boxes
+    /// @param velocities The velocity of each box in pixels per second
+    /// @param filters The collision filter of each box; `nullptr` to let all pairs through
+    ///
+    static void broadphases(Benchmark& benchmark, const char* layout, uint32_t parameter, const std::vector<CollisionGrid::AABB>& boxes, const std::vector<float>& velocities, const CollisionBroadphase::Filter* filters = nullptr)
+    {
+        static constexpr float FRAME_TIME = 16.f;
+
+        char name[128];
+
+        uint32_t count = (uint32_t) boxes.size();
+
+        for (auto type : {CollisionBroadphase::Type::Grid, CollisionBroadphase::Type::SweepAndPrune})
+        {
+            std::unique_ptr<CollisionBroadphase> broadphase = CollisionBroadphase::make(type, 1280.f, 720.f, count);
+
+            passert(broadphase != nullptr, "Failed to make the %s broadphase.", CollisionBroadphase::typeToString(type));
+
+            // Both broadphases see the same frames
+            std::vector<CollisionGrid::AABB> frame = boxes;
+
+            broadphase->setFilters(filters);
+
+            snprintf(name, sizeof(name), "Broadphase/%s/%s", CollisionBroadphase::typeToString(type), layout);
+
+            benchmark.run(name, parameter, 60, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    for (uint32_t index = 0; index < count; index++)
+                    {
+                        CollisionGrid::AABB& box = frame[index];
+
+                        float dx = velocities[index] * FRAME_TIME / 1000;
+
+                        // Keep the boxes on screen by wrapping them around
+                        if (box.minX + dx > 1280.f || box.maxX + dx < 0.f)
+                        {
+                            dx -= copysignf(1280.f, dx);
+                        }
+
+                        box.minX += dx;
+
+                        box.maxX += dx;
+                    }
+
+                    broadphase->build(frame.data(), count);
+
+                    doNotOptimize(broadphase->findCandidatePairs().size());
+                }
+            });
+        }
+    }
+
+    ///
+    /// Find the collisions of 20k boxes with 1 to 16 threads
+    ///
+    /// @note The boxes are spread over the screen with a dense cluster in the middle,
+    ///       so that the bands do not hold the same amount of work.
+    ///
+    static void collisionBands(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_BOXES = 20000;
+
+        std::vector<CollisionGrid::AABB> boxes(NUM_BOXES);
+
+        uint32_t seed = 1;
+
+        // A deterministic linear congruential generator in [0, range)
+        auto next = [&] (float range)
+        {
+            seed = seed * 1664525 + 1013904223;
+
+            return (float) (seed >> 8) / (1 << 24) * range;
+        };
+
+        for (uint32_t index = 0; index < NUM_BOXES; index++)
+        {
+            bool clustered = index % 20 == 0;
+
+            float x = clustered ? 600.f + next(80.f) : next(1280.f);
+
+            float y = clustered ? 300.f + next(80.f) : next(720.f);
+
+            boxes[index] = {x, y, x + 4.f + next(12.f), y + 4.f + next(12.f)};
+        }
+
+        for (uint32_t numThreads : {1, 2, 4, 8, 16})
+        {
+            CollisionBands bands;
+
+            passert(bands.init(1280.f, 720.f, CollisionBroadphase::DEF_CELL_SIZE, numThreads, NUM_BOXES), "Failed to initialize the collision bands.");
+
+            benchmark.run("CollisionBands/FindCollisions", numThreads, 20, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    doNotOptimize(bands.findCollisions(boxes.data(), NUM_BOXES).size());
+                }
+            });
+        }
+    }
+
+    ///
+    /// Cull entities of all types against the kill rectangles of the game
+    ///
+    static void collisionBounds(Benchmark& benchmark)
+    {
+        CollisionBounds bounds = CollisionBounds::makeDefault(1280.f, 720.f, 150.f);
+
+        CollisionEventBuffer events;
+
+        for (uint32_t count : {100, 1000})
+        {
+            std::vector<float> xs(count), ys(count);
+
+            std::vector<uint32_t> types(count);
+
+            std::vector<Entity::Identifier> entities(count);
+
+            // About one entity in a hundred is off screen
+            for (uint32_t index = 0; index < count; index++)
+            {
+                xs[index] = index % 100 == 0 ? -10.f : (float) ((index * 37) % 1280);
+
+                ys[index] = (float) (160 + (index * 53) % 540);
+
+                types[index] = index % Collision::NUM_ENTITIES;
+
+                entities[index] = index + 1;
+            }
+
+            benchmark.run("CollisionBounds/Cull", count, 1000, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    events.clear();
+
+                    bounds.cull(xs.data(), ys.data(), types.data(), entities.data(), count, events);
+
+                    doNotOptimize(events.size());
+                }
+            });
+        }
+    }
+
+    ///
+    /// Sweep a screen of colliders where every tenth one is a fast projectile, at growing tick durations
+    ///
+    /// @note Longer ticks stretch the boxes of the projectiles further, so the broadphase yields more candidates.
+    ///
+    static void collisionSweep(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_COLLIDERS = 1000;
+
+        std::vector<CollisionGrid::AABB> boxes(NUM_COLLIDERS);
+
+        std::vector<CollisionSweep::Motion> motions(NUM_COLLIDERS);
+
+        for (uint32_t index = 0; index < NUM_COLLIDERS; index++)
+        {
+            float x = (float) ((index * 37) % 1264);
+
+            float y = (float) ((index * 53) % 704);
+
+            boxes[index] = {x, y, x + 16.f, y + 16.f};
+
+            // Projectiles cross the screen in about a second, while the others drift
+            motions[index] = index % 10 == 0 ? CollisionSweep::Motion{1200.f, index % 20 == 0 ? -400.f : 400.f} : CollisionSweep::Motion{50.f, 0.f};
+        }
+
+        CollisionGrid grid;
+
+        passert(grid.init(1280.f, 720.f, CollisionBroadphase::DEF_CELL_SIZE, NUM_COLLIDERS), "Failed to initialize the collision grid.");
+
+        CollisionSweep sweep;
+
+        for (uint32_t ms : {16, 33, 66})
+        {
+            benchmark.run("CollisionSweep/FindImpacts", ms, 100, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    const std::vector<CollisionGrid::AABB>& swept = sweep.build(boxes.data(), motions.data(), NUM_COLLIDERS, (float) ms);
+
+                    grid.build(swept.data(), NUM_COLLIDERS);
+
+                    doNotOptimize(sweep.findImpacts(boxes.data(), grid.findCandidatePairs()).size());
+                }
+            });
+        }
+    }
+
+    ///
+    /// Query a full screen of entities by box, radius, distance and ray
+    ///
+    /// @note Radar checks query a radius around each submarine for the boat,
+    ///       which replaces a loop over all entities per submarine.
+    ///
+    static void spatialIndex(Benchmark& benchmark)
+    {
+        static constexpr uint32_t NUM_TYPES = 8;
+
+        SpatialIndex* index = SpatialIndex::shared();
+
+        std::vector<uint32_t> result;
+
+        for (uint32_t count : {100, 1000})
+        {
+            passert(index->init(1280.f, 720.f, CollisionBroadphase::DEF_CELL_SIZE, count), "Failed to initialize the spatial index.");
+
+            for (uint32_t entity = 0; entity < count; entity++)
+            {
+                float x = (float) ((entity * 37) % 1264);
+
+                float y = (float) ((entity * 53) % 704);
+
+                index->add(entity, entity % NUM_TYPES, {x, y, x + 16.f, y + 16.f});
+            }
+
+            index->build();
+
+            benchmark.run("SpatialIndex/QueryAABB", count, 1000, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    float x = (float) ((iteration * 97) % 1152);
+
+                    index->queryAABB({x, 300.f, x + 128.f, 364.f}, SpatialIndex::ALL_TYPES, result);
+
+                    doNotOptimize(result.size());
+                }
+            });
+
+            benchmark.run("SpatialIndex/QueryRadius", count, 1000, [&] (uint64_t iterations)
+            {
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    index->queryRadius((float) ((iteration * 97) % 1280), 360.f, 100.f, 1u << 1, result);
+
+                    doNotOptimize(result.size());
+                }
+            });
+
+            benchmark.run("SpatialIndex/Nearest", count, 1000, [&] (uint64_t iterations)
+            {
+                SpatialIndex::Hit hit;
+
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    doNotOptimize(index->nearestOfType((float) ((iteration * 97) % 1280), 360.f, 1u << 2, &hit));
+                }
+            });
+
+            benchmark.run("SpatialIndex/Raycast", count, 1000, [&] (uint64_t iterations)
+            {
+                SpatialIndex::Hit hit;
+
+                for (uint64_t iteration = 0; iteration < iterations; iteration++)
+                {
+                    doNotOptimize(index->raycast((float) ((iteration * 97) % 1280), 720.f, 0.f, -1.f, 1u << 3, &hit));
+                }
+            });
+        }
+
+        // Leave an empty index to the game
+        index->clear();
+
+        index->build();
+    }
+
+    ///
+    /// Test all pairs of a dense cluster of boxes, e.g. an explosion chain over a school of fish
+    ///
+    static void denseCluster(Benchmark& benchmark)
+    {
+        pinfo("The collision narrow phase uses %s.", CollisionNarrowphase::INSTRUCTION_SET);
+
+        for (uint32_t count : {16, 64, 256})
+        {
+            std::vector<CollisionGrid::AABB> boxes(count);
+
+            // All boxes lie within a single 64 x 64 pixels cell
+            for (uint32_t index = 0; index < count; index++)
+            {
+                float x = (float) ((index * 37) % 48);
+
+                float y = (float) ((index * 53) % 48);
+
+                boxes[index] = {x, y, x + 8.f + index % 8, y + 8.f + index % 5};
+            }
+
+            CollisionGrid grid;
+
+            passert(grid.init(64.f, 64.f, 64.f, count), "Failed to initialize the collision grid.");
+
+            grid.build(boxes.data(), count);
+
+            const std::vector<CollisionGrid::Pair>& candidates = grid.findCandidatePairs();
+
+            CollisionNarrowphase narrowphase;
+
+            benchmark.run("CollisionNarrowphase/DenseCluster", count, 100, [&] (uint64_t iterations)
+            {
+                for (uint64_t index = 0; index < iterations; index++)
+                {
+                    doNotOptimize(narrowphase.findCollisions(boxes.data(), candidates).size());
+                }
+            });
+        }
+    }
+};
+
+/// Brute-force correctness checks of the collision modules
+///
+/// Each check compares the output of a module with a plain O(n^2) search over the same colliders,
+/// so a module that gives wrong answers fails the run before any of its timings are reported.
+/// The layouts cover sparse and crowded screens, boxes that span several cells,
+/// boxes that touch exactly on the cell boundaries and boxes that stick out of the screen.
+class Checks
+{
+public:
+    /// An axis-aligned bounding box
+    using AABB = CollisionBroadphase::AABB;
+
+    /// A pair of entry indices
+    using Pair = CollisionBroadphase::Pair;
+
+    ///
+    /// Check that the collision grid reports each overlapping pair exactly once
+    ///
+    /// @return `true` if the candidate pairs hold all overlapping pairs on all layouts, `false` otherwise.
+    /// @note The grid may report pairs that merely share a cell, so its pairs must be a superset of the overlaps.
+    ///
+    static bool collisionGrid()
+    {
+        bool passed = true;
+
+        for (const Layout& layout : Checks::makeLayouts())
+        {
+            uint32_t count = static_cast<uint32_t>(layout.boxes.size());
+
+            CollisionGrid grid;
+
+            if (!grid.init(Checks::WIDTH, Checks::HEIGHT, CollisionBroadphase::DEF_CELL_SIZE, count))
+            {
+                pserror("Failed to initialize the collision grid.");
+
+                return false;
+            }
+
+            grid.build(layout.boxes.data(), count);
+
+            std::vector<Pair> candidates = grid.findCandidatePairs();
+
+            std::vector<Pair> overlaps = Checks::findOverlaps(layout.boxes);
+
+            passed &= Checks::expectOrderedPairs("CollisionGrid", layout.name, candidates);
+
+            passed &= Checks::expectSuperset("CollisionGrid", layout.name, candidates, overlaps);
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check that the narrow phase keeps exactly the overlapping pairs
+    ///
+    /// @return `true` if the narrow phase agrees with the brute-force search on all layouts, `false` otherwise.
+    /// @note Every pair is a candidate, so the result must equal the brute-force pairs in the same order.
+    ///
+    static bool collisionNarrowphase()
+    {
+        bool passed = true;
+
+        CollisionNarrowphase narrowphase;
+
+        for (const Layout& layout : Checks::makeLayouts())
+        {
+            uint32_t count = static_cast<uint32_t>(layout.boxes.size());
+
+            std::vector<Pair> candidates;
+
+            candidates.reserve(count * (count - 1) / 2);
+
+            for (uint32_t first = 0; first < count; first++)
+            {
+                for (uint32_t second = first + 1; second < count; second++)
+                {
+                    candidates.push_back({first, second});
+                }
+            }
+
+            const std::vector<Pair>& collisions = narrowphase.findCollisions(layout.boxes.data(), candidates);
+
+            passed &= Checks::expectPairs("CollisionNarrowphase", layout.name, collisions, Checks::findOverlaps(layout.boxes));
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check that the broadphases with collision filters keep exactly the overlapping pairs of colliding layers
+    ///
+    /// @return `true` if both broadphases agree with the filtered brute-force search on all layouts, `false` otherwise.
+    /// @note The default matrix is checked as well as one where fish also collide with each other,
+    ///       which lets a layer through against itself.
+    ///
+    static bool collisionLayers()
+    {
+        bool passed = true;
+
+        CollisionLayers schooling = CollisionLayers::makeDefault();
+
+        schooling.setCollides(Collision::fish, Collision::fish);
+
+        CollisionNarrowphase narrowphase;
+
+        for (const CollisionLayers& layers : {CollisionLayers::makeDefault(), schooling})
+        {
+            for (const Layout& layout : Checks::makeLayouts())
+            {
+                uint32_t count = static_cast<uint32_t>(layout.boxes.size());
+
+                // Scatter the types so that neighbouring boxes rarely share one
+                std::vector<uint32_t> types(count);
+
+                std::vector<CollisionBroadphase::Filter> filters(count);
+
+                for (uint32_t index = 0; index < count; index++)
+                {
+                    types[index] = (index * 7 + index / 3) % Collision::NUM_ENTITIES;
+
+                    filters[index] = layers.getFilter(types[index]);
+                }
+
+                std::vector<Pair> expected = Checks::findOverlaps(layout.boxes);
+
+                expected.erase(std::remove_if(expected.begin(), expected.end(), [&] (const Pair& pair) { return !layers.collides(types[pair.first], types[pair.second]); }), expected.end());
+
+                for (auto type : {CollisionBroadphase::Type::Grid, CollisionBroadphase::Type::SweepAndPrune})
+                {
+                    std::unique_ptr<CollisionBroadphase> broadphase = CollisionBroadphase::make(type, Checks::WIDTH, Checks::HEIGHT, count);
+
+                    broadphase->setFilters(filters.data());
+
+                    broadphase->build(layout.boxes.data(), count);
+
+                    std::vector<Pair> collisions = narrowphase.findCollisions(layout.boxes.data(), broadphase->findCandidatePairs());
+
+                    Checks::sort(collisions);
+
+                    passed &= Checks::expectPairs(type == CollisionBroadphase::Type::Grid ? "CollisionGrid with layers" : "CollisionSweepAndPrune with layers", layout.name, collisions, expected);
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check that the contact cache reports the changes between the overlaps of consecutive frames
+    ///
+    /// @return `true` if the events of all frames equal the set differences of the overlaps, `false` otherwise.
+    /// @note The boxes drift every frame, an entity is removed every fifth frame,
+    ///       and the overlaps are fed with swapped and duplicate pairs. Stays are reported in the second half.
+    ///
+    static bool contactCache()
+    {
+        static constexpr uint32_t NUM_FRAMES = 30;
+
+        std::vector<AABB> boxes = Checks::makeBoxes(1000, 0.f, 0.f, Checks::WIDTH, Checks::HEIGHT, 8.f, 24.f, 5);
+
+        uint32_t count = static_cast<uint32_t>(boxes.size());
+
+        ContactCache cache;
+
+        // The contacts known after the previous frame, and the exits caused by removals
+        std::vector<Pair> previous, removed;
+
+        bool passed = true;
+
+        for (uint32_t frame = 0; frame < NUM_FRAMES; frame++)
+        {
+            char name[32] = {};
+
+            snprintf(name, sizeof(name), "Drifting (frame %u)", frame);
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                float dx = (float) ((index * 13) % 9) - 4.f;
+
+                float dy = (float) ((index * 7) % 5) - 2.f;
+
+                boxes[index] = {boxes[index].minX + dx, boxes[index].minY + dy, boxes[index].maxX + dx, boxes[index].maxY + dy};
+            }
+
+            if (frame % 5 == 4)
+            {
+                uint32_t entity = (frame * 37) % count;
+
+                cache.removeEntity(entity);
+
+                for (const Pair& pair : previous)
+                {
+                    if (pair.first == entity || pair.second == entity)
+                    {
+                        removed.push_back(pair);
+                    }
+                }
+
+                previous.erase(std::remove_if(previous.begin(), previous.end(), [entity] (const Pair& pair) { return pair.first == entity || pair.second == entity; }), previous.end());
+            }
+
+            cache.setReportsStay(frame >= NUM_FRAMES / 2);
+
+            std::vector<Pair> current = Checks::findOverlaps(boxes);
+
+            // Feed the pairs backwards, with every third one swapped and every fifth one twice
+            std::vector<Pair> overlaps;
+
+            for (uint32_t index = static_cast<uint32_t>(current.size()); index-- > 0;)
+            {
+                const Pair& pair = current[index];
+
+                overlaps.push_back(index % 3 == 0 ? Pair{pair.second, pair.first} : pair);
+
+                if (index % 5 == 0)
+                {
+                    overlaps.push_back(pair);
+                }
+            }
+
+            const std::vector<ContactCache::Event>& events = cache.update(overlaps.data(), static_cast<uint32_t>(overlaps.size()));
+
+            std::vector<Pair> enters, stays, exits;
+
+            for (const ContactCache::Event& event : events)
+            {
+                switch (event.type)
+                {
+                    case ContactCache::Event::Type::Enter:
+                        enters.push_back({event.first, event.second});
+                        break;
+
+                    case ContactCache::Event::Type::Stay:
+                        stays.push_back({event.first, event.second});
+                        break;
+
+                    case ContactCache::Event::Type::Exit:
+                        exits.push_back({event.first, event.second});
+                        break;
+                }
+            }
+
+            Checks::sort(enters);
+
+            Checks::sort(stays);
+
+            Checks::sort(exits);
+
+            // The reference events are plain set differences of the sorted overlaps
+            std::vector<Pair> expectedEnters, expectedStays, expectedExits;
+
+            std::set_difference(current.begin(), current.end(), previous.begin(), previous.end(), std::back_inserter(expectedEnters), Checks::isLess);
+
+            std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(), std::back_inserter(expectedExits), Checks::isLess);
+
+            if (frame >= NUM_FRAMES / 2)
+            {
+                std::set_intersection(current.begin(), current.end(), previous.begin(), previous.end(), std::back_inserter(expectedStays), Checks::isLess);
+            }
+
+            expectedExits.insert(expectedExits.end(), removed.begin(), removed.end());
+
+            Checks::sort(expectedExits);
+
+            passed &= Checks::expectPairs("ContactCache enters", name, enters, expectedEnters);
+
+            passed &= Checks::expectPairs("ContactCache stays", name, stays, expectedStays);
+
+            passed &= Checks::expectPairs("ContactCache exits", name, exits, expectedExits);
+
+            if (cache.getNumContacts() != current.size())
+            {
+                pserror("ContactCache holds %u contacts instead of %zu on the %s layout.", cache.getNumContacts(), current.size(), name);
+
+                passed = false;
+            }
+
+            previous.swap(current);
+
+            removed.clear();
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check that the swept collision tests find the pairs that touch at any time during the tick
+    ///
+    /// @return `true` if the impacts found through the grid equal a sweep of every pair, and the sweeps agree with sub-stepping, `false` otherwise.
+    /// @note One collider in four is a fast projectile, some of which move along a single axis.
+    ///       Sub-stepping at 64 steps per tick may miss brief contacts, but the sweep must report every contact a step finds,
+    ///       no later than that step. Contacts that merely touch within the tolerance may go either way.
+    ///
+    static bool collisionSweep()
+    {
+        static constexpr uint32_t NUM_STEPS = 64;
+
+        static constexpr float TOLERANCE = 1e-3f;
+
+        bool passed = true;
+
+        CollisionSweep sweep;
+
+        auto isLess = [] (const CollisionSweep::Impact& lhs, const CollisionSweep::Impact& rhs)
+        {
+            return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+        };
+
+        for (const Layout& layout : Checks::makeLayouts())
+        {
+            uint32_t count = static_cast<uint32_t>(layout.boxes.size());
+
+            std::vector<CollisionSweep::Motion> motions(count);
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                if (index % 4 == 0)
+                {
+                    motions[index] = {index % 8 == 0 ? 1200.f : -900.f, (float) ((index / 4) % 3) * 600.f - 600.f};
+                }
+                else
+                {
+                    motions[index] = {(float) (index % 7) * 20.f - 60.f, (float) (index % 5) * 20.f - 40.f};
+                }
+            }
+
+            CollisionGrid grid;
+
+            if (!grid.init(Checks::WIDTH, Checks::HEIGHT, CollisionBroadphase::DEF_CELL_SIZE, count))
+            {
+                pserror("Failed to initialize the collision grid.");
+
+                return false;
+            }
+
+            for (uint32_t ms : {16, 33, 100})
+            {
+                char name[32] = {};
+
+                snprintf(name, sizeof(name), "%s (%u ms)", layout.name, ms);
+
+                grid.build(sweep.build(layout.boxes.data(), motions.data(), count, (float) ms).data(), count);
+
+                std::vector<CollisionSweep::Impact> impacts = sweep.findImpacts(layout.boxes.data(), grid.findCandidatePairs());
+
+                std::sort(impacts.begin(), impacts.end(), isLess);
+
+                // Pass 1: Sweep every pair and compare with the pairs found through the grid
+                std::vector<CollisionSweep::Impact> expected;
+
+                for (uint32_t first = 0; first < count; first++)
+                {
+                    for (uint32_t second = first + 1; second < count; second++)
+                    {
+                        float time = 0;
+
+                        if (Checks::sweep(layout.boxes[first], motions[first], layout.boxes[second], motions[second], (float) ms, &time))
+                        {
+                            expected.push_back({first, second, time});
+                        }
+                    }
+                }
+
+                std::vector<Pair> pairs, expectedPairs;
+
+                for (const CollisionSweep::Impact& impact : impacts)
+                {
+                    pairs.push_back({impact.first, impact.second});
+                }
+
+                for (const CollisionSweep::Impact& impact : expected)
+                {
+                    expectedPairs.push_back({impact.first, impact.second});
+                }
+
+                if (!Checks::expectPairs("CollisionSweep", name, pairs, expectedPairs))
+                {
+                    passed = false;
+
+                    continue;
+                }
+
+                for (uint32_t index = 0; index < impacts.size(); index++)
+                {
+                    if (fabsf(impacts[index].time - expected[index].time) > TOLERANCE)
+                    {
+                        pserror("CollisionSweep reports the pair (%u, %u) at %.4f instead of %.4f on the %s layout.",
+                                impacts[index].first, impacts[index].second, impacts[index].time, expected[index].time, name);
+
+                        passed = false;
+
+                        break;
+                    }
+                }
+
+                // Pass 2: The boxes of each swept pair must touch at the reported time
+                for (const CollisionSweep::Impact& impact : expected)
+                {
+                    const AABB a = Checks::getBoxAt(layout.boxes[impact.first], motions[impact.first], (float) ms, impact.time, TOLERANCE);
+
+                    const AABB b = Checks::getBoxAt(layout.boxes[impact.second], motions[impact.second], (float) ms, impact.time);
+
+                    if (!Checks::overlaps(a, b))
+                    {
+                        pserror("CollisionSweep::sweep() reports the pair (%u, %u) at %.4f, but the boxes are apart then on the %s layout.", impact.first, impact.second, impact.time, name);
+
+                        passed = false;
+
+                        break;
+                    }
+                }
+
+                // Pass 3: Step the pairs with a fast collider through the tick
+                std::vector<AABB> paths(count);
+
+                for (uint32_t index = 0; index < count; index++)
+                {
+                    const AABB start = Checks::getBoxAt(layout.boxes[index], motions[index], (float) ms, 0.f);
+
+                    const AABB& end = layout.boxes[index];
+
+                    paths[index] = {std::min(start.minX, end.minX), std::min(start.minY, end.minY), std::max(start.maxX, end.maxX), std::max(start.maxY, end.maxY)};
+                }
+
+                for (uint32_t first = 0; first < count; first++)
+                {
+                    for (uint32_t second = first + 1; second < count; second++)
+                    {
+                        // Guard: Skip the slow pairs and the pairs whose paths are apart
+                        if ((!Checks::isFast(motions[first]) && !Checks::isFast(motions[second])) || !Checks::overlaps(paths[first], paths[second]))
+                        {
+                            continue;
+                        }
+
+                        for (uint32_t step = 0; step <= NUM_STEPS; step++)
+                        {
+                            float time = (float) step / NUM_STEPS;
+
+                            // The boxes must overlap by more than the tolerance
+                            const AABB a = Checks::getBoxAt(layout.boxes[first], motions[first], (float) ms, time, -TOLERANCE);
+
+                            const AABB b = Checks::getBoxAt(layout.boxes[second], motions[second], (float) ms, time);
+
+                            if (!Checks::overlaps(a, b))
+                            {
+                                continue;
+                            }
+
+                            auto found = std::lower_bound(expected.begin(), expected.end(), CollisionSweep::Impact{first, second, 0.f}, isLess);
+
+                            if (found == expected.end() || found->first != first || found->second != second || found->time > time + TOLERANCE)
+                            {
+                                pserror("CollisionSweep::sweep() misses the pair (%u, %u) that touches at %.4f on the %s layout.", first, second, time, name);
+
+                                passed = false;
+                            }
+
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check that the bounds culling reports the entities outside their rectangles
+    ///
+    /// @return `true` if the events equal a test of each entity against the rectangle of its type, `false` otherwise.
+    /// @note Every third type has no rectangle, some sides are unbounded, and every seventh entity lies on an edge,
+    ///       which is inside. The counts leave partial batches.
+    ///
+    static bool collisionBounds()
+    {
+        static const CollisionEvent::Type EVENTS[] =
+        {
+            CollisionEvent::Type::SubmarineDidMoveOutOfScreen,
+            CollisionEvent::Type::BombDidMoveOutOfScreen,
+            CollisionEvent::Type::MissileDidMoveOutOfScreen,
+            CollisionEvent::Type::TorpedoDidMoveOutOfOceanSurface,
+            CollisionEvent::Type::SmokeDidMoveOutOfScreen
+        };
+
+        uint32_t seed = 6;
+
+        auto next = [&seed] (float range) -> float
+        {
+            seed = seed * 1664525 + 1013904223;
+
+            return (float) (seed >> 8) / (1 << 24) * range;
+        };
+
+        // The rectangle and the event of each type
+        CollisionBounds bounds;
+
+        AABB rectangles[CollisionBounds::MAX_NUM_TYPES];
+
+        for (uint32_t type = 0; type < CollisionBounds::MAX_NUM_TYPES; type++)
+        {
+            if (type % 3 == 0)
+            {
+                bounds.clearBounds(type);
+
+                rectangles[type] = {-INFINITY, -INFINITY, INFINITY, INFINITY};
+
+                continue;
+            }
+
+            AABB rectangle = {next(200.f), next(200.f), Checks::WIDTH - next(200.f), Checks::HEIGHT - next(200.f)};
+
+            if (type % 4 == 1)
+            {
+                rectangle.minX = -INFINITY;
+            }
+
+            if (type % 5 == 2)
+            {
+                rectangle.maxY = INFINITY;
+            }
+
+            rectangles[type] = rectangle;
+
+            if (!bounds.setBounds(type, rectangle, EVENTS[type % 5]))
+            {
+                pserror("Failed to set the bounds of type %u.", type);
+
+                return false;
+            }
+        }
+
+        bool passed = true;
+
+        for (uint32_t count : {0, 5, 1003})
+        {
+            std::vector<float> xs(count), ys(count);
+
+            std::vector<uint32_t> types(count);
+
+            std::vector<Entity::Identifier> entities(count);
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                types[index] = (index * 5 + index / 7) % CollisionBounds::MAX_NUM_TYPES;
+
+                entities[index] = index + 1;
+
+                const AABB& rectangle = rectangles[types[index]];
+
+                xs[index] = next(Checks::WIDTH + 200.f) - 100.f;
+
+                ys[index] = next(Checks::HEIGHT + 200.f) - 100.f;
+
+                if (index % 7 == 0 && rectangle.maxX != INFINITY)
+                {
+                    xs[index] = rectangle.maxX;
+                }
+
+                if (index % 7 == 0 && rectangle.minY != -INFINITY)
+                {
+                    ys[index] = rectangle.minY;
+                }
+            }
+
+            CollisionEventBuffer events;
+
+            bounds.cull(xs.data(), ys.data(), types.data(), entities.data(), count, events);
+
+            // Test each entity on its own
+            CollisionEventBuffer expected;
+
+            for (uint32_t index = 0; index < count; index++)
+            {
+                const AABB& rectangle = rectangles[types[index]];
+
+                if (xs[index] < rectangle.minX || xs[index] > rectangle.maxX || ys[index] < rectangle.minY || ys[index] > rectangle.maxY)
+                {
+                    expected.push(EVENTS[types[index] % 5], entities[index]);
+                }
+            }
+
+            auto isEqual = [] (const CollisionEvent& lhs, const CollisionEvent& rhs)
+            {
+                return lhs.type == rhs.type && lhs.first == rhs.first && lhs.second == rhs.second;
+            };
+
+            if (events.size() != expected.size() || !std::equal(events.begin(), events.end(), expected.begin(), isEqual))
+            {
+                auto mismatch = std::mismatch(events.begin(), events.end(), expected.begin(), expected.end(), isEqual);
+
+                pserror("CollisionBounds reports %u events instead of %u for %u entities; The first difference is at event %zu.",
+                        events.size(), expected.size(), count, static_cast<size_t>(mismatch.first - events.begin()));
+
+                passed = false;
+            }
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check that the banded search finds the same pairs in the same order as a single thread
+    ///
+    /// @return `true` if the bands agree with the grid followed by the narrow phase on all layouts and thread counts, `false` otherwise.
+    /// @note Each search runs twice, so that the reused buffers are checked as well.
+    ///
+    static bool collisionBands()
+    {
+        bool passed = true;
+
+        CollisionNarrowphase narrowphase;
+
+        for (const Layout& layout : Checks::makeLayouts())
+        {
+            uint32_t count = static_cast<uint32_t>(layout.boxes.size());
+
+            CollisionGrid grid;
+
+            if (!grid.init(Checks::WIDTH, Checks::HEIGHT, CollisionBroadphase::DEF_CELL_SIZE, count))
+            {
+                pserror("Failed to initialize the collision grid.");
+
+                return false;
+            }
+
+            grid.build(layout.boxes.data(), count);
+
+            std::vector<Pair> expected = narrowphase.findCollisions(layout.boxes.data(), grid.findCandidatePairs());
+
+            for (uint32_t numThreads : {1, 2, 4, 8, 16})
+            {
+                CollisionBands bands;
+
+                if (!bands.init(Checks::WIDTH, Checks::HEIGHT, CollisionBroadphase::DEF_CELL_SIZE, numThreads, count))
+                {
+                    pserror("Failed to initialize the collision bands.");
+
+                    return false;
+                }
+
+                char name[32] = {};
+
+                snprintf(name, sizeof(name), "%s (%u threads)", layout.name, numThreads);
+
+                for (uint32_t run = 0; run < 2; run++)
+                {
+                    passed &= Checks::expectPairs("CollisionBands", name, bands.findCollisions(layout.boxes.data(), count), expected);
+                }
+            }
+        }
+
+        return passed;
+    }
+
+    ///
+    /// Check the collision masks pixel by pixel
+    ///
+    /// @return `true` if the masks hold the opaque pixels of their images, the flipped and rotated variants sample their sources,
+    ///         and `CollisionMask::overlaps()` agrees with a test of every pixel of the overlap region, `false` otherwise.
+    /// @note The widths are mostly not multiples of 64, so the words of the overlap region start at unaligned columns
+    ///       and the last word of a row is partial. Quarter turns must permute the pixels exactly;
+    ///       Other angles may differ only where a pixel center falls within the tolerance of a source pixel edge.
+    ///
+    static bool collisionMask()
+    {
+        static constexpr float TWO_PI = 6.28318530718f;
+
+        static constexpr double TOLERANCE = 1e-3;
+
+        struct Image
+        {
+            uint32_t width;
+
+            uint32_t height;
+
+            /// One opaque pixel in `density` on average
+            uint32_t density;
+        };
+
+        static const Image IMAGES[] = {{65, 7, 6}, {130, 24, 20}, {1, 1, 1}, {200, 3, 30}, {64, 5, 10}};
+
+        static constexpr uint32_t NUM_IMAGES = sizeof(IMAGES) / sizeof(IMAGES[0]);
+
+        uint32_t seed = 7;
+
+        bool passed = true;
+
+        std::unique_ptr<CollisionMask[]> masks(new CollisionMask[NUM_IMAGES]);
+
+        // Pass 1: The masks hold exactly the opaque pixels of their images
+        for (uint32_t index = 0; index < NUM_IMAGES; index++)
+        {
+            const Image& image = IMAGES[index];
+
+            std::vector<uint8_t> pixels(image.width * image.height * 4, 0);
+
+            for (uint32_t pixel = 0; pixel < image.width * image.height; pixel++)
+            {
+                seed = seed * 1664525 + 1013904223;
+
+                // The alpha straddles the threshold; The first and last columns are always opaque
+                uint32_t x = pixel % image.width;
+
+                bool opaque = (seed >> 8) % image.density == 0 || x == 0 || x == image.width - 1;
+
+                pixels[pixel * 4 + 3] = opaque ? CollisionMask::DEF_ALPHA_THRESHOLD : CollisionMask::DEF_ALPHA_THRESHOLD - 1;
+            }
+
+            if (!masks[index].initFromAlpha(pixels.data(), image.width, image.height))
+            {
+                pserror("Failed to build the collision mask of %u x %u pixels.", image.width, image.height);
+
+                return false;
+            }
+
+            for (uint32_t pixel = 0; pixel < image.width * image.height; pixel++)
+            {
+                if (masks[index].test(pixel % image.width, pixel / image.width) != (pixels[pixel * 4 + 3] >= CollisionMask::DEF_ALPHA_THRESHOLD))
+                {
+                    pserror("CollisionMask of %u x %u pixels differs from its image at (%u, %u).", image.width, image.height, pixel % image.width, pixel / image.width);
+
+                    passed = false;
+
+                    break;
+                }
+            }
+        }
+
+        // Pass 2: The variants sample their sources through the inverse transform
+        for (uint32_t index = 0; index < NUM_IMAGES; index++)
+        {
+            const CollisionMask& source = masks[index];
+
+            for (bool flipX : {false, true})
+            {
+                for (uint32_t step = 0; step < CollisionMask::NUM_ROTATIONS; step++)
+                {
+                    const CollisionMask& variant = masks[index].getVariant(flipX, step * TWO_PI / CollisionMask::NUM_ROTATIONS);
+
+                    double radians = step * 2 * M_PI / CollisionMask::NUM_ROTATIONS;
+
+                    double cosine = cos(radians), sine = sin(radians);
+
+                    bool isQuarterTurn = step % (CollisionMask::NUM_ROTATIONS / 4) == 0;
+
+                    // Guard: Quarter turns keep or swap the sides
+                    if (isQuarterTurn && (step % (CollisionMask::NUM_ROTATIONS / 2) == 0 ? variant.getWidth() != source.getWidth() || variant.getHeight() != source.getHeight()
+                                                                                          : variant.getWidth() != source.getHeight() || variant.getHeight() != source.getWidth()))
+                    {
+                        pserror("CollisionMask of %u x %u pixels turned by step %u is %u x %u pixels.", source.getWidth(), source.getHeight(), step, variant.getWidth(), variant.getHeight());
+
+                        passed = false;
+
+                        continue;
+                    }
+
+                    for (uint32_t y = 0; y < variant.getHeight(); y++)
+                    {
+                        for (uint32_t x = 0; x < variant.getWidth(); x++)
+                        {
+                            double dx = x + 0.5 - variant.getWidth() * 0.5;
+
+                            double dy = y + 0.5 - variant.getHeight() * 0.5;
+
+                            double sx = (flipX ? -1 : 1) * (cosine * dx + sine * dy) + source.getWidth() * 0.5;
+
+                            double sy = cosine * dy - sine * dx + source.getHeight() * 0.5;
+
+                            // Guard: Samples on a pixel edge may go either way, except for quarter turns, which sample pixel centers
+                            if (!isQuarterTurn && (fabs(sx - round(sx)) < TOLERANCE || fabs(sy - round(sy)) < TOLERANCE))
+                            {
+                                continue;
+                            }
+
+                            bool expected = sx >= 0 && sx < source.getWidth() && sy >= 0 && sy < source.getHeight() && source.test((uint32_t) sx, (uint32_t) sy);
+
+                            if (variant.test(x, y) != expected)
+                            {
+                                pserror("CollisionMask of %u x %u pixels %s by step %u differs from its source at (%u, %u).",
+                                        source.getWidth(), source.getHeight(), flipX ? "flipped and turned" : "turned", step, x, y);
+
+                                passed = false;
+
+                                // Leave both loops
+                                y = variant.getHeight();
+
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Pass 3: Place every pair of masks and variants at all offsets around each other
+        std::vector<const CollisionMask*> operands;
+
+        for (uint32_t index = 0; index < NUM_IMAGES; index++)
+        {
+            operands.push_back(&masks[index]);
+        }
+
+        operands.push_back(&masks[1].getVariant(true, 0));
+
+        operands.push_back(&masks[1].getVariant(false, 5 * TWO_PI / CollisionMask::NUM_ROTATIONS));
+
+        operands.push_back(&masks[0].getVariant(false, 16 * TWO_PI / CollisionMask::NUM_ROTATIONS));
+
+        operands.push_back(&masks[3].getVariant(true, 37 * TWO_PI / CollisionMask::NUM_ROTATIONS));
+
+        for (const CollisionMask* first : operands)
+        {
+            for (const CollisionMask* second : operands)
+            {
+                int32_t width1 = static_cast<int32_t>(first->getWidth()), height1 = static_cast<int32_t>(first->getHeight());
+
+                int32_t width2 = static_cast<int32_t>(second->getWidth()), height2 = static_cast<int32_t>(second->getHeight());
+
+                bool agrees = true;
+
+                // The second mask moves around the first one, whose top left corner is at the origin
+                for (int32_t top = -height2 - 1; top <= height1 + 1 && agrees; top++)
+                {
+                    for (int32_t left = -width2 - 1; left <= width1 + 1 && agrees; left++)
+                    {
+                        // Centers that place the corners on whole pixels
+                        bool overlaps = CollisionMask::overlaps(*first, width1 * 0.5f, height1 * 0.5f, *second, left + width2 * 0.5f, top + height2 * 0.5f);
+
+                        if (overlaps != Checks::overlaps(*first, *second, left, top))
+                        {
+                            pserror("CollisionMask::overlaps() of %d x %d and %d x %d pixels is wrong with the second mask at (%d, %d).", width1, height1, width2, height2, left, top);
+
+                            agrees = false;
+                        }
+                    }
+                }
+
+                passed &= agrees;
+            }
+        }
+
+        return passed;
+    }
+
+private:
+    /// The size of the screen covered by the layouts
+    static constexpr float WIDTH = 1280.f;
+
+    static constexpr float HEIGHT = 720.f;
+
+    /// A named set of colliders
+    struct Layout
+    {
+        const char* name;
+
+        std::vector<AABB> boxes;
+    };
+
+    ///
+    /// [Helper] Make the layouts tested by the checks
+    ///
+    static std::vector<Layout> makeLayouts()
+    {
+        std::vector<Layout> layouts;
+
+        // Small boxes spread over the screen
+        layouts.push_back({"Sparse", Checks::makeBoxes(1000, 0.f, 0.f, Checks::WIDTH, Checks::HEIGHT, 8.f, 24.f, 1)});
+
+        // A crowd of boxes in a single cell, e.g. an explosion over a school of fish
+        layouts.push_back({"Dense", Checks::makeBoxes(300, 0.f, 0.f, 48.f, 48.f, 4.f, 16.f, 2)});
+
+        // Boxes that span several cells
+        layouts.push_back({"Large", Checks::makeBoxes(200, 0.f, 0.f, Checks::WIDTH, Checks::HEIGHT, 8.f, 240.f, 3)});
+
+        // Boxes that stick out of the screen, or lie beyond it
+        layouts.push_back({"Outside", Checks::makeBoxes(300, -200.f, -200.f, Checks::WIDTH + 400.f, Checks::HEIGHT + 400.f, 8.f, 64.f, 4)});
+
+        // A lattice of boxes whose edges touch their neighbours on the cell boundaries
+        Layout touching = {"Touching", {}};
+
+        for (float y = 0; y < Checks::HEIGHT; y += 32.f)
+        {
+            for (float x = 0; x < Checks::WIDTH; x += 32.f)
+            {
+                touching.boxes.push_back({x, y, x + 32.f, y + 32.f});
+            }
+        }
+
+        layouts.push_back(touching);
+
+        return layouts;
+    }
+
+    ///
+    /// [Helper] Make a deterministic pseudo-random set of boxes
+    ///
+    /// @param count The number of boxes
+    /// @param x The left edge of the area the boxes start in
+    /// @param y The top edge of the area the boxes start in
+    /// @param width The width of the area
+    /// @param height The height of the area
+    /// @param minSize The minimum width and height of a box
+    /// @param maxSize The maximum width and height of a box
+    /// @param seed The seed of the generator
+    ///
+    static std::vector<AABB> makeBoxes(uint32_t count, float x, float y, float width, float height, float minSize, float maxSize, uint32_t seed)
+    {
+        auto next = [&seed] (float range) -> float
+        {
+            seed = seed * 1664525 + 1013904223;
+
+            return (float) (seed >> 8) / (1 << 24) * range;
+        };
+
+        std::vector<AABB> boxes(count);
+
+        for (auto& box : boxes)
+        {
+            box.minX = x + next(width);
+
+            box.minY = y + next(height);
+
+            box.maxX = box.minX + minSize + next(maxSize - minSize);
+
+            box.maxY = box.minY + minSize + next(maxSize - minSize);
+        }
+
+        return boxes;
+    }
+
+    ///
+    /// [Helper] Test whether two boxes overlap; Touching boxes overlap
+    ///
+    static inline bool overlaps(const AABB& a, const AABB& b)
+    {
+        return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+    }
+
+    ///
+    /// [Helper] Test whether two masks share an opaque pixel by testing every pixel of the overlap region
+    ///
+    /// @param first The first mask; Its top left corner is at the origin
+    /// @param second The second mask
+    /// @param left The x-coordinate of the top left corner of the second mask
+    /// @param top The y-coordinate of the top left corner of the second mask
+    ///
+    static bool overlaps(const CollisionMask& first, const CollisionMask& second, int32_t left, int32_t top)
+    {
+        for (int32_t y = std::max(0, top); y < std::min(static_cast<int32_t>(first.getHeight()), top + static_cast<int32_t>(second.getHeight())); y++)
+        {
+            for (int32_t x = std::max(0, left); x < std::min(static_cast<int32_t>(first.getWidth()), left + static_cast<int32_t>(second.getWidth())); x++)
+            {
+                if (first.test(x, y) && second.test(x - left, y - top))
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    ///
+    /// [Helper] Check whether a collider moves fast enough to be swept
+    ///
+    static inline bool isFast(const CollisionSweep::Motion& motion)
+    {
+        return motion.vx * motion.vx + motion.vy * motion.vy > CollisionSweep::DEF_SPEED_THRESHOLD * CollisionSweep::DEF_SPEED_THRESHOLD;
+    }
+
+    ///
+    /// [Helper] Get the box of a collider at the given fraction of the tick
+    ///
+    /// @param box The box at the end of the tick
+    /// @param motion The velocity of the collider
+    /// @param ms The duration of the tick in milliseconds
+    /// @param time The fraction of the tick
+    /// @param margin The distance by which the box is widened; Pass a negative value to narrow it
+    /// @return The box at the given time; Slow colliders rest at their end positions.
+    ///
+    static AABB getBoxAt(const AABB& box, const CollisionSweep::Motion& motion, float ms, float time, float margin = 0)
+    {
+        float back = Checks::isFast(motion) ? (1.f - time) * ms / 1000 : 0.f;
+
+        float dx = motion.vx * back;
+
+        float dy = motion.vy * back;
+
+        return {box.minX - dx - margin, box.minY - dy - margin, box.maxX - dx + margin, box.maxY - dy + margin};
+    }
+
+    ///
+    /// [Helper] Sweep a pair of colliders from their start positions
+    ///
+    /// @param a The box of the first collider at the end of the tick
+    /// @param ma The velocity of the first collider
+    /// @param b The box of the second collider at the end of the tick
+    /// @param mb The velocity of the second collider
+    /// @param ms The duration of the tick in milliseconds
+    /// @param time The fraction of the tick at which the boxes first touch on return; 1 for a pair of slow colliders
+    /// @return `true` if the boxes touch during the tick, `false` otherwise.
+    ///
+    static bool sweep(const AABB& a, const CollisionSweep::Motion& ma, const AABB& b, const CollisionSweep::Motion& mb, float ms, float* time)
+    {
+        // Slow pairs are tested where they stand
+        if (!Checks::isFast(ma) && !Checks::isFast(mb))
+        {
+            *time = 1.f;
+
+            return Checks::overlaps(a, b);
+        }
+
+        // Slow colliders rest at their end positions
+        float dxa = Checks::isFast(ma) ? ma.vx * ms / 1000 : 0.f, dya = Checks::isFast(ma) ? ma.vy * ms / 1000 : 0.f;
+
+        float dxb = Checks::isFast(mb) ? mb.vx * ms / 1000 : 0.f, dyb = Checks::isFast(mb) ? mb.vy * ms / 1000 : 0.f;
+
+        AABB startA = {a.minX - dxa, a.minY - dya, a.maxX - dxa, a.maxY - dya};
+
+        AABB startB = {b.minX - dxb, b.minY - dyb, b.maxX - dxb, b.maxY - dyb};
+
+        return CollisionSweep::sweep(startA, dxa - dxb, dya - dyb, startB, time);
+    }
+
+    ///
+    /// [Helper] Find all overlapping pairs by testing every pair
+    ///
+    /// @param boxes The boxes to test
+    /// @return The overlapping pairs, sorted by their first and then their second index.
+    ///
+    static std::vector<Pair> findOverlaps(const std::vector<AABB>& boxes)
+    {
+        std::vector<Pair> pairs;
+
+        for (uint32_t first = 0; first < boxes.size(); first++)
+        {
+            for (uint32_t second = first + 1; second < boxes.size(); second++)
+            {
+                if (Checks::overlaps(boxes[first], boxes[second]))
+                {
+                    pairs.push_back({first, second});
+                }
+            }
+        }
+
+        return pairs;
+    }
+
+    ///
+    /// [Helper] Sort pairs by their first and then their second index
+    ///
+    static void sort(std::vector<Pair>& pairs)
+    {
+        std::sort(pairs.begin(), pairs.end(), Checks::isLess);
+    }
+
+    static inline bool isLess(const Pair& lhs, const Pair& rhs)
+    {
+        return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    }
+
+    static inline bool isEqual(const Pair& lhs, const Pair& rhs)
+    {
+        return lhs.first == rhs.first && lhs.second == rhs.second;
+    }
+
+    ///
+    /// [Helper] Check that each pair holds its smaller index first and is reported once
+    ///
+    static bool expectOrderedPairs(const char* module, const char* layout, std::vector<Pair> pairs)
+    {
+        for (const Pair& pair : pairs)
+        {
+            if (pair.first >= pair.second)
+            {
+                pserror("%s reports the unordered pair (%u, %u) on the %s layout.", module, pair.first, pair.second, layout);
+
+                return false;
+            }
+        }
+
+        Checks::sort(pairs);
+
+        auto duplicate = std::adjacent_find(pairs.begin(), pairs.end(), Checks::isEqual);
+
+        if (duplicate != pairs.end())
+        {
+            pserror("%s reports the pair (%u, %u) more than once on the %s layout.", module, duplicate->first, duplicate->second, layout);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    ///
+    /// [Helper] Check that the reported pairs equal the expected pairs in the same order
+    ///
+    static bool expectPairs(const char* module, const char* layout, const std::vector<Pair>& pairs, const std::vector<Pair>& expected)
+    {
+        auto mismatch = std::mismatch(pairs.begin(), pairs.end(), expected.begin(), expected.end(), Checks::isEqual);
+
+        if (mismatch.first == pairs.end() && mismatch.second == expected.end())
+        {
+            return true;
+        }
+
+        // The pair that comes first in sorted order is the one out of place
+        if (mismatch.second == expected.end() || (mismatch.first != pairs.end() && Checks::isLess(*mismatch.first, *mismatch.second)))
+        {
+            pserror("%s reports the extra pair (%u, %u) on the %s layout.", module, mismatch.first->first, mismatch.first->second, layout);
+        }
+        else
+        {
+            pserror("%s misses the expected pair (%u, %u) on the %s layout.", module, mismatch.second->first, mismatch.second->second, layout);
+        }
+
+        return false;
+    }
+
+    ///
+    /// [Helper] Check that the reported pairs hold all expected pairs
+    ///
+    /// @param expected The expected pairs, sorted
+    ///
+    static bool expectSuperset(const char* module, const char* layout, std::vector<Pair> pairs, const std::vector<Pair>& expected)
+    {
+        Checks::sort(pairs);
+
+        for (const Pair& pair : expected)
+        {
+            if (!std::binary_search(pairs.begin(), pairs.end(), pair, Checks::isLess))
+            {
+                pserror("%s misses the overlapping pair (%u, %u) on the %s layout.", module, pair.first, pair.second, layout);
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+int main(int argc, const char * argv[])
+{
+    const char* filter = nullptr;
+
+    // The game logs to stdout, so the report goes to a file
+    const char* outputPath = "SubmarineWarsBench.json";
+
+    uint32_t samples = Benchmark::DEF_NUM_SAMPLES;
+
+    for (int index = 1; index < argc; index++)
+    {
+        const char* option = argv[index];
+
+        bool hasValue = index + 1 < argc;
+
+        if (strcmp(option, "--filter") == 0 && hasValue)
+        {
+            filter = argv[++index];
+        }
+        else if (strcmp(option, "--samples") == 0 && hasValue)
+        {
+            samples = (uint32_t) atoi(argv[++index]);
+        }
+        else if (strcmp(option, "--output") == 0 && hasValue)
+        {
+            outputPath = argv[++index];
+        }
+        else
+        {
+            pwarning("Ignored the unknown command line option %s.", option);
+        }
+    }
+
+    // Check the collision modules against brute-force searches before timing them
+    bool passed = true;
+
+    passed &= Checks::collisionGrid();
+
+    passed &= Checks::collisionNarrowphase();
+
+    passed &= Checks::collisionLayers();
+
+    passed &= Checks::contactCache();
+
+    passed &= Checks::collisionSweep();
+
+    passed &= Checks::collisionBounds();
+
+    passed &= Checks::collisionBands();
+
+    passed &= Checks::collisionMask();
+
+    if (!passed)
+    {
+        pserror("The collision modules disagree with the brute-force searches.");
+
+        return EXIT_FAILURE;
+    }
+
+    // Sprites need a GL context, so the benchmarks run against a headless world
+    World world;
+
+    ScreenSize size = { 1280, 720 };
+
+    if (!world.init(size, true))
+    {
+        pserror("Failed to initialize the game world.");
+
+        return EXIT_FAILURE;
+    }
+
+    // Free up the identifiers held by the intro screen
+    world.entityManager->removeIntroUI();
+
+    Benchmark benchmark(filter, samples);
+
+    Benchmarks::freeList(benchmark);
+
+    Benchmarks::collisionGrid(benchmark);
+
+    Benchmarks::denseCluster(benchmark);
+
+    Benchmarks::collisionBands(benchmark);
+
+    Benchmarks::collisionBounds(benchmark);
+
+    Benchmarks::collisionSweep(benchmark);
+
+    Benchmarks::spatialIndex(benchmark);
+
+    Benchmarks::contactCache(benchmark);
+
+    Benchmarks::spriteBatch(benchmark);
+
+    Benchmarks::collisionMask(benchmark);
+
+    Benchmarks::broadphaseStages(benchmark);
+
+    Benchmarks::broadphaseBands(benchmark);
+
+    Benchmarks::entityChurn(benchmark, world);
+
+    Benchmarks::componentsForType(benchmark, world);
+
+    Benchmarks::formattedNumberLabel(benchmark, world);
+
+    Benchmarks::stageLoad(benchmark);
+
+    Benchmarks::saveGame(benchmark, world);
+
+    Benchmarks::collision(benchmark, world);
+
+    world.destroy();
+
+    // Write the report
+    FILE* file = fopen(outputPath, "w");
+
+    if (file == nullptr)
+    {
+        pserror("Failed to open the output file %s.", outputPath);
+
+        return EXIT_FAILURE;
+    }
+
+    benchmark.write(file);
+
+    fclose(file);
+
+    pinfo("Written the benchmark report to %s.", outputPath);
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#version 330
+
+// From vertex shader
+in vec2 texcoord;
+
+// Application data
+uniform sampler2D sampler0;
+uniform vec4 fcolor;
+
+// Output color
+layout(location = 0) out  vec4 color;
+
+void main()
+{
+	// The distance field is 0.5 on the outline and grows inwards
+	// Smoothing over the change of the distance per screen pixel keeps the edge about one pixel wide at any size
+	float distance = texture(sampler0, texcoord).r;
+	float smoothing = 0.7 * fwidth(distance);
+	float coverage = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+
+	color = fcolor * vec4(1.0, 1.0, 1.0, coverage);
+}
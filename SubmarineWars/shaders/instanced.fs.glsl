@@ -0,0 +1,31 @@
+#version 330
+
+// From vertex shader
+in vec2 texcoord;
+in vec3 poscoord;
+flat in vec4 fcolor;
+flat in int distort;
+
+// Application data
+uniform sampler2D sampler0;
+uniform float time;
+
+// Output color
+layout(location = 0) out  vec4 color;
+
+vec2 transform(vec2 coord)
+{
+    float y = sin((time*0.8) + 5*coord.y + 5*coord.x) * 0.02;
+    return vec2(coord.x, coord.y + y);
+}
+
+void main()
+{
+    // Same as textured.fs.glsl: Only the distorted sprites below the surface are waved and tinted
+    if (distort != 0 && poscoord.y < 0.5) {
+        color = fcolor * texture(sampler0, transform(texcoord)) + vec4(0, 0, 0.1, 0);
+    }
+    else {
+        color = fcolor * texture(sampler0, texcoord);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 330 
+
+// Input attributes
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_texcoord;
+
+// Per-instance attributes
+layout(location = 2) in vec3 in_transform0;
+layout(location = 3) in vec3 in_transform1;
+layout(location = 4) in vec3 in_transform2;
+layout(location = 5) in vec4 in_color;
+layout(location = 6) in vec2 in_params;
+
+// Passed to fragment shader
+out vec2 texcoord;
+out vec3 poscoord;
+flat out vec4 fcolor;
+flat out int distort;
+
+// Application data
+uniform mat3 projection;
+uniform vec4 frames[64];
+
+void main()
+{
+	// The frame index selects the region of the texture
+	vec4 frame = frames[int(in_params.y)];
+	texcoord = frame.xy + in_texcoord * frame.zw;
+	fcolor = in_color;
+	distort = int(in_params.x);
+	mat3 transform = mat3(in_transform0, in_transform1, in_transform2);
+	vec3 pos = projection * transform * vec3(in_position.xy, 1.0);
+	poscoord = pos;
+	gl_Position = vec4(pos.xy, in_position.z, 1.0);
+}
\ No newline at end of file
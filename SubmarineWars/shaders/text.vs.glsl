@@ -0,0 +1,19 @@
+#version 330 
+
+// Input attributes
+layout(location = 0) in vec2 in_position;
+layout(location = 1) in vec2 in_texcoord;
+
+// Passed to fragment shader
+out vec2 texcoord;
+
+// Application data
+uniform mat3 projection;
+
+void main()
+{
+	// The glyph quads of a label are generated in screen coordinates
+	texcoord = in_texcoord;
+	vec3 pos = projection * vec3(in_position, 1.0);
+	gl_Position = vec4(pos.xy, 0.0, 1.0);
+}
\ No newline at end of file
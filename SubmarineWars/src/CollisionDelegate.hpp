@@ -10,9 +10,14 @@
 #define CollisionDelegate_hpp
 
 #include "Entities/Entities.hpp"
+#include "CollisionEvents.hpp"
 
 /// A set of methods implemented by the collision handler to perform
 /// essential actions on a collision detected by the Collision System
+///
+/// The collision system reports the collisions of an update session either one scenario at a time,
+/// or all at once through `handleCollisionEvents()`.
+/// A delegate may buffer the per-scenario calls and handle them as one batch in `endUpdates()`.
 class CollisionDelegate
 {
 public:
@@ -50,7 +55,7 @@ public:
     /// @param submarines Identifiers of submarines that will be destroyed by the bomb
     /// @note This delegate method enables the collision handling for chaining explosions on submarines.
     ///
-    virtual void explosionDidCollideWithSubmarines(std::vector<Entity::Identifier> submarines) = 0;
+    virtual void explosionDidCollideWithSubmarines(const std::vector<Entity::Identifier>& submarines) = 0;
     
     ///
     /// Called when an explosion collides with fish
@@ -58,7 +63,7 @@ public:
     /// @param fishes Identifiers of fishes that will be destroyed by the bomb
     /// @note This delegate method enables the collision handling for chaining explosions on fishes.
     ///
-    virtual void explosionDidCollideWithFishes(std::vector<Entity::Identifier> fishes) = 0;
+    virtual void explosionDidCollideWithFishes(const std::vector<Entity::Identifier>& fishes) = 0;
 
     ///
     /// Called when an explosion collides with missile
@@ -66,7 +71,7 @@ public:
     /// @param missiles Identifiers of missiles that will be destroyed by the bomb
     /// @note This delegate method enables the collision handling for chaining explosions on missiles.
     ///
-    virtual void explosionDidCollideWithMissiles(std::vector<Entity::Identifier> missiles) = 0;
+    virtual void explosionDidCollideWithMissiles(const std::vector<Entity::Identifier>& missiles) = 0;
 
     ///
     /// Called when an explosion collides with torpedo
@@ -74,7 +79,7 @@ public:
     /// @param torpedoes Identifiers of torpedoes that will be destroyed by the bomb
     /// @note This delegate method enables the collision handling for chaining explosions on torpedoes.
     ///
-    virtual void explosionDidCollideWithTorpedoes(std::vector<Entity::Identifier> torpedoes) = 0;
+    virtual void explosionDidCollideWithTorpedoes(const std::vector<Entity::Identifier>& torpedoes) = 0;
 
     ///
     /// Called when an explosion collides with store icon
@@ -82,7 +87,7 @@ public:
     /// @param storeIcons Identifiers of store icons that will be destroyed by the bomb
     /// @note This delegate method enables the collision handling for chaining explosions on store icons.
     ///
-    virtual void explosionDidCollideWithStoreIcons(std::vector<Entity::Identifier> storeIcons) = 0;
+    virtual void explosionDidCollideWithStoreIcons(const std::vector<Entity::Identifier>& storeIcons) = 0;
 
     //
     // MARK:- Scenario: The player boat gets destroyed by the enemy projectiles
@@ -141,6 +146,15 @@ public:
     ///
     virtual void smokeDidMoveOutOfScreen(Entity::Identifier smoke) = 0;
     
+    ///
+    /// Called with all collisions found by the collision system in this update session
+    ///
+    /// @param events The collision events in the order they were detected
+    /// @note The buffer is owned by the collision system and reused by the next update session,
+    ///       so the delegate must not keep a reference to it.
+    ///
+    virtual void handleCollisionEvents(const CollisionEventBuffer& events) = 0;
+
     ///
     /// Called when the collision system finishes finding all collisions
     ///
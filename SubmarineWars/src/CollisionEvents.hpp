@@ -0,0 +1,140 @@
+//
+//  CollisionEvents.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-12.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionEvents_hpp
+#define CollisionEvents_hpp
+
+#include "Entities/Entities.hpp"
+#include <vector>
+#include <stdint.h>
+
+/// A collision detected by the collision system
+struct CollisionEvent
+{
+    /// Enumerates all kinds of collisions handled by the collision delegate
+    enum class Type: uint8_t
+    {
+        /// A bomb collides with a destroyable entity and consequently causes an explosion; `first` is the bomb
+        BombDidGenerateExplosion,
+
+        /// A boat missile reaches the end of its path and consequently causes an explosion; `first` is the boat missile
+        BoatMissileDidGenerateExplosion,
+
+        /// An explosion collides with a submarine; `first` is the submarine, and `second` is the explosion
+        ExplosionDidCollideWithSubmarine,
+
+        /// An explosion collides with a fish; `first` is the fish, and `second` is the explosion
+        ExplosionDidCollideWithFish,
+
+        /// An explosion collides with a missile; `first` is the missile, and `second` is the explosion
+        ExplosionDidCollideWithMissile,
+
+        /// An explosion collides with a torpedo; `first` is the torpedo, and `second` is the explosion
+        ExplosionDidCollideWithTorpedo,
+
+        /// An explosion collides with a store icon; `first` is the store icon, and `second` is the explosion
+        ExplosionDidCollideWithStoreIcon,
+
+        /// A torpedo collides with the player boat; `first` is the torpedo, and `second` is the boat
+        TorpedoDidCollideWithBoat,
+
+        /// A missile collides with the player boat; `first` is the missile, and `second` is the boat
+        MissileDidCollideWithBoat,
+
+        /// A submarine collides with the left/right screen boundary; `first` is the submarine
+        SubmarineDidMoveOutOfScreen,
+
+        /// A bomb collides with the screen bottom; `first` is the bomb
+        BombDidMoveOutOfScreen,
+
+        /// A missile collides with the screen top; `first` is the missile
+        MissileDidMoveOutOfScreen,
+
+        /// A torpedo collides with the water surface; `first` is the torpedo
+        TorpedoDidMoveOutOfOceanSurface,
+
+        /// A smoke collides with the screen top; `first` is the smoke
+        SmokeDidMoveOutOfScreen
+    };
+
+    /// The kind of the collision
+    Type type;
+
+    /// The entity the event is about
+    Entity::Identifier first;
+
+    /// The other entity involved in the collision, if any
+    Entity::Identifier second;
+};
+
+/// A contiguous buffer of the collisions detected in an update session
+///
+/// The collision system appends events while it finds collisions,
+/// and the collision delegate consumes all of them in one batch.
+/// The buffer is cleared but not released between update sessions, so it only allocates memory on a new high.
+class CollisionEventBuffer
+{
+public:
+    ///
+    /// Reserve memory for the given number of events
+    ///
+    inline void reserve(uint32_t capacity)
+    {
+        this->events.reserve(capacity);
+    }
+
+    ///
+    /// Remove all events but keep the memory
+    ///
+    inline void clear()
+    {
+        this->events.clear();
+    }
+
+    ///
+    /// Append an event
+    ///
+    /// @param type The kind of the collision
+    /// @param first The entity the event is about
+    /// @param second The other entity involved in the collision, if any
+    ///
+    inline void push(CollisionEvent::Type type, Entity::Identifier first, Entity::Identifier second = 0)
+    {
+        this->events.push_back({type, first, second});
+    }
+
+    ///
+    /// [FAST] Get the number of events
+    ///
+    inline uint32_t size() const
+    {
+        return static_cast<uint32_t>(this->events.size());
+    }
+
+    ///
+    /// [FAST] Get the first event
+    ///
+    inline const CollisionEvent* begin() const
+    {
+        return this->events.data();
+    }
+
+    ///
+    /// [FAST] Get the position after the last event
+    ///
+    inline const CollisionEvent* end() const
+    {
+        return this->events.data() + this->events.size();
+    }
+
+private:
+    /// Events in the order they were detected
+    std::vector<CollisionEvent> events;
+};
+
+#endif /* CollisionEvents_hpp */
@@ -8,6 +8,9 @@
 
 #include "EntityManager.hpp"
 #include "Systems/System.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+#include <math.h>
 
 constexpr vec2 EntityManager::DEF_BOMB_VELOCITY;
 
@@ -874,6 +877,83 @@ bool EntityManager::makeStringLabel(StringLabel& stringLabel, Position& position
     return true;
 }
 
+///
+/// [Factory] Make a text label at the given position
+///
+/// @param label The newly created text label on return; An existing label is replaced.
+/// @param position The pen position of the first character on the baseline
+/// @param font The font used to render the text
+/// @param color The font color used to render the text
+/// @param psize Height of each character
+/// @param format Format of the text
+/// @return `true` on success, `false` otherwise.
+/// @note Unlike a string label, a text label is a single object drawn with one draw call,
+///       and it does not run through any system.
+///
+bool EntityManager::makeTextLabel(TextRenderer::Label& label, Position& position, Character::Font font, vec4 color, uint32_t psize, const char* format, ...)
+{
+    auto atlas = SpriteFactory::shared()->getDistanceFieldAtlas(font);
+
+    // Guard: The glyphs must be available
+    if (atlas == nullptr)
+    {
+        pserror("Failed to load the glyph atlas for the text label.");
+
+        return false;
+    }
+
+    // Construct the final string
+    char string[TextRenderer::MAX_NUM_CHARS + 1] = {};
+
+    va_list args;
+
+    va_start(args, format);
+
+    vsnprintf(string, size(string), format, args);
+
+    va_end(args);
+
+    this->removeTextLabel(label);
+
+    label = TextRenderer::shared()->make(atlas, psize, {position.x, position.y}, color, string);
+
+    return true;
+}
+
+///
+/// Change the text of a text label
+///
+/// @param label An **initialized** text label
+/// @param format Format of the new text
+/// @note The glyph quads are only generated if the text differs.
+///
+void EntityManager::updateTextLabel(TextRenderer::Label label, const char* format, ...)
+{
+    char string[TextRenderer::MAX_NUM_CHARS + 1] = {};
+
+    va_list args;
+
+    va_start(args, format);
+
+    vsnprintf(string, size(string), format, args);
+
+    va_end(args);
+
+    TextRenderer::shared()->setText(label, string);
+}
+
+///
+/// Remove a text label
+///
+/// @param label The label to remove; Reset to 0 on return.
+///
+void EntityManager::removeTextLabel(TextRenderer::Label& label)
+{
+    TextRenderer::shared()->remove(label);
+
+    label = 0;
+}
+
 //
 // MARK:- Manage Entities
 //
@@ -913,24 +993,24 @@ bool EntityManager::setupOutroUI()
 {
     // Add the game over text to the outro UI
     Position position = {512,210};
-    makeStringLabel(this->OutroLabel1, position, Character::Font::SFMonoRegular, Color::black, 52,
+    makeTextLabel(this->OutroLabel1, position, Character::Font::SFMonoRegular, Color::black, 52,
                     "GAME OVER");
 
     position = {365,320};
-    makeStringLabel(this->OutroLabel2, position, Character::Font::SFMonoRegular, Color::black, 15,
+    makeTextLabel(this->OutroLabel2, position, Character::Font::SFMonoRegular, Color::black, 15,
                     "THANKS FOR PLAYING");
     
     position = {200,360};
-    makeStringLabel(this->OutroLabel3, position, Character::Font::SFMonoRegular, Color::black, 15,
+    makeTextLabel(this->OutroLabel3, position, Character::Font::SFMonoRegular, Color::black, 15,
                     "WOULD YOU LIKE TO TRY AGAIN?");
     
     /// Add the new/load game text
     position = {440,541.5};
-    makeStringLabel(this->newGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
+    makeTextLabel(this->newGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
                     "N E W  G A M E");
 
     position = {680,541.5};
-    makeStringLabel(this->loadGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
+    makeTextLabel(this->loadGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
                     "L O A D  G A M E");
     
     return true;
@@ -940,26 +1020,11 @@ void EntityManager::removeOutroUI()
 {
     this->removeEntity(this->outroUI);
     
-    for(Entity::Identifier ident: OutroLabel1.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: OutroLabel2.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: OutroLabel3.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: newGameLabel.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: loadGameLabel.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
+    removeTextLabel(this->OutroLabel1);
+    removeTextLabel(this->OutroLabel2);
+    removeTextLabel(this->OutroLabel3);
+    removeTextLabel(this->newGameLabel);
+    removeTextLabel(this->loadGameLabel);
 }
 
 bool EntityManager::setupIntroUI()
@@ -981,33 +1046,33 @@ bool EntityManager::setupIntroUI()
     
     /// Add the game title to the intro UI
     position = {431,210};
-    makeStringLabel(this->titleLabel, position, Character::Font::SFMonoRegular, Color::black, 52,
+    makeTextLabel(this->titleLabel, position, Character::Font::SFMonoRegular, Color::black, 52,
                     GAME_TITLE);
     
     /// Add the welcome message to the intro UI
     position = {494,288};
-    makeStringLabel(this->welcomeLabel, position, Character::Font::SFMonoRegular, Color::black, 23,
+    makeTextLabel(this->welcomeLabel, position, Character::Font::SFMonoRegular, Color::black, 23,
                     WELCOME_MESSAGE);
     
     /// Add the instructions to the intro UI
     position = {385,320};
-    makeStringLabel(this->instructionsLabel1, position, Character::Font::SFMonoRegular, Color::black, 15,
+    makeTextLabel(this->instructionsLabel1, position, Character::Font::SFMonoRegular, Color::black, 15,
                     INSTRUCTION_DESC1);
     
     position = {510,340};
-    makeStringLabel(this->instructionsLabel2, position, Character::Font::SFMonoRegular, Color::black, 15,
+    makeTextLabel(this->instructionsLabel2, position, Character::Font::SFMonoRegular, Color::black, 15,
                     INSTRUCTION_DESC2);
     
     position = {603,360};
-    makeStringLabel(this->instructionsLabel3, position, Character::Font::SFMonoRegular, Color::black, 15,
+    makeTextLabel(this->instructionsLabel3, position, Character::Font::SFMonoRegular, Color::black, 15,
                     INSTRUCTION_DESC3);
 
     /// Add the new/load game text
     position = {440,541.5};
-    makeStringLabel(this->newGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
+    makeTextLabel(this->newGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
                     NEW_GAME_TITLE);
     position = {680,541.5};
-    makeStringLabel(this->loadGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
+    makeTextLabel(this->loadGameLabel, position, Character::Font::SFMonoRegular, Color::white, 35,
                     LOAD_GAME_TITLE);
 
     return true;
@@ -1016,34 +1081,13 @@ bool EntityManager::setupIntroUI()
 void EntityManager::removeIntroUI()
 {
     this->removeEntity(this->introUI);
-    for(Entity::Identifier ident: titleLabel.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: welcomeLabel.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: instructionsLabel1.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: instructionsLabel2.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: instructionsLabel3.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: newGameLabel.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
-    for(Entity::Identifier ident: loadGameLabel.getIdentifiers())
-    {
-        removeCharacter(ident);
-    }
+    removeTextLabel(this->titleLabel);
+    removeTextLabel(this->welcomeLabel);
+    removeTextLabel(this->instructionsLabel1);
+    removeTextLabel(this->instructionsLabel2);
+    removeTextLabel(this->instructionsLabel3);
+    removeTextLabel(this->newGameLabel);
+    removeTextLabel(this->loadGameLabel);
 }
 
 ///
@@ -1181,6 +1225,386 @@ bool EntityManager::checkIfGameOver()
     }
 }
 
+///
+/// Count the entities of each kind
+///
+/// @return The entity counts.
+///
+EntityManager::EntityCounts EntityManager::getEntityCounts()
+{
+    EntityCounts counts;
+
+    // Identifier 0 is reserved and is never allocated
+    counts.live = (uint32_t) (MAX_NUM_ON_SCREEN_ENTITIES - 1 - this->freelist.freeids.size());
+
+    counts.submarines = 0;
+
+    for (auto& submarines : this->submarines)
+    {
+        counts.submarines += (uint32_t) submarines.size();
+    }
+
+    counts.fishes = (uint32_t) this->fishes.size();
+
+    counts.bombs = (uint32_t) this->bombs.size();
+
+    counts.torpedoes = (uint32_t) this->torpedoes.size();
+
+    counts.missiles = (uint32_t) this->missiles.size();
+
+    counts.boatMissiles = (uint32_t) this->boatMissiles.size();
+
+    counts.explosions = (uint32_t) this->explosions.size();
+
+    counts.smokes = (uint32_t) this->smokes.size();
+
+    counts.characters = (uint32_t) this->characters.size();
+
+    return counts;
+}
+
+///
+/// Capture the gameplay entities and their components
+///
+/// @param snapshot The snapshot to overwrite
+/// @complexity O(MAX_NUM_ON_SCREEN_ENTITIES), without allocating memory.
+///
+void EntityManager::takeSnapshot(EM_Snapshot* snapshot)
+{
+    this->getSnapshotKinds(snapshot->kinds);
+
+    // Submarines facing left are mirrored, whereas fish are not, so their direction follows their velocity
+    for (Entity::Identifier id = 1; id < MAX_NUM_ON_SCREEN_ENTITIES; id++)
+    {
+        switch (snapshot->kinds[id])
+        {
+            case SnapshotKind::None:
+                break;
+
+            case SnapshotKind::Fish:
+                snapshot->directions[id] = this->velocities[id].vx < 0 ? Direction::Left : Direction::Right;
+                break;
+
+            default:
+                snapshot->directions[id] = this->physics[id].scale.x < 0 ? Direction::Left : Direction::Right;
+                break;
+        }
+    }
+
+    snapshot->boat = this->boat.getIdentifier();
+
+    std::copy(std::begin(this->positions), std::end(this->positions), snapshot->positions);
+
+    std::copy(std::begin(this->velocities), std::end(this->velocities), snapshot->velocities);
+
+    std::copy(std::begin(this->rotations), std::end(this->rotations), snapshot->rotations);
+
+    std::copy(std::begin(this->physics), std::end(this->physics), snapshot->physics);
+
+    std::copy(std::begin(this->scores), std::end(this->scores), snapshot->scores);
+
+    std::copy(std::begin(this->attacks), std::end(this->attacks), snapshot->attacks);
+
+    std::copy(std::begin(this->pathings), std::end(this->pathings), snapshot->pathings);
+
+    std::copy(std::begin(this->colors), std::end(this->colors), snapshot->colors);
+}
+
+///
+/// Restore the gameplay entities and their components from a snapshot
+///
+/// @param snapshot A snapshot taken by `takeSnapshot()`
+/// @return `true` on success, `false` if an entity could not be recreated.
+/// @note Entities that still exist, including the player boat, are updated in place.
+///       Entities removed since the snapshot are recreated facing their saved direction, possibly under new identifiers,
+///       and entities created since the snapshot are removed.
+///
+bool EntityManager::restoreSnapshot(const EM_Snapshot& snapshot)
+{
+    SnapshotKind kinds[MAX_NUM_ON_SCREEN_ENTITIES];
+
+    this->getSnapshotKinds(kinds);
+
+    // Copy the components of an entity in the snapshot to an entity in this manager
+    auto restore = [&] (Entity::Identifier from, Entity::Identifier to)
+    {
+        this->positions[to] = snapshot.positions[from];
+
+        this->velocities[to] = snapshot.velocities[from];
+
+        this->rotations[to] = snapshot.rotations[from];
+
+        this->physics[to] = snapshot.physics[from];
+
+        this->scores[to] = snapshot.scores[from];
+
+        this->attacks[to] = snapshot.attacks[from];
+
+        this->pathings[to] = snapshot.pathings[from];
+
+        this->colors[to] = snapshot.colors[from];
+    };
+
+    // Remove entities that did not exist or were of another kind when the snapshot was taken
+    for (Entity::Identifier id = 1; id < MAX_NUM_ON_SCREEN_ENTITIES; id++)
+    {
+        if (kinds[id] == SnapshotKind::None || kinds[id] == snapshot.kinds[id])
+        {
+            continue;
+        }
+
+        switch (kinds[id])
+        {
+            case SnapshotKind::Fish:
+                this->removeFish(id);
+                break;
+
+            case SnapshotKind::Bomb:
+                // The bomb has not been dropped yet in the snapshot
+                this->removeBomb(id);
+                this->player.incrementNumAvailableBombs();
+                break;
+
+            case SnapshotKind::Torpedo:
+                this->removeTorpedo(id);
+                break;
+
+            case SnapshotKind::Missile:
+                this->removeMissile(id);
+                break;
+
+            case SnapshotKind::BoatMissile:
+                this->removeBoatMissile(id);
+                break;
+
+            case SnapshotKind::Explosion:
+                this->removeExplosion(id);
+                break;
+
+            case SnapshotKind::Smoke:
+                this->removeSmoke(id);
+                break;
+
+            default:
+                this->removeSubmarine(id);
+                break;
+        }
+    }
+
+    // Update the remaining entities in place and recreate the missing ones
+    for (Entity::Identifier id = 1; id < MAX_NUM_ON_SCREEN_ENTITIES; id++)
+    {
+        SnapshotKind kind = snapshot.kinds[id];
+
+        if (kind == SnapshotKind::None)
+        {
+            continue;
+        }
+
+        if (kind == kinds[id])
+        {
+            restore(id, id);
+
+            continue;
+        }
+
+        Position position = snapshot.positions[id];
+
+        Entity::Identifier newID = 0;
+
+        switch (kind)
+        {
+            case SnapshotKind::Fish:
+            {
+                Fish fish;
+
+                if (this->makeFish(fish, position, snapshot.directions[id], fabs(snapshot.velocities[id].vx)))
+                {
+                    this->addFish(fish);
+
+                    newID = fish.getIdentifier();
+                }
+
+                break;
+            }
+
+            case SnapshotKind::Bomb:
+            {
+                Bomb bomb;
+
+                if (this->makeBomb(bomb, position, {0.f, 0.f}))
+                {
+                    this->addBomb(bomb);
+
+                    this->player.decrementNumAvailableBombs();
+
+                    newID = bomb.getIdentifier();
+                }
+
+                break;
+            }
+
+            case SnapshotKind::Torpedo:
+            {
+                Torpedo torpedo;
+
+                if (this->makeTorpedo(torpedo, position, {0.f, 0.f}))
+                {
+                    this->addTorpedo(torpedo);
+
+                    newID = torpedo.getIdentifier();
+                }
+
+                break;
+            }
+
+            case SnapshotKind::Missile:
+            {
+                Missile missile;
+
+                if (this->makeMissile(missile, position))
+                {
+                    this->addMissile(missile);
+
+                    newID = missile.getIdentifier();
+                }
+
+                break;
+            }
+
+            case SnapshotKind::BoatMissile:
+            {
+                BoatMissile boatMissile;
+
+                Position target = snapshot.pathings[id].targetPosition;
+
+                if (this->makeBoatMissile(boatMissile, position, target))
+                {
+                    this->addBoatMissile(boatMissile);
+
+                    newID = boatMissile.getIdentifier();
+                }
+
+                break;
+            }
+
+            case SnapshotKind::Explosion:
+            {
+                Explosion explosion;
+
+                if (this->makeExplosion(explosion, position))
+                {
+                    this->addExplosion(explosion);
+
+                    newID = explosion.getIdentifier();
+                }
+
+                break;
+            }
+
+            case SnapshotKind::Smoke:
+            {
+                Smoke smoke;
+
+                if (this->makeSmoke(smoke))
+                {
+                    this->addSmoke(smoke);
+
+                    newID = smoke.getIdentifier();
+                }
+
+                break;
+            }
+
+            default:
+            {
+                Submarine submarine;
+
+                auto type = static_cast<Submarine::Type>(static_cast<uint8_t>(kind) - static_cast<uint8_t>(SnapshotKind::Submarine));
+
+                if (this->makeSubmarine(submarine, position, snapshot.directions[id], fabs(snapshot.velocities[id].vx), type, snapshot.scores[id].score))
+                {
+                    this->addSubmarine(submarine, type);
+
+                    newID = submarine.getIdentifier();
+                }
+
+                break;
+            }
+        }
+
+        if (newID == 0)
+        {
+            pserror("Failed to recreate the entity #%d from the snapshot.", id);
+
+            return false;
+        }
+
+        restore(id, newID);
+    }
+
+    // The boat keeps its identifier for the whole game, so its components are restored in place
+    if (snapshot.boat != 0 && snapshot.boat == this->boat.getIdentifier())
+    {
+        restore(snapshot.boat, snapshot.boat);
+    }
+
+    return true;
+}
+
+///
+/// [Private Helper] Find the kind of the gameplay entity that owns each identifier
+///
+/// @param kinds An array of `MAX_NUM_ON_SCREEN_ENTITIES` kinds to overwrite
+///
+void EntityManager::getSnapshotKinds(SnapshotKind* kinds)
+{
+    std::fill(kinds, kinds + MAX_NUM_ON_SCREEN_ENTITIES, SnapshotKind::None);
+
+    for (int type = 0; type < Submarine::TOTAL_NUM_SUBMARINE_TYPES; type++)
+    {
+        for (auto& submarine : this->submarines[type])
+        {
+            kinds[submarine.first] = static_cast<SnapshotKind>(static_cast<uint8_t>(SnapshotKind::Submarine) + type);
+        }
+    }
+
+    for (auto& fish : this->fishes)
+    {
+        kinds[fish.first] = SnapshotKind::Fish;
+    }
+
+    for (auto& bomb : this->bombs)
+    {
+        kinds[bomb.first] = SnapshotKind::Bomb;
+    }
+
+    for (auto& torpedo : this->torpedoes)
+    {
+        kinds[torpedo.first] = SnapshotKind::Torpedo;
+    }
+
+    for (auto& missile : this->missiles)
+    {
+        kinds[missile.first] = SnapshotKind::Missile;
+    }
+
+    for (auto& boatMissile : this->boatMissiles)
+    {
+        kinds[boatMissile.first] = SnapshotKind::BoatMissile;
+    }
+
+    for (auto& explosion : this->explosions)
+    {
+        kinds[explosion.first] = SnapshotKind::Explosion;
+    }
+
+    for (auto& smoke : this->smokes)
+    {
+        kinds[smoke.first] = SnapshotKind::Smoke;
+    }
+}
+
 void EntityManager::removeAllEntities()
 {
     /// Remove all fish
@@ -1377,26 +1801,30 @@ bool EntityManager::loadGame(EM_SaveData data)
 /// @warning Subsequent calls are silently ignored if the given formatted number label is already initialized.
 ///          The caller might want to invoke `updateFormattedNumberLabel()` instead to update the value in the label.
 ///
-bool EntityManager::setupFormattedNumberLabel(FormattedNumberLabel& numberLabel, Position& position, uint32_t size)
+bool EntityManager::setupFormattedNumberLabel(TextRenderer::NumberLabel& numberLabel, Position& position, uint32_t size)
 {
     // Guard: If the given number label is already initialized, no need to set it up again
-    if (numberLabel.getIdentifier() != 0)
+    if (numberLabel.label != 0)
     {
         pwarning("API Usage Error: The given formatted number label is already initialized.");
         
         return true;
     }
     
-    // Compute the format string
-    auto length = numberLabel.getFormatStringLength();
-    
-    char* format = (char*) alloca(length);
-    
-    // Format "Prefix%0\(width)llu"
-    snprintf(format, length, "%s%%0%llullu", numberLabel.getStringPrefix(), numberLabel.getWidth());
-    
+    auto atlas = SpriteFactory::shared()->getDistanceFieldAtlas(Character::Font::SFMonoRegular);
+
+    // Guard: The glyphs must be available
+    if (atlas == nullptr)
+    {
+        pserror("Failed to load the glyph atlas for the formatted number label.");
+
+        return false;
+    }
+
     // Make the label
-    return this->makeStringLabel(numberLabel, position, Character::Font::SFMonoRegular, Color::black, size, format, numberLabel.getValue());
+    TextRenderer::shared()->makeNumber(numberLabel, atlas, size, {position.x, position.y}, Color::black);
+
+    return true;
 }
 
 ///
@@ -1475,84 +1903,17 @@ bool EntityManager::setupBoatMissilesIndicator()
 /// @param numberLabel An **initialized** label to be updated
 /// @param newValue The new numeric value to be rendered
 /// @return `true` on success, `false` otherwise.
-/// @note This method smartly detects the characters needed to be updated.
+/// @note This method only rewrites the glyph quads of the digits that change,
+///       with no formatting, no FreeType calls and no GL objects made on the way.
 ///
-bool EntityManager::updateFormattedNumberLabel(FormattedNumberLabel& numberLabel, uint64_t newValue)
+bool EntityManager::updateFormattedNumberLabel(TextRenderer::NumberLabel& numberLabel, uint64_t newValue)
 {
-    // Guard: Check whether the new value is actually different
-    if (numberLabel.getValue() == newValue)
-    {
-        return true;
-    }
-    
-    // Get the identifiers of the character sequence
-    auto& identifiers = numberLabel.getIdentifiers();
-    
-    // Compute the format string (excluding the prefix part)
-    // i.e. "%0\(width)llu" (e.g. "%08llu")
-    char format[8] = {0};
-    
-    auto width = numberLabel.getWidth();
-    
-    snprintf(format, size(format), "%%0%llullu", width);
-    
-    // Construct both the old and the new numeric part of the label
-    // The number of digits is fixed and is `width` in the given `numberLabel`
-    // Allocate the memory on stack to keep this method less heavy
-    // and there won't be a stack overflow issue as width is guaranteed to be <= 16
-    auto size = width + 8; // + 8 for aligned access
-    
-    char* numericOld = (char*) alloca(size);
-    
-    snprintf(numericOld, size, format, numberLabel.getValue());
-    
-    char* numericNew = (char*) alloca(size);
-    
-    snprintf(numericNew, size, format, newValue);
-    
-    auto base = numberLabel.getStringPrefixLength();
-    
-    // Here is the algorithm
-    // Find the differences
-    for (int index = 0; index < width; index++)
-    {
-        // Guard: Find which character differs
-        if (numericNew[index] != numericOld[index])
-        {
-            // Found a mismatched character
-            // Find its corresponding Character entity
-            auto id = identifiers[base + index];
-            
-            auto& ch = this->characters[id];
-            
-            // Replace its current underlying sprite with the new character sprite
-            // using the modified version of character attribute
-            // Keep the font, font size unchanged
-            ch.attribute.character = numericNew[index];
-            
-            // Found the current (static) sprite
-            auto sprite = &this->ssprites[id];
-            
-            // Deinitialize the old sprite
-            sprite->deinit();
-            
-            // Guard: Make a new sprite with the new character, passing the new attribute
-            if (!SpriteFactory::shared()->make<Character>(sprite, &ch.attribute))
-            {
-                pserror("Failed to make the sprite for the new character '%c'.", numericNew[index]);
-                
-                return false;
-            }
-            
-            // All done
-            // The new sprite is now effective
-            // The entity identifier does not change, keeping the spatial locality
-        }
-    }
-    
-    // Update the label value
-    numberLabel.setValue(newValue);
-    
+    SW_PROFILE_SCOPE(LabelUpdate);
+
+    // Swap the quads of the digits that change in place
+    // The font is monospaced, so the other characters never move
+    TextRenderer::shared()->setNumber(numberLabel, newValue);
+
     return true;
 }
 
@@ -15,6 +15,7 @@
 #include "Components/Components.hpp"
 #include "ComponentsDataProvider.hpp"
 #include "SpriteFactory.hpp"
+#include "Systems/TextRenderer.hpp"
 #include <list>
 #include <vector>
 #include <algorithm>
@@ -23,9 +24,17 @@
 #include <typeindex>
 #include <float.h>
 
+/// The maximum number of entities on screen; Component arrays are statically sized by this value
+#ifndef SW_MAX_NUM_ON_SCREEN_ENTITIES
+#define SW_MAX_NUM_ON_SCREEN_ENTITIES 1024
+#endif
+
 /// Manages all game entities
 class EntityManager: public EntityDelegate, public ComponentsDataProvider
 {
+    /// Microbenchmarks measure the free list directly
+    friend class Benchmarks;
+
 public:
     /// Default constructor
     /// @note Upon completion, a default boat and the background ocean are added automatically
@@ -262,6 +271,37 @@ public:
     /// @return `true` on success, `false` otherwise.
     ///
     bool makeStringLabel(StringLabel& stringLabel, Position& position, Character::Font font, vec4 color, uint32_t psize, const char* format, ...);
+
+    ///
+    /// [Factory] Make a text label at the given position
+    ///
+    /// @param label The newly created text label on return; An existing label is replaced.
+    /// @param position The pen position of the first character on the baseline
+    /// @param font The font used to render the text
+    /// @param color The font color used to render the text
+    /// @param psize Height of each character
+    /// @param format Format of the text
+    /// @return `true` on success, `false` otherwise.
+    /// @note Unlike a string label, a text label is a single object drawn with one draw call,
+    ///       and it does not run through any system.
+    ///
+    bool makeTextLabel(TextRenderer::Label& label, Position& position, Character::Font font, vec4 color, uint32_t psize, const char* format, ...);
+
+    ///
+    /// Change the text of a text label
+    ///
+    /// @param label An **initialized** text label
+    /// @param format Format of the new text
+    /// @note The glyph quads are only generated if the text differs.
+    ///
+    void updateTextLabel(TextRenderer::Label label, const char* format, ...);
+
+    ///
+    /// Remove a text label
+    ///
+    /// @param label The label to remove; Reset to 0 on return.
+    ///
+    void removeTextLabel(TextRenderer::Label& label);
     
     //
     // MARK:- Manage Entities
@@ -302,7 +342,8 @@ public:
     bool resetBoat();
     
     /// Assume the maximum number of entities on screen is MAX_NUM_ON_SCREEN_ENTITIES
-    static constexpr uint32_t MAX_NUM_ON_SCREEN_ENTITIES = 1024;
+    /// @note Define `SW_MAX_NUM_ON_SCREEN_ENTITIES` to raise the limit, e.g. for stress stages.
+    static constexpr uint32_t MAX_NUM_ON_SCREEN_ENTITIES = SW_MAX_NUM_ON_SCREEN_ENTITIES;
     
     struct EM_SaveData {
         /// The boat ID
@@ -357,6 +398,112 @@ public:
     bool gameIsOver = true;
     bool gameIsRunning = false;
     
+    /// The number of entities of each kind
+    struct EntityCounts
+    {
+        /// The number of allocated identifiers, including UI elements and labels
+        uint32_t live;
+
+        uint32_t submarines;
+
+        uint32_t fishes;
+
+        uint32_t bombs;
+
+        uint32_t torpedoes;
+
+        uint32_t missiles;
+
+        uint32_t boatMissiles;
+
+        uint32_t explosions;
+
+        uint32_t smokes;
+
+        uint32_t characters;
+    };
+
+    ///
+    /// Count the entities of each kind
+    ///
+    /// @return The entity counts.
+    ///
+    EntityCounts getEntityCounts();
+
+    /// The kinds of entities captured by a snapshot
+    enum class SnapshotKind : uint8_t
+    {
+        None,
+        Fish,
+        Bomb,
+        Torpedo,
+        Missile,
+        BoatMissile,
+        Explosion,
+        Smoke,
+
+        /// Followed by one kind per submarine type
+        Submarine
+    };
+
+    /// An in-memory snapshot of the gameplay entities and their components
+    /// @note A snapshot has a fixed size, so that taking one never allocates memory.
+    ///       UI elements, labels and characters are not captured; The player boat is captured in place.
+    struct EM_Snapshot
+    {
+        /// The kind of the entity that owns each identifier
+        SnapshotKind kinds[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// The facing direction of each fish and submarine
+        Direction directions[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// The identifier of the player boat; 0 if the boat has not been set up
+        Entity::Identifier boat;
+
+        /// Component Array - Position
+        Position positions[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Velocity
+        Velocity velocities[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Rotations
+        Rotation rotations[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Physics
+        Physics physics[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Scores
+        Score scores[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Attack
+        Attack attacks[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Pathing
+        Pathing pathings[MAX_NUM_ON_SCREEN_ENTITIES];
+
+        /// Component Array - Color
+        Color colors[MAX_NUM_ON_SCREEN_ENTITIES];
+    };
+
+    ///
+    /// Capture the gameplay entities and their components
+    ///
+    /// @param snapshot The snapshot to overwrite
+    /// @complexity O(MAX_NUM_ON_SCREEN_ENTITIES), without allocating memory.
+    ///
+    void takeSnapshot(EM_Snapshot* snapshot);
+
+    ///
+    /// Restore the gameplay entities and their components from a snapshot
+    ///
+    /// @param snapshot A snapshot taken by `takeSnapshot()`
+    /// @return `true` on success, `false` if an entity could not be recreated.
+    /// @note Entities that still exist, including the player boat, are updated in place.
+    ///       Entities removed since the snapshot are recreated facing their saved direction, possibly under new identifiers,
+    ///       and entities created since the snapshot are removed.
+    ///
+    bool restoreSnapshot(const EM_Snapshot& snapshot);
+
     ///
     /// Setup the formatted number label
     ///
@@ -368,7 +515,7 @@ public:
     /// @warning Subsequent calls are silently ignored if the given formatted number label is already initialized.
     ///          The caller might want to invoke `updateFormattedNumberLabel()` instead to update the value in the label.
     ///
-    bool setupFormattedNumberLabel(FormattedNumberLabel& numberLabel, Position& position, uint32_t size = 32);
+    bool setupFormattedNumberLabel(TextRenderer::NumberLabel& numberLabel, Position& position, uint32_t size = 32);
     
     ///
     /// Setup the boat lives indicator
@@ -417,9 +564,10 @@ public:
     /// @param numberLabel An **initialized** label to be updated
     /// @param newValue The new numeric value to be rendered
     /// @return `true` on success, `false` otherwise.
-    /// @note This method smartly detects the characters needed to be updated.
+    /// @note This method only rewrites the glyph quads of the digits that change,
+    ///       with no formatting, no FreeType calls and no GL objects made on the way.
     ///
-    bool updateFormattedNumberLabel(FormattedNumberLabel& numberLabel, uint64_t newValue);
+    bool updateFormattedNumberLabel(TextRenderer::NumberLabel& numberLabel, uint64_t newValue);
     
     ///
     /// [Convenient] Update the score label
@@ -872,49 +1020,49 @@ private:
     Ocean ocean;
     
     /// The score label
-    FormattedNumberLabel scoreLabel;
+    TextRenderer::NumberLabel scoreLabel;
     
     /// The money label
-    FormattedNumberLabel moneyLabel;
+    TextRenderer::NumberLabel moneyLabel;
     
     /// The number of lives label
-    FormattedNumberLabel livesLabel;
+    TextRenderer::NumberLabel livesLabel;
 
     /// The number of missiles label
-    FormattedNumberLabel missilesLabel;
+    TextRenderer::NumberLabel missilesLabel;
     
     /// The stage label
-    FormattedNumberLabel stageLabel;
+    TextRenderer::NumberLabel stageLabel;
     
     /// The intro title label
-    StringLabel titleLabel;
+    TextRenderer::Label titleLabel = 0;
     const char* GAME_TITLE = "SUBMARINE WARS";
 
     /// The welcome label
-    StringLabel welcomeLabel;
+    TextRenderer::Label welcomeLabel = 0;
     const char* WELCOME_MESSAGE = "WELCOME ABOARD CAPTAIN";
     
     /// The instructions labels
-    StringLabel instructionsLabel1;
+    TextRenderer::Label instructionsLabel1 = 0;
     const char* INSTRUCTION_DESC1 = "THERE ARE ENEMY SHIPS INCOMING WE MUST PREPARE FOR BATTLE!";
-    StringLabel instructionsLabel2;
+    TextRenderer::Label instructionsLabel2 = 0;
     const char* INSTRUCTION_DESC2 = "YOUR CONTROLS ARE LISTED BELOW";
-    StringLabel instructionsLabel3;
+    TextRenderer::Label instructionsLabel3 = 0;
     const char* INSTRUCTION_DESC3 = "GOOD LUCK";
     
     /// The New Game label
-    StringLabel newGameLabel;
+    TextRenderer::Label newGameLabel = 0;
     Entity newGameButton;
     const char* NEW_GAME_TITLE = "NEW GAME";
     
     /// The Load Game label
-    StringLabel loadGameLabel;
+    TextRenderer::Label loadGameLabel = 0;
     const char* LOAD_GAME_TITLE = "LOAD GAME";
     
-    StringLabel OutroLabel1;
-    StringLabel OutroLabel2;
-    StringLabel OutroLabel3;
-    StringLabel OutroLabel4;
+    TextRenderer::Label OutroLabel1 = 0;
+    TextRenderer::Label OutroLabel2 = 0;
+    TextRenderer::Label OutroLabel3 = 0;
+    TextRenderer::Label OutroLabel4 = 0;
 
     ///
     /// Helper function for make submarine that re-casts sub to proper type
@@ -960,6 +1108,13 @@ private:
     ///
     void removeEntity(Entity& entity);
 
+    ///
+    /// [PRIVATE] Find the kind of the gameplay entity that owns each identifier
+    ///
+    /// @param kinds An array of `MAX_NUM_ON_SCREEN_ENTITIES` kinds to overwrite
+    ///
+    void getSnapshotKinds(SnapshotKind* kinds);
+
     // MARK:- Manage Component Arrays
 
     /// A Component Array Registry type that maps the component type id to its corresponding component array
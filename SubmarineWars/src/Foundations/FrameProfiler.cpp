@@ -0,0 +1,336 @@
+//
+//  FrameProfiler.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-02.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "FrameProfiler.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+/// Private instance
+FrameProfiler* FrameProfiler::instance = nullptr;
+
+/// Get the shared instance
+FrameProfiler* FrameProfiler::shared()
+{
+    if (FrameProfiler::instance == nullptr)
+    {
+        FrameProfiler::instance = new FrameProfiler();
+    }
+
+    return FrameProfiler::instance;
+}
+
+/// Private constructor
+FrameProfiler::FrameProfiler()
+{
+    std::fill(std::begin(this->current), std::end(this->current), Clock::duration::zero());
+
+    this->setWindowSize(FrameProfiler::DEF_WINDOW_SIZE);
+}
+
+///
+/// Start or stop recording
+///
+/// @param enabled Pass `true` to start recording, `false` to stop.
+/// @note Samples recorded so far are discarded when the profiler is enabled again.
+///
+void FrameProfiler::setEnabled(bool enabled)
+{
+    if (enabled && !this->enabled)
+    {
+        this->head = 0;
+
+        this->count = 0;
+
+        this->lastDump = Clock::now();
+    }
+
+    this->enabled = enabled;
+}
+
+///
+/// Set the number of frames in the rolling window
+///
+/// @param frames The new window size; must be positive
+/// @note This method allocates the sample storage and discards all samples recorded so far.
+///
+void FrameProfiler::setWindowSize(uint32_t frames)
+{
+    if (frames == 0)
+    {
+        pwarning("API Usage Error: The window size must be positive.");
+
+        return;
+    }
+
+    this->windowSize = frames;
+
+    this->samples.assign(frames * FrameProfiler::NUM_SECTIONS, 0.0f);
+
+    this->scratch.resize(frames);
+
+    this->head = 0;
+
+    this->count = 0;
+}
+
+///
+/// Dump the statistics to the given file periodically
+///
+/// @param path The output file path; pass `nullptr` to disable the periodic dump
+/// @param interval The dump interval in milliseconds
+/// @param format The output format
+/// @note CSV rows are appended to the file; the JSON file is overwritten with the latest statistics.
+///
+void FrameProfiler::setPeriodicDump(const char* path, float interval, Format format)
+{
+    this->dumpPath.clear();
+
+    if (path != nullptr)
+    {
+        this->dumpPath.assign(path, path + strlen(path) + 1);
+    }
+
+    this->dumpInterval = interval;
+
+    this->dumpFormat = format;
+
+    this->dumpHeaderWritten = false;
+
+    this->lastDump = Clock::now();
+}
+
+///
+/// Mark the beginning of a frame
+///
+void FrameProfiler::beginFrame()
+{
+    if (!this->enabled)
+    {
+        return;
+    }
+
+    std::fill(std::begin(this->current), std::end(this->current), Clock::duration::zero());
+
+    this->frameStart = Clock::now();
+
+    this->frameThread = std::this_thread::get_id();
+}
+
+///
+/// Mark the end of a frame and commit the time accumulated by each section
+///
+void FrameProfiler::endFrame()
+{
+    if (!this->enabled)
+    {
+        return;
+    }
+
+    this->current[static_cast<uint32_t>(ProfileSection::Frame)] = Clock::now() - this->frameStart;
+
+    // Commit the current frame
+    float* frame = &this->samples[this->head * FrameProfiler::NUM_SECTIONS];
+
+    for (uint32_t index = 0; index < FrameProfiler::NUM_SECTIONS; index++)
+    {
+        frame[index] = std::chrono::duration<float, std::milli>(this->current[index]).count();
+    }
+
+    this->head = (this->head + 1) % this->windowSize;
+
+    this->count = std::min(this->count + 1, this->windowSize);
+
+    // Guard: Check whether a periodic dump is due
+    if (this->dumpPath.empty() || this->dumpInterval <= 0)
+    {
+        return;
+    }
+
+    // The frame section only covers the update, so measure the interval on the wall clock
+    Clock::time_point now = Clock::now();
+
+    if (std::chrono::duration<float, std::milli>(now - this->lastDump).count() < this->dumpInterval)
+    {
+        return;
+    }
+
+    this->lastDump = now;
+
+    // CSV rows are accumulated in a single file, while JSON always reflects the latest window
+    bool append = this->dumpFormat == Format::CSV && this->dumpHeaderWritten;
+
+    psoftassert(this->dump(this->dumpPath.data(), this->dumpFormat, append), "Failed to dump the frame statistics.");
+
+    this->dumpHeaderWritten = true;
+}
+
+///
+/// Compute the rolling statistics of the given section
+///
+/// @param section The instrumented section
+/// @return The statistics over the current window; all zeros if no frame has been recorded.
+///
+FrameProfiler::Statistics FrameProfiler::getStatistics(ProfileSection section)
+{
+    Statistics statistics = {0, 0, 0, 0, this->count};
+
+    if (this->count == 0)
+    {
+        return statistics;
+    }
+
+    // Gather the samples of the given section
+    uint32_t offset = static_cast<uint32_t>(section);
+
+    for (uint32_t index = 0; index < this->count; index++)
+    {
+        this->scratch[index] = this->samples[index * FrameProfiler::NUM_SECTIONS + offset];
+    }
+
+    auto base = this->scratch.begin();
+
+    auto lower = base;
+
+    auto end = base + this->count;
+
+    // Select percentiles in ascending order so that each selection only partitions the upper part
+    auto percentile = [base, &lower, end, this] (float p) -> float
+    {
+        auto nth = base + std::min<uint32_t>(this->count - 1, (uint32_t) (p * this->count));
+
+        std::nth_element(lower, nth, end);
+
+        lower = nth;
+
+        return *nth;
+    };
+
+    statistics.p50 = percentile(0.50f);
+
+    statistics.p95 = percentile(0.95f);
+
+    statistics.p99 = percentile(0.99f);
+
+    statistics.max = *std::max_element(lower, end);
+
+    return statistics;
+}
+
+///
+/// Write the statistics of all sections to the given file
+///
+/// @param path The output file path
+/// @param format The output format
+/// @param append Pass `true` to append to the file rather than overwriting it
+/// @return `true` on success, `false` otherwise.
+///
+bool FrameProfiler::dump(const char* path, Format format, bool append)
+{
+    FILE* file = fopen(path, append ? "a" : "w");
+
+    if (file == nullptr)
+    {
+        pserror("Failed to open the frame statistics file %s.", path);
+
+        return false;
+    }
+
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count();
+
+    if (format == Format::CSV)
+    {
+        if (!append)
+        {
+            fprintf(file, "timestamp_ms,section,samples,p50_ms,p95_ms,p99_ms,max_ms\n");
+        }
+
+        for (uint32_t index = 0; index < FrameProfiler::NUM_SECTIONS; index++)
+        {
+            auto section = static_cast<ProfileSection>(index);
+
+            auto s = this->getStatistics(section);
+
+            fprintf(file, "%lld,%s,%u,%.4f,%.4f,%.4f,%.4f\n", (long long) timestamp, FrameProfiler::nameForSection(section), s.samples, s.p50, s.p95, s.p99, s.max);
+        }
+    }
+    else
+    {
+        fprintf(file, "{\"timestamp_ms\":%lld,\"sections\":{", (long long) timestamp);
+
+        for (uint32_t index = 0; index < FrameProfiler::NUM_SECTIONS; index++)
+        {
+            auto section = static_cast<ProfileSection>(index);
+
+            auto s = this->getStatistics(section);
+
+            fprintf(file, "%s\"%s\":{\"samples\":%u,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f}",
+                    index == 0 ? "" : ",", FrameProfiler::nameForSection(section), s.samples, s.p50, s.p95, s.p99, s.max);
+        }
+
+        fprintf(file, "}}\n");
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+///
+/// Get the name of the given section
+///
+const char* FrameProfiler::nameForSection(ProfileSection section)
+{
+    switch (section)
+    {
+        case ProfileSection::Frame:
+            return "Frame";
+
+        case ProfileSection::StageController:
+            return "StageController";
+
+        case ProfileSection::MotionSystem:
+            return "MotionSystem";
+
+        case ProfileSection::InputSystem:
+            return "InputSystem";
+
+        case ProfileSection::CollisionSystem:
+            return "CollisionSystem";
+
+        case ProfileSection::RenderSystem:
+            return "RenderSystem";
+
+        case ProfileSection::AttackSystem:
+            return "AttackSystem";
+
+        case ProfileSection::PathingSystem:
+            return "PathingSystem";
+
+        case ProfileSection::AnimationSystem:
+            return "AnimationSystem";
+
+        case ProfileSection::CollisionBroadphase:
+            return "CollisionBroadphase";
+
+        case ProfileSection::CollisionNarrowphase:
+            return "CollisionNarrowphase";
+
+        case ProfileSection::LabelUpdate:
+            return "LabelUpdate";
+
+        case ProfileSection::Spawn:
+            return "Spawn";
+
+        default:
+            pserror("[Fatal] Unimplemented switch case.");
+
+            return "Unknown";
+    }
+}
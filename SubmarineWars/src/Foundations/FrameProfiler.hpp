@@ -0,0 +1,298 @@
+//
+//  FrameProfiler.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-02.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef FrameProfiler_hpp
+#define FrameProfiler_hpp
+
+#include "TraceRecorder.hpp"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/// Enable the instrumentation by default; Define `SW_PROFILING` to 0 to compile all timers out
+#ifndef SW_PROFILING
+#define SW_PROFILING 1
+#endif
+
+/// Enumerates all instrumented sections of a frame
+/// @note Sections are inclusive; e.g. `LabelUpdate` is also counted in the system that triggers it.
+enum class ProfileSection : uint32_t
+{
+    /// The whole `World::update()`
+    Frame,
+
+    /// Systems and the stage controller
+    StageController,
+    MotionSystem,
+    InputSystem,
+    CollisionSystem,
+    RenderSystem,
+    AttackSystem,
+    PathingSystem,
+    AnimationSystem,
+
+    /// Sub-phases of the collision system
+    CollisionBroadphase,
+    CollisionNarrowphase,
+
+    /// Updates of formatted number labels
+    LabelUpdate,
+
+    /// Entity spawns initiated by the stage controller
+    Spawn,
+
+    /// The total number of sections
+    Count
+};
+
+/// A singleton that measures where the time of each frame goes
+/// and keeps rolling percentiles of each instrumented section over a configurable window of frames
+/// @note Sections are only timed on the thread that begins the frames; Worker threads still record trace events.
+class FrameProfiler
+{
+public:
+    /// The clock used to time sections
+    using Clock = std::chrono::steady_clock;
+
+    /// The number of instrumented sections
+    static constexpr uint32_t NUM_SECTIONS = static_cast<uint32_t>(ProfileSection::Count);
+
+    /// The default number of frames in the rolling window (~10 seconds at 60 FPS)
+    static constexpr uint32_t DEF_WINDOW_SIZE = 600;
+
+    /// Rolling statistics of a section in milliseconds
+    struct Statistics
+    {
+        float p50;
+
+        float p95;
+
+        float p99;
+
+        float max;
+
+        /// The number of frames in the window
+        uint32_t samples;
+    };
+
+    /// Supported formats of the periodic dump
+    enum class Format
+    {
+        CSV,
+        JSON
+    };
+
+    /// Get the shared instance
+    static FrameProfiler* shared();
+
+    ///
+    /// [FAST] Check whether the profiler is recording
+    ///
+    inline bool isEnabled() const
+    {
+        return this->enabled;
+    }
+
+    ///
+    /// [FAST] Check whether the calling thread is the one that begins the frames
+    ///
+    inline bool isFrameThread() const
+    {
+        return std::this_thread::get_id() == this->frameThread;
+    }
+
+    ///
+    /// Start or stop recording
+    ///
+    /// @param enabled Pass `true` to start recording, `false` to stop.
+    /// @note Samples recorded so far are discarded when the profiler is enabled again.
+    ///
+    void setEnabled(bool enabled);
+
+    ///
+    /// Set the number of frames in the rolling window
+    ///
+    /// @param frames The new window size; must be positive
+    /// @note This method allocates the sample storage and discards all samples recorded so far.
+    ///
+    void setWindowSize(uint32_t frames);
+
+    ///
+    /// Dump the statistics to the given file periodically
+    ///
+    /// @param path The output file path; pass `nullptr` to disable the periodic dump
+    /// @param interval The dump interval in milliseconds
+    /// @param format The output format
+    /// @note CSV rows are appended to the file; the JSON file is overwritten with the latest statistics.
+    ///
+    void setPeriodicDump(const char* path, float interval, Format format);
+
+    ///
+    /// Mark the beginning of a frame
+    ///
+    void beginFrame();
+
+    ///
+    /// Mark the end of a frame and commit the time accumulated by each section
+    ///
+    void endFrame();
+
+    ///
+    /// [FAST] Accumulate the given elapsed time to a section of the current frame
+    ///
+    /// @param section The instrumented section
+    /// @param elapsed The elapsed time in clock ticks
+    ///
+    inline void accumulate(ProfileSection section, Clock::duration elapsed)
+    {
+        this->current[static_cast<uint32_t>(section)] += elapsed;
+    }
+
+    ///
+    /// Compute the rolling statistics of the given section
+    ///
+    /// @param section The instrumented section
+    /// @return The statistics over the current window; all zeros if no frame has been recorded.
+    ///
+    Statistics getStatistics(ProfileSection section);
+
+    ///
+    /// Write the statistics of all sections to the given file
+    ///
+    /// @param path The output file path
+    /// @param format The output format
+    /// @param append Pass `true` to append to the file rather than overwriting it
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool dump(const char* path, Format format, bool append = false);
+
+    ///
+    /// Get the name of the given section
+    ///
+    static const char* nameForSection(ProfileSection section);
+
+private:
+    /// Private instance
+    static FrameProfiler* instance;
+
+    /// `true` if the profiler is recording
+    bool enabled = false;
+
+    /// The number of frames in the rolling window
+    uint32_t windowSize = 0;
+
+    /// The index of the next frame in the window
+    uint32_t head = 0;
+
+    /// The number of valid frames in the window
+    uint32_t count = 0;
+
+    /// Time accumulated by each section in the current frame
+    Clock::duration current[NUM_SECTIONS];
+
+    /// The start time of the current frame
+    Clock::time_point frameStart;
+
+    /// The thread that begins the frames
+    std::thread::id frameThread;
+
+    /// Samples in milliseconds, stored as `windowSize` frames of `NUM_SECTIONS` sections
+    std::vector<float> samples;
+
+    /// Scratch buffer used to compute percentiles without allocations
+    std::vector<float> scratch;
+
+    /// The periodic dump file path; empty if disabled
+    std::vector<char> dumpPath;
+
+    /// The periodic dump interval in milliseconds
+    float dumpInterval = 0;
+
+    /// The wall-clock time of the last periodic dump, so that idle time between frames counts towards the interval
+    Clock::time_point lastDump;
+
+    /// The periodic dump format
+    Format dumpFormat = Format::CSV;
+
+    /// `true` if the CSV header has been written to the periodic dump file
+    bool dumpHeaderWritten = false;
+
+    /// Private constructor
+    FrameProfiler();
+};
+
+/// A timer that accumulates its lifetime to a section of the current frame
+/// @note The timer also records a trace event named after the section if the trace recorder is recording.
+class ProfileScope
+{
+public:
+    ///
+    /// [Constructor] Start timing the given section
+    ///
+    /// @param section The instrumented section
+    /// @note The clock is not read at all if neither the profiler nor the trace recorder is recording.
+    ///
+    explicit inline ProfileScope(ProfileSection section) : section(section), profiling(FrameProfiler::shared()->isEnabled() && FrameProfiler::shared()->isFrameThread()), traceStart(-1)
+    {
+        if (this->profiling)
+        {
+            this->start = FrameProfiler::Clock::now();
+        }
+
+        if (TraceRecorder::shared()->isEnabled())
+        {
+            this->traceStart = TraceRecorder::shared()->now();
+        }
+    }
+
+    /// [Destructor] Stop timing
+    inline ~ProfileScope()
+    {
+        if (this->profiling)
+        {
+            FrameProfiler::shared()->accumulate(this->section, FrameProfiler::Clock::now() - this->start);
+        }
+
+        if (this->traceStart >= 0)
+        {
+            auto recorder = TraceRecorder::shared();
+
+            recorder->record(FrameProfiler::nameForSection(this->section), "system", this->traceStart, recorder->now() - this->traceStart);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    /// The section being timed
+    ProfileSection section;
+
+    /// `true` if the profiler was recording when the scope started
+    bool profiling;
+
+    /// The start time
+    FrameProfiler::Clock::time_point start;
+
+    /// The start timestamp of the trace event; negative if the trace recorder was not recording
+    int64_t traceStart;
+};
+
+#define SW_PROFILE_CONCAT_IMP(a, b) a##b
+#define SW_PROFILE_CONCAT(a, b) SW_PROFILE_CONCAT_IMP(a, b)
+
+#if SW_PROFILING
+/// Time the rest of the enclosing scope as the given section
+#define SW_PROFILE_SCOPE(section) ProfileScope SW_PROFILE_CONCAT(profileScope, __LINE__)(ProfileSection::section)
+#else
+#define SW_PROFILE_SCOPE(section)
+#endif
+
+#endif /* FrameProfiler_hpp */
@@ -0,0 +1,373 @@
+//
+//  TimerWheel.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-08.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "TimerWheel.hpp"
+#include <algorithm>
+#include <math.h>
+
+///
+/// Create an empty wheel
+///
+TimerWheel::TimerWheel()
+{
+    this->freelist = TimerWheel::NIL;
+
+    this->now = 0;
+
+    this->remainder = 0;
+
+    this->numTimers = 0;
+
+    for (auto& level : this->slots)
+    {
+        for (auto& slot : level)
+        {
+            slot = TimerWheel::NIL;
+        }
+    }
+}
+
+///
+/// Schedule a timer
+///
+/// @param delay The delay in milliseconds; rounded up to the next tick
+/// @param callback The function to invoke when the timer fires
+/// @param identifier An identifier passed to the callback
+/// @param userptr A user pointer passed to the callback
+/// @param period The period in milliseconds of a repeating timer; 0 for a one-shot timer
+/// @return The handle of the new timer.
+/// @note A timer never fires in the tick that schedules it, even if the delay is 0.
+///
+TimerWheel::Handle TimerWheel::schedule(float delay, Callback callback, int identifier, void* userptr, float period)
+{
+    // Take a node from the free list or grow the pool
+    uint32_t index = this->freelist;
+
+    if (index != TimerWheel::NIL)
+    {
+        this->freelist = this->timers[index].next;
+    }
+    else
+    {
+        index = (uint32_t) this->timers.size();
+
+        this->timers.emplace_back();
+
+        this->timers[index].generation = 1;
+    }
+
+    Timer& timer = this->timers[index];
+
+    timer.deadline = this->now + std::max<uint64_t>(TimerWheel::ticks(delay), 1);
+
+    timer.period = period > 0 ? std::max<uint64_t>(TimerWheel::ticks(period), 1) : 0;
+
+    timer.callback = callback;
+
+    timer.identifier = identifier;
+
+    timer.userptr = userptr;
+
+    timer.state = Timer::State::Pending;
+
+    this->insert(index);
+
+    this->numTimers++;
+
+    return (static_cast<uint64_t>(timer.generation) << 32) | index;
+}
+
+///
+/// Cancel a timer
+///
+/// @param handle The handle returned by `schedule()`
+/// @return `true` if the timer was pending, `false` if it has fired or has been cancelled already.
+/// @note A timer may cancel itself in its callback to stop repeating.
+///
+bool TimerWheel::cancel(Handle handle)
+{
+    uint32_t index = static_cast<uint32_t>(handle);
+
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+
+    // Guard: The handle must refer to a live timer
+    if (index >= this->timers.size() || this->timers[index].generation != generation)
+    {
+        return false;
+    }
+
+    Timer& timer = this->timers[index];
+
+    switch (timer.state)
+    {
+        case Timer::State::Pending:
+            this->unlink(index);
+
+            this->release(index);
+
+            return true;
+
+        case Timer::State::Firing:
+            // The timer is released once its callback returns
+            timer.period = 0;
+
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+///
+/// Get the time left until a timer fires next
+///
+/// @param handle The handle returned by `schedule()`
+/// @return The remaining time in milliseconds, or `-1` if the timer is not pending.
+/// @note The fraction of a tick accumulated by `advance()` is taken into account,
+///       so that rescheduling a timer with the returned delay preserves its phase.
+///
+float TimerWheel::getRemaining(Handle handle) const
+{
+    uint32_t index = static_cast<uint32_t>(handle);
+
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+
+    // Guard: The handle must refer to a pending timer
+    if (index >= this->timers.size() || this->timers[index].generation != generation || this->timers[index].state != Timer::State::Pending)
+    {
+        return -1;
+    }
+
+    return (this->timers[index].deadline - this->now) * TimerWheel::TICK - this->remainder;
+}
+
+///
+/// Advance the clock and fire all timers that are due
+///
+/// @param ms The elapsed time since the last advance in milliseconds
+/// @note Timers due in the same tick fire in a batch in the order they were scheduled.
+///
+void TimerWheel::advance(float ms)
+{
+    this->remainder += ms;
+
+    uint64_t elapsed = static_cast<uint64_t>(this->remainder / TimerWheel::TICK);
+
+    this->remainder -= elapsed * TimerWheel::TICK;
+
+    // An empty wheel has nothing to cascade or fire
+    if (this->numTimers == 0)
+    {
+        this->now += elapsed;
+
+        return;
+    }
+
+    for (uint64_t index = 0; index < elapsed; index++)
+    {
+        this->tick();
+    }
+}
+
+///
+/// Cancel all timers
+///
+void TimerWheel::clear()
+{
+    for (uint32_t index = 0; index < this->timers.size(); index++)
+    {
+        Timer& timer = this->timers[index];
+
+        switch (timer.state)
+        {
+            case Timer::State::Pending:
+                this->unlink(index);
+
+                this->release(index);
+
+                break;
+
+            case Timer::State::Firing:
+                timer.period = 0;
+
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+///
+/// [Private Helper] Move the clock ahead by one tick and fire the timers that are due
+///
+void TimerWheel::tick()
+{
+    this->now++;
+
+    // Move the timers of each higher level whose slot has just become current down, starting from the top
+    for (uint32_t level = TimerWheel::NUM_LEVELS - 1; level > 0; level--)
+    {
+        uint64_t mask = (1ull << (TimerWheel::SLOT_BITS * level)) - 1;
+
+        if ((this->now & mask) != 0)
+        {
+            continue;
+        }
+
+        uint32_t& head = this->slots[level][(this->now >> (TimerWheel::SLOT_BITS * level)) & (TimerWheel::NUM_SLOTS - 1)];
+
+        uint32_t index = head;
+
+        head = TimerWheel::NIL;
+
+        while (index != TimerWheel::NIL)
+        {
+            uint32_t next = this->timers[index].next;
+
+            this->insert(index);
+
+            index = next;
+        }
+    }
+
+    // Fire the timers in the current slot of the lowest level
+    // Callbacks may schedule or cancel timers, so the list is consumed one timer at a time
+    uint32_t& head = this->slots[0][this->now & (TimerWheel::NUM_SLOTS - 1)];
+
+    while (head != TimerWheel::NIL)
+    {
+        uint32_t index = head;
+
+        this->unlink(index);
+
+        // The pool may grow in the callback, so the node is looked up again afterwards
+        Timer& timer = this->timers[index];
+
+        timer.state = Timer::State::Firing;
+
+        timer.callback(timer.identifier, timer.userptr);
+
+        Timer& fired = this->timers[index];
+
+        if (fired.period > 0)
+        {
+            fired.state = Timer::State::Pending;
+
+            fired.deadline += fired.period;
+
+            this->insert(index);
+        }
+        else
+        {
+            this->release(index);
+        }
+    }
+}
+
+///
+/// [Private Helper] Put a timer into the slot that matches its deadline
+///
+void TimerWheel::insert(uint32_t index)
+{
+    Timer& timer = this->timers[index];
+
+    uint64_t delta = timer.deadline > this->now ? timer.deadline - this->now : 0;
+
+    // Find the lowest level that covers the delta
+    // Timers beyond the range of the top level stay there and are reinserted when their slot comes around
+    uint32_t level = 0;
+
+    while (level + 1 < TimerWheel::NUM_LEVELS && delta >= (1ull << (TimerWheel::SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    timer.level = static_cast<uint8_t>(level);
+
+    timer.slot = static_cast<uint8_t>((timer.deadline >> (TimerWheel::SLOT_BITS * level)) & (TimerWheel::NUM_SLOTS - 1));
+
+    // Append to the tail so that timers due in the same tick fire in order
+    uint32_t& head = this->slots[level][timer.slot];
+
+    timer.next = TimerWheel::NIL;
+
+    if (head == TimerWheel::NIL)
+    {
+        timer.prev = index;
+
+        head = index;
+    }
+    else
+    {
+        // The head keeps a link to the tail
+        uint32_t tail = this->timers[head].prev;
+
+        timer.prev = tail;
+
+        this->timers[tail].next = index;
+
+        this->timers[head].prev = index;
+    }
+}
+
+///
+/// [Private Helper] Take a timer out of its slot
+///
+void TimerWheel::unlink(uint32_t index)
+{
+    Timer& timer = this->timers[index];
+
+    uint32_t& head = this->slots[timer.level][timer.slot];
+
+    if (head == index)
+    {
+        head = timer.next;
+
+        // The new head inherits the link to the tail
+        if (head != TimerWheel::NIL)
+        {
+            this->timers[head].prev = timer.prev;
+        }
+    }
+    else
+    {
+        this->timers[timer.prev].next = timer.next;
+
+        // Keep the link from the head to the tail up to date
+        uint32_t successor = timer.next != TimerWheel::NIL ? timer.next : head;
+
+        this->timers[successor].prev = timer.prev;
+    }
+}
+
+///
+/// [Private Helper] Return a timer to the free list
+///
+void TimerWheel::release(uint32_t index)
+{
+    Timer& timer = this->timers[index];
+
+    timer.state = Timer::State::Free;
+
+    timer.generation++;
+
+    timer.next = this->freelist;
+
+    this->freelist = index;
+
+    this->numTimers--;
+}
+
+///
+/// [Private Helper] Convert milliseconds to ticks, rounding up
+///
+uint64_t TimerWheel::ticks(float ms)
+{
+    return ms > 0 ? static_cast<uint64_t>(ceilf(ms / TimerWheel::TICK)) : 0;
+}
@@ -0,0 +1,191 @@
+//
+//  TimerWheel.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-08.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef TimerWheel_hpp
+#define TimerWheel_hpp
+
+#include <vector>
+#include <stdint.h>
+
+/// A hierarchical timer wheel driven by the simulation clock
+///
+/// Timers are kept in 4 levels of 64 slots with a resolution of 1 millisecond,
+/// so scheduling and cancelling a timer are O(1) and each tick only visits the timers that are due.
+/// Timers of a higher level are moved down a level when their slot becomes current.
+class TimerWheel
+{
+public:
+    ///
+    /// Type of a timer callback
+    ///
+    /// @param identifier The identifier passed to `schedule()`, e.g. an entity identifier
+    /// @param userptr The user pointer passed to `schedule()`
+    ///
+    using Callback = void (*)(int identifier, void* userptr);
+
+    /// Identifies a scheduled timer; 0 never identifies a timer
+    using Handle = uint64_t;
+
+    /// The resolution of the wheel in milliseconds
+    static constexpr float TICK = 1.f;
+
+    ///
+    /// Create an empty wheel
+    ///
+    TimerWheel();
+
+    ///
+    /// Schedule a timer
+    ///
+    /// @param delay The delay in milliseconds; rounded up to the next tick
+    /// @param callback The function to invoke when the timer fires
+    /// @param identifier An identifier passed to the callback
+    /// @param userptr A user pointer passed to the callback
+    /// @param period The period in milliseconds of a repeating timer; 0 for a one-shot timer
+    /// @return The handle of the new timer.
+    /// @note A timer never fires in the tick that schedules it, even if the delay is 0.
+    ///
+    Handle schedule(float delay, Callback callback, int identifier, void* userptr, float period = 0);
+
+    ///
+    /// Cancel a timer
+    ///
+    /// @param handle The handle returned by `schedule()`
+    /// @return `true` if the timer was pending, `false` if it has fired or has been cancelled already.
+    /// @note A timer may cancel itself in its callback to stop repeating.
+    ///
+    bool cancel(Handle handle);
+
+    ///
+    /// Get the time left until a timer fires next
+    ///
+    /// @param handle The handle returned by `schedule()`
+    /// @return The remaining time in milliseconds, or `-1` if the timer is not pending.
+    /// @note The fraction of a tick accumulated by `advance()` is taken into account,
+    ///       so that rescheduling a timer with the returned delay preserves its phase.
+    ///
+    float getRemaining(Handle handle) const;
+
+    ///
+    /// Advance the clock and fire all timers that are due
+    ///
+    /// @param ms The elapsed time since the last advance in milliseconds
+    /// @note Timers due in the same tick fire in a batch in the order they were scheduled.
+    ///
+    void advance(float ms);
+
+    ///
+    /// Cancel all timers
+    ///
+    void clear();
+
+    ///
+    /// [FAST] Get the number of pending timers
+    ///
+    inline uint32_t getNumTimers() const
+    {
+        return this->numTimers;
+    }
+
+private:
+    /// The number of bits of a slot index
+    static constexpr uint32_t SLOT_BITS = 6;
+
+    /// The number of slots of a level
+    static constexpr uint32_t NUM_SLOTS = 1 << SLOT_BITS;
+
+    /// The number of levels
+    static constexpr uint32_t NUM_LEVELS = 4;
+
+    /// Marks the end of a list
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    /// A node in the timer pool
+    struct Timer
+    {
+        /// States of a timer
+        enum class State : uint8_t
+        {
+            Free,
+            Pending,
+            Firing
+        };
+
+        /// The tick at which the timer fires
+        uint64_t deadline;
+
+        /// The period in ticks; 0 for a one-shot timer
+        uint64_t period;
+
+        Callback callback;
+
+        int identifier;
+
+        void* userptr;
+
+        /// Incremented whenever the node is released, so that stale handles are rejected
+        uint32_t generation;
+
+        /// Links of the slot list or of the free list
+        uint32_t prev;
+
+        uint32_t next;
+
+        /// The slot that holds the timer
+        uint8_t level;
+
+        uint8_t slot;
+
+        State state;
+    };
+
+    /// The timer pool
+    std::vector<Timer> timers;
+
+    /// The first free node in the pool
+    uint32_t freelist;
+
+    /// The first timer in each slot
+    uint32_t slots[NUM_LEVELS][NUM_SLOTS];
+
+    /// The current tick
+    uint64_t now;
+
+    /// The elapsed time that does not make up a whole tick yet
+    float remainder;
+
+    /// The number of pending timers
+    uint32_t numTimers;
+
+    ///
+    /// [Private Helper] Move the clock ahead by one tick and fire the timers that are due
+    ///
+    void tick();
+
+    ///
+    /// [Private Helper] Put a timer into the slot that matches its deadline
+    ///
+    void insert(uint32_t index);
+
+    ///
+    /// [Private Helper] Take a timer out of its slot
+    ///
+    void unlink(uint32_t index);
+
+    ///
+    /// [Private Helper] Return a timer to the free list
+    ///
+    void release(uint32_t index);
+
+    ///
+    /// [Private Helper] Convert milliseconds to ticks, rounding up
+    ///
+    static uint64_t ticks(float ms);
+};
+
+#endif /* TimerWheel_hpp */
@@ -0,0 +1,314 @@
+//
+//  TraceRecorder.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-04.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "TraceRecorder.hpp"
+#include "Debug.hpp"
+#include <algorithm>
+#include <thread>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/// Private instance
+TraceRecorder* TraceRecorder::instance = nullptr;
+
+/// Get the shared instance
+TraceRecorder* TraceRecorder::shared()
+{
+    if (TraceRecorder::instance == nullptr)
+    {
+        TraceRecorder::instance = new TraceRecorder();
+    }
+
+    return TraceRecorder::instance;
+}
+
+/// Private constructor
+TraceRecorder::TraceRecorder() : enabled(false), next(0), mask(0), epoch(Clock::now())
+{
+    this->setCapacity(TraceRecorder::DEF_CAPACITY);
+}
+
+///
+/// Start or stop recording
+///
+/// @param enabled Pass `true` to start recording, `false` to stop.
+/// @note Events recorded so far are discarded when the recorder is enabled again.
+///       Stopping flushes the events to the output file, or to a timestamped file if no output path is set.
+///
+void TraceRecorder::setEnabled(bool enabled)
+{
+    bool wasEnabled = this->enabled.exchange(enabled);
+
+    if (enabled && !wasEnabled)
+    {
+        // Invalidate all slots so that stale events are not flushed
+        for (uint64_t index = 0; index <= this->mask; index++)
+        {
+            this->events[index].sequence.store(0, std::memory_order_relaxed);
+        }
+
+        this->next.store(0, std::memory_order_release);
+
+        pinfo("Started recording trace events.");
+    }
+    else if (!enabled && wasEnabled)
+    {
+        // Recording toggled at runtime without `--trace` goes to a timestamped file in the working directory
+        char path[64] = {};
+
+        if (this->outputPath.empty())
+        {
+            time_t now = time(nullptr);
+
+            strftime(path, sizeof(path), "SubmarineWars.%Y%m%d-%H%M%S.trace.json", localtime(&now));
+        }
+
+        const char* output = this->outputPath.empty() ? path : this->outputPath.data();
+
+        if (this->flush(output))
+        {
+            pinfo("Stopped recording trace events. Written to %s.", output);
+        }
+        else
+        {
+            pserror("Failed to flush the trace events to %s.", output);
+        }
+    }
+}
+
+///
+/// Set the number of events in the ring buffer
+///
+/// @param capacity The new capacity; rounded up to a power of 2
+/// @warning This method must not be called while the recorder is enabled.
+///
+void TraceRecorder::setCapacity(uint32_t capacity)
+{
+    passert(!this->isEnabled(), "API Usage Error: Cannot resize the ring buffer while recording.");
+
+    uint64_t size = 1;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    this->events.reset(new Event[size]);
+
+    for (uint64_t index = 0; index < size; index++)
+    {
+        this->events[index].sequence.store(0, std::memory_order_relaxed);
+    }
+
+    this->mask = size - 1;
+
+    this->next.store(0, std::memory_order_release);
+}
+
+///
+/// Set the file to which the events are flushed when the recording stops
+///
+/// @param path The output file path
+///
+void TraceRecorder::setOutputPath(const char* path)
+{
+    this->outputPath.assign(path, path + strlen(path) + 1);
+}
+
+///
+/// Capture the last few seconds to a file whenever a frame exceeds the given threshold
+///
+/// @param threshold The frame time threshold in milliseconds; pass `0` to disable the hitch capture
+/// @param window The length of the capture in milliseconds
+/// @note The recorder keeps recording after a capture; captures are at least `window` apart.
+///
+void TraceRecorder::setHitchCapture(float threshold, float window)
+{
+    this->hitchThreshold = threshold;
+
+    this->hitchWindow = (int64_t) (window * 1000);
+}
+
+///
+/// Record a complete event
+///
+/// @param name The event name; must be a string literal or outlive the recorder
+/// @param category The event category; must be a string literal or outlive the recorder
+/// @param start The start timestamp in microseconds
+/// @param duration The duration in microseconds
+/// @note This method is lock-free and safe to call from any thread.
+///
+void TraceRecorder::record(const char* name, const char* category, int64_t start, int64_t duration)
+{
+    // Claim a slot; The oldest event is overwritten once the ring is full
+    uint64_t sequence = this->next.fetch_add(1, std::memory_order_relaxed);
+
+    Event& event = this->events[sequence & this->mask];
+
+    // Mark the slot as being written so that a concurrent flush skips it
+    event.sequence.store(0, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    event.name = name;
+
+    event.category = category;
+
+    event.start = start;
+
+    event.duration = duration;
+
+    event.thread = TraceRecorder::currentThread();
+
+    // Publish the event
+    event.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+///
+/// Called when a frame has finished
+///
+/// @param ms The elapsed time of the frame in milliseconds
+/// @note The recorder checks for hitches here.
+///
+void TraceRecorder::frameDidEnd(float ms)
+{
+    // Guard: The hitch capture must be enabled and the frame must be a hitch
+    if (!this->isEnabled() || this->hitchThreshold <= 0 || ms < this->hitchThreshold)
+    {
+        return;
+    }
+
+    int64_t now = this->now();
+
+    // Guard: Do not capture overlapping windows
+    if (now - this->lastHitchCapture < this->hitchWindow)
+    {
+        return;
+    }
+
+    this->lastHitchCapture = now;
+
+    this->record("Hitch", "frame", now - (int64_t) (ms * 1000), (int64_t) (ms * 1000));
+
+    // Hitch captures are written next to the output file
+    char path[1024] = {};
+
+    snprintf(path, sizeof(path), "%s.hitch%u.json", this->outputPath.empty() ? "SubmarineWars.trace" : this->outputPath.data(), this->numHitchCaptures++);
+
+    pinfo("Detected a hitch of %.2f ms. Capturing the last %lld ms to %s.", ms, (long long) (this->hitchWindow / 1000), path);
+
+    psoftassert(this->flush(path, now - this->hitchWindow), "Failed to capture the hitch.");
+}
+
+///
+/// Flush events in the ring buffer to the given file in the Chrome `trace_event` JSON format
+///
+/// @param path The output file path
+/// @param since Only flush events that end at or after this timestamp in microseconds; by default all events
+/// @return `true` on success, `false` otherwise.
+///
+bool TraceRecorder::flush(const char* path, int64_t since)
+{
+    // Take a consistent copy of all published events
+    struct Snapshot
+    {
+        const char* name;
+
+        const char* category;
+
+        int64_t start;
+
+        int64_t duration;
+
+        uint32_t thread;
+    };
+
+    uint64_t last = this->next.load(std::memory_order_acquire);
+
+    uint64_t first = last > this->mask ? last - this->mask - 1 : 0;
+
+    std::vector<Snapshot> snapshots;
+
+    snapshots.reserve(last - first);
+
+    for (uint64_t sequence = first; sequence < last; sequence++)
+    {
+        Event& event = this->events[sequence & this->mask];
+
+        if (event.sequence.load(std::memory_order_acquire) != sequence + 1)
+        {
+            continue;
+        }
+
+        Snapshot snapshot = {event.name, event.category, event.start, event.duration, event.thread};
+
+        // Guard: Discard the copy if a writer has reclaimed the slot meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (event.sequence.load(std::memory_order_relaxed) != sequence + 1)
+        {
+            continue;
+        }
+
+        if (snapshot.start + std::max<int64_t>(snapshot.duration, 0) >= since)
+        {
+            snapshots.push_back(snapshot);
+        }
+    }
+
+    // Viewers expect events to be ordered by their start timestamps
+    std::sort(snapshots.begin(), snapshots.end(), [] (const Snapshot& lhs, const Snapshot& rhs) { return lhs.start < rhs.start; });
+
+    FILE* file = fopen(path, "w");
+
+    if (file == nullptr)
+    {
+        pserror("Failed to open the trace file %s.", path);
+
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    for (size_t index = 0; index < snapshots.size(); index++)
+    {
+        const Snapshot& snapshot = snapshots[index];
+
+        if (snapshot.duration < 0)
+        {
+            fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":%u}%s\n",
+                    snapshot.name, snapshot.category, (long long) snapshot.start, snapshot.thread, index + 1 < snapshots.size() ? "," : "");
+        }
+        else
+        {
+            fprintf(file, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%u}%s\n",
+                    snapshot.name, snapshot.category, (long long) snapshot.start, (long long) snapshot.duration, snapshot.thread, index + 1 < snapshots.size() ? "," : "");
+        }
+    }
+
+    fprintf(file, "]}\n");
+
+    fclose(file);
+
+    pinfo("Flushed %zu trace events to %s.", snapshots.size(), path);
+
+    return true;
+}
+
+///
+/// Get a small identifier of the calling thread
+///
+uint32_t TraceRecorder::currentThread()
+{
+    static std::atomic<uint32_t> counter(0);
+
+    thread_local uint32_t identifier = ++counter;
+
+    return identifier;
+}
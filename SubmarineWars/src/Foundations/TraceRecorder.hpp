@@ -0,0 +1,250 @@
+//
+//  TraceRecorder.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-04.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef TraceRecorder_hpp
+#define TraceRecorder_hpp
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+/// Enable the trace points by default; Define `SW_TRACING` to 0 to compile all trace points out
+#ifndef SW_TRACING
+#define SW_TRACING 1
+#endif
+
+/// A singleton that records trace events into a lock-free in-memory ring buffer
+/// and exports them in the Chrome `trace_event` JSON format (chrome://tracing or Perfetto)
+class TraceRecorder
+{
+public:
+    /// The clock used to timestamp events
+    using Clock = std::chrono::steady_clock;
+
+    /// The default number of events in the ring buffer; must be a power of 2
+    static constexpr uint32_t DEF_CAPACITY = 1 << 16;
+
+    /// The default length of the hitch capture in milliseconds
+    static constexpr float DEF_HITCH_WINDOW = 5000.f;
+
+    /// Get the shared instance
+    static TraceRecorder* shared();
+
+    ///
+    /// [FAST] Check whether the recorder is recording
+    ///
+    inline bool isEnabled() const
+    {
+        return this->enabled.load(std::memory_order_relaxed);
+    }
+
+    ///
+    /// Start or stop recording
+    ///
+    /// @param enabled Pass `true` to start recording, `false` to stop.
+    /// @note Events recorded so far are discarded when the recorder is enabled again.
+    ///       Stopping flushes the events to the output file, or to a timestamped file if no output path is set.
+    ///
+    void setEnabled(bool enabled);
+
+    ///
+    /// Set the number of events in the ring buffer
+    ///
+    /// @param capacity The new capacity; rounded up to a power of 2
+    /// @warning This method must not be called while the recorder is enabled.
+    ///
+    void setCapacity(uint32_t capacity);
+
+    ///
+    /// Set the file to which the events are flushed when the recording stops
+    ///
+    /// @param path The output file path
+    ///
+    void setOutputPath(const char* path);
+
+    ///
+    /// Capture the last few seconds to a file whenever a frame exceeds the given threshold
+    ///
+    /// @param threshold The frame time threshold in milliseconds; pass `0` to disable the hitch capture
+    /// @param window The length of the capture in milliseconds
+    /// @note The recorder keeps recording after a capture; captures are at least `window` apart.
+    ///
+    void setHitchCapture(float threshold, float window = TraceRecorder::DEF_HITCH_WINDOW);
+
+    ///
+    /// [FAST] Get the current timestamp in microseconds since the recorder is created
+    ///
+    inline int64_t now() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - this->epoch).count();
+    }
+
+    ///
+    /// Record a complete event
+    ///
+    /// @param name The event name; must be a string literal or outlive the recorder
+    /// @param category The event category; must be a string literal or outlive the recorder
+    /// @param start The start timestamp in microseconds
+    /// @param duration The duration in microseconds
+    /// @note This method is lock-free and safe to call from any thread.
+    ///
+    void record(const char* name, const char* category, int64_t start, int64_t duration);
+
+    ///
+    /// Record an instant event
+    ///
+    /// @param name The event name; must be a string literal or outlive the recorder
+    /// @param category The event category; must be a string literal or outlive the recorder
+    ///
+    inline void mark(const char* name, const char* category)
+    {
+        if (this->isEnabled())
+        {
+            this->record(name, category, this->now(), -1);
+        }
+    }
+
+    ///
+    /// Called when a frame has finished
+    ///
+    /// @param ms The elapsed time of the frame in milliseconds
+    /// @note The recorder checks for hitches here.
+    ///
+    void frameDidEnd(float ms);
+
+    ///
+    /// Flush events in the ring buffer to the given file in the Chrome `trace_event` JSON format
+    ///
+    /// @param path The output file path
+    /// @param since Only flush events that end at or after this timestamp in microseconds; by default all events
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool flush(const char* path, int64_t since = 0);
+
+private:
+    /// A trace event
+    struct Event
+    {
+        /// The sequence number of the event stored in this slot plus 1; 0 if the slot is being written
+        std::atomic<uint64_t> sequence;
+
+        /// The event name
+        const char* name;
+
+        /// The event category
+        const char* category;
+
+        /// The start timestamp in microseconds
+        int64_t start;
+
+        /// The duration in microseconds; negative for an instant event
+        int64_t duration;
+
+        /// The recording thread
+        uint32_t thread;
+    };
+
+    /// Private instance
+    static TraceRecorder* instance;
+
+    /// `true` if the recorder is recording
+    std::atomic<bool> enabled;
+
+    /// The sequence number of the next event
+    std::atomic<uint64_t> next;
+
+    /// The ring buffer
+    std::unique_ptr<Event[]> events;
+
+    /// The capacity of the ring buffer minus 1
+    uint64_t mask;
+
+    /// The reference time point of all timestamps
+    Clock::time_point epoch;
+
+    /// The file to which events are flushed when the recording stops
+    std::vector<char> outputPath;
+
+    /// The frame time threshold of the hitch capture in milliseconds; 0 if disabled
+    float hitchThreshold = 0;
+
+    /// The length of the hitch capture in microseconds
+    int64_t hitchWindow = 0;
+
+    /// The timestamp of the last hitch capture
+    int64_t lastHitchCapture = INT64_MIN / 2;
+
+    /// The number of hitch captures written so far
+    uint32_t numHitchCaptures = 0;
+
+    ///
+    /// Get a small identifier of the calling thread
+    ///
+    static uint32_t currentThread();
+
+    /// Private constructor
+    TraceRecorder();
+};
+
+/// A trace point that records its lifetime as a complete event
+class TraceScope
+{
+public:
+    ///
+    /// [Constructor] Start the event
+    ///
+    /// @param name The event name; must be a string literal
+    /// @param category The event category; must be a string literal
+    ///
+    inline TraceScope(const char* name, const char* category) : name(name), category(category), start(-1)
+    {
+        if (TraceRecorder::shared()->isEnabled())
+        {
+            this->start = TraceRecorder::shared()->now();
+        }
+    }
+
+    /// [Destructor] End the event
+    inline ~TraceScope()
+    {
+        if (this->start >= 0)
+        {
+            auto recorder = TraceRecorder::shared();
+
+            recorder->record(this->name, this->category, this->start, recorder->now() - this->start);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    /// The event name
+    const char* name;
+
+    /// The event category
+    const char* category;
+
+    /// The start timestamp; negative if the recorder was not recording
+    int64_t start;
+};
+
+#define SW_TRACE_CONCAT_IMP(a, b) a##b
+#define SW_TRACE_CONCAT(a, b) SW_TRACE_CONCAT_IMP(a, b)
+
+#if SW_TRACING
+/// Trace the rest of the enclosing scope as an event of the given name and category
+#define SW_TRACE_SCOPE(name, category) TraceScope SW_TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#else
+#define SW_TRACE_SCOPE(name, category)
+#endif
+
+#endif /* TraceRecorder_hpp */
@@ -0,0 +1,145 @@
+//
+//  WorkerPool.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "WorkerPool.hpp"
+#include <algorithm>
+
+///
+/// Start the worker threads
+///
+/// @param numThreads The number of threads that run a batch, including the calling thread;
+///                   Clamped to [1, MAX_NUM_THREADS], and 1 runs all tasks on the calling thread.
+///
+WorkerPool::WorkerPool(uint32_t numThreads) : nextTask(0)
+{
+    numThreads = std::min(std::max(numThreads, 1u), uint32_t(WorkerPool::MAX_NUM_THREADS));
+
+    this->threads.reserve(numThreads - 1);
+
+    for (uint32_t index = 1; index < numThreads; index++)
+    {
+        this->threads.emplace_back(&WorkerPool::work, this);
+    }
+}
+
+///
+/// [Destructor] Stop and join the worker threads
+///
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        this->stopping = true;
+    }
+
+    this->wakeup.notify_all();
+
+    for (auto& thread : this->threads)
+    {
+        thread.join();
+    }
+}
+
+///
+/// Run a batch of tasks and wait until all of them have finished
+///
+/// @param numTasks The number of tasks
+/// @param task A function that runs the task with the given index; Called from several threads at the same time.
+/// @note Tasks run in no particular order, so each task must write to its own output.
+///
+void WorkerPool::run(uint32_t numTasks, const std::function<void(uint32_t)>& task)
+{
+    // Guard: A single task or a single thread does not need the workers
+    if (numTasks <= 1 || this->threads.empty())
+    {
+        for (uint32_t index = 0; index < numTasks; index++)
+        {
+            task(index);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        this->task = &task;
+
+        this->numTasks = numTasks;
+
+        this->nextTask.store(0);
+
+        this->numBusyWorkers = static_cast<uint32_t>(this->threads.size());
+
+        this->batch++;
+    }
+
+    this->wakeup.notify_all();
+
+    // The calling thread works on the batch as well
+    this->drain();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    this->finished.wait(lock, [this] () { return this->numBusyWorkers == 0; });
+
+    this->task = nullptr;
+}
+
+///
+/// [Private Helper] The main loop of a worker thread
+///
+void WorkerPool::work()
+{
+    uint64_t lastBatch = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+
+            this->wakeup.wait(lock, [&] () { return this->stopping || this->batch != lastBatch; });
+
+            if (this->stopping)
+            {
+                return;
+            }
+
+            lastBatch = this->batch;
+        }
+
+        this->drain();
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            this->numBusyWorkers--;
+
+            if (this->numBusyWorkers != 0)
+            {
+                continue;
+            }
+        }
+
+        this->finished.notify_one();
+    }
+}
+
+///
+/// [Private Helper] Claim and run tasks of the current batch until none are left
+///
+void WorkerPool::drain()
+{
+    uint32_t index;
+
+    while ((index = this->nextTask.fetch_add(1)) < this->numTasks)
+    {
+        (*this->task)(index);
+    }
+}
@@ -0,0 +1,107 @@
+//
+//  WorkerPool.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef WorkerPool_hpp
+#define WorkerPool_hpp
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+/// A fixed set of worker threads that run batches of independent tasks
+///
+/// The threads are started once and sleep between batches, so a batch per frame does not pay for creating threads.
+/// The calling thread takes part in each batch, and tasks are claimed one at a time from a shared counter,
+/// so a slow task does not hold up the others.
+class WorkerPool
+{
+public:
+    /// The maximum number of threads, including the calling thread
+    static constexpr uint32_t MAX_NUM_THREADS = 64;
+
+    ///
+    /// Start the worker threads
+    ///
+    /// @param numThreads The number of threads that run a batch, including the calling thread;
+    ///                   Clamped to [1, MAX_NUM_THREADS], and 1 runs all tasks on the calling thread.
+    ///
+    explicit WorkerPool(uint32_t numThreads);
+
+    ///
+    /// [Destructor] Stop and join the worker threads
+    ///
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ///
+    /// Run a batch of tasks and wait until all of them have finished
+    ///
+    /// @param numTasks The number of tasks
+    /// @param task A function that runs the task with the given index; Called from several threads at the same time.
+    /// @note Tasks run in no particular order, so each task must write to its own output.
+    ///
+    void run(uint32_t numTasks, const std::function<void(uint32_t)>& task);
+
+    ///
+    /// [FAST] Get the number of threads that run a batch, including the calling thread
+    ///
+    inline uint32_t getNumThreads() const
+    {
+        return static_cast<uint32_t>(this->threads.size()) + 1;
+    }
+
+private:
+    /// The worker threads
+    std::vector<std::thread> threads;
+
+    /// Guards the batch state below
+    std::mutex mutex;
+
+    /// Wakes up the workers when a batch starts or the pool stops
+    std::condition_variable wakeup;
+
+    /// Wakes up the calling thread when the last worker has finished a batch
+    std::condition_variable finished;
+
+    /// The task of the current batch
+    const std::function<void(uint32_t)>* task = nullptr;
+
+    /// The number of tasks in the current batch
+    uint32_t numTasks = 0;
+
+    /// The index of the next task to claim
+    std::atomic<uint32_t> nextTask;
+
+    /// The number of workers that have not finished the current batch
+    uint32_t numBusyWorkers = 0;
+
+    /// Incremented by each batch, so that a worker runs each batch once
+    uint64_t batch = 0;
+
+    /// Indicates that the workers should exit
+    bool stopping = false;
+
+    ///
+    /// [Private Helper] The main loop of a worker thread
+    ///
+    void work();
+
+    ///
+    /// [Private Helper] Claim and run tasks of the current batch until none are left
+    ///
+    void drain();
+};
+
+#endif /* WorkerPool_hpp */
@@ -0,0 +1,515 @@
+//
+//  GlyphAtlas.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "GlyphAtlas.hpp"
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <string.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+/// A squared distance that is farther than any pixel of a glyph
+static constexpr float FAR_AWAY = 1e20f;
+
+///
+/// [Helper] Replace each value of a grid by its squared distance to the nearest zero
+///
+/// @param grid The grid, row by row, with 0 at the pixels to measure the distance to and `FAR_AWAY` elsewhere
+/// @param width The width of the grid
+/// @param height The height of the grid
+/// @note This is the exact transform of Felzenszwalb and Huttenlocher, run over the columns and then over the rows,
+///       so it takes linear time in the number of pixels.
+///
+static void transformDistances(std::vector<float>& grid, uint32_t width, uint32_t height)
+{
+    uint32_t length = std::max(width, height);
+
+    // The samples of one line, their lower envelope of parabolas, the boundaries between the parabolas and the result
+    std::vector<float> samples(length), boundaries(length + 1), distances(length);
+
+    std::vector<uint32_t> parabolas(length);
+
+    auto transformLine = [&] (uint32_t count)
+    {
+        uint32_t k = 0;
+
+        parabolas[0] = 0;
+
+        boundaries[0] = -std::numeric_limits<float>::infinity();
+
+        boundaries[1] = std::numeric_limits<float>::infinity();
+
+        for (uint32_t q = 1; q < count; q++)
+        {
+            auto intersect = [&] ()
+            {
+                float p = static_cast<float>(parabolas[k]);
+
+                return ((samples[q] + static_cast<float>(q) * q) - (samples[parabolas[k]] + p * p)) / (2.f * q - 2.f * p);
+            };
+
+            float s = intersect();
+
+            // Drop the parabolas hidden by the new one
+            while (s <= boundaries[k])
+            {
+                k--;
+
+                s = intersect();
+            }
+
+            k++;
+
+            parabolas[k] = q;
+
+            boundaries[k] = s;
+
+            boundaries[k + 1] = std::numeric_limits<float>::infinity();
+        }
+
+        k = 0;
+
+        for (uint32_t q = 0; q < count; q++)
+        {
+            while (boundaries[k + 1] < q)
+            {
+                k++;
+            }
+
+            float offset = static_cast<float>(q) - parabolas[k];
+
+            distances[q] = offset * offset + samples[parabolas[k]];
+        }
+    };
+
+    for (uint32_t x = 0; x < width; x++)
+    {
+        for (uint32_t y = 0; y < height; y++)
+        {
+            samples[y] = grid[y * width + x];
+        }
+
+        transformLine(height);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            grid[y * width + x] = distances[y];
+        }
+    }
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        std::copy_n(&grid[y * width], width, samples.begin());
+
+        transformLine(width);
+
+        std::copy_n(distances.begin(), width, &grid[y * width]);
+    }
+}
+
+///
+/// Rasterize and pack the printable characters
+///
+/// @param path The path to the font file
+/// @param pixelSize The height of the characters in pixels
+/// @return `true` on success, `false` otherwise.
+/// @note This method makes no GL calls and is safe to call on a worker thread.
+///
+bool GlyphAtlas::rasterize(const char* path, uint32_t pixelSize)
+{
+    // A library of our own, as FreeType objects must not be shared across threads
+    FT_Library library = nullptr;
+
+    FT_Face face = nullptr;
+
+    // Guard: Initialize the library
+    if (FT_Init_FreeType(&library) != 0)
+    {
+        pserror("Failed to initialize the FreeType library.");
+
+        return false;
+    }
+
+    // Guard: Load the font and set its size
+    if (FT_New_Face(library, path, 0, &face) != 0 || FT_Set_Pixel_Sizes(face, 0, pixelSize) != 0)
+    {
+        pserror("Failed to load the font at %s with size %u.", path, pixelSize);
+
+        FT_Done_FreeType(library);
+
+        return false;
+    }
+
+    // Pass 1: Rasterize each printable character
+    uint32_t numChars = LAST_PRINTABLE_CHAR - FIRST_PRINTABLE_CHAR + 1;
+
+    std::vector<std::vector<uint8_t>> bitmaps(numChars);
+
+    for (uint32_t index = 0; index < numChars; index++)
+    {
+        auto character = static_cast<char>(FIRST_PRINTABLE_CHAR + index);
+
+        // Guard: Render the glyph
+        if (FT_Load_Char(face, character, FT_LOAD_RENDER) != 0)
+        {
+            pwarning("Failed to render the character [%c] at size %u.", character, pixelSize);
+
+            continue;
+        }
+
+        const FT_GlyphSlot slot = face->glyph;
+
+        Glyph& glyph = this->glyphs[static_cast<uint8_t>(character)];
+
+        glyph.width = static_cast<uint16_t>(slot->bitmap.width);
+
+        glyph.height = static_cast<uint16_t>(slot->bitmap.rows);
+
+        glyph.bearingX = static_cast<int16_t>(slot->bitmap_left);
+
+        glyph.bearingY = static_cast<int16_t>(slot->bitmap_top);
+
+        glyph.advance = static_cast<uint32_t>(slot->advance.x);
+
+        // The pitch may exceed the width, so copy the bitmap row by row
+        bitmaps[index].resize(static_cast<size_t>(glyph.width) * glyph.height);
+
+        for (uint32_t row = 0; row < glyph.height; row++)
+        {
+            memcpy(&bitmaps[index][row * glyph.width], slot->bitmap.buffer + row * slot->bitmap.pitch, glyph.width);
+        }
+    }
+
+    FT_Done_Face(face);
+
+    FT_Done_FreeType(library);
+
+    this->distanceField = false;
+
+    this->pack(bitmaps, pixelSize);
+
+    return true;
+}
+
+///
+/// Generate and pack the signed distance fields of the printable characters
+///
+/// @param path The path to the font file
+/// @return `true` on success, `false` otherwise.
+/// @note This method makes no GL calls and is safe to call on a worker thread.
+///
+bool GlyphAtlas::rasterizeDistanceField(const char* path)
+{
+    // A library of our own, as FreeType objects must not be shared across threads
+    FT_Library library = nullptr;
+
+    FT_Face face = nullptr;
+
+    // Guard: Initialize the library
+    if (FT_Init_FreeType(&library) != 0)
+    {
+        pserror("Failed to initialize the FreeType library.");
+
+        return false;
+    }
+
+    // Guard: Load the font at the size of the canvas, so that the outlines are thresholded with subpixel precision
+    if (FT_New_Face(library, path, 0, &face) != 0 || FT_Set_Pixel_Sizes(face, 0, DISTANCE_FIELD_PIXEL_SIZE * DISTANCE_FIELD_UPSAMPLE) != 0)
+    {
+        pserror("Failed to load the font at %s with size %u.", path, DISTANCE_FIELD_PIXEL_SIZE * DISTANCE_FIELD_UPSAMPLE);
+
+        FT_Done_FreeType(library);
+
+        return false;
+    }
+
+    auto upsample = static_cast<int32_t>(DISTANCE_FIELD_UPSAMPLE);
+
+    auto spread = static_cast<int32_t>(DISTANCE_FIELD_SPREAD);
+
+    // Pass 1: Generate the field of each printable character
+    uint32_t numChars = LAST_PRINTABLE_CHAR - FIRST_PRINTABLE_CHAR + 1;
+
+    std::vector<std::vector<uint8_t>> fields(numChars);
+
+    // The squared distances of the canvas pixels to the nearest pixel inside and outside the glyph
+    std::vector<float> toInside, toOutside;
+
+    for (uint32_t index = 0; index < numChars; index++)
+    {
+        auto character = static_cast<char>(FIRST_PRINTABLE_CHAR + index);
+
+        // Guard: Render the glyph
+        if (FT_Load_Char(face, character, FT_LOAD_RENDER) != 0)
+        {
+            pwarning("Failed to render the character [%c] for the distance field.", character);
+
+            continue;
+        }
+
+        const FT_GlyphSlot slot = face->glyph;
+
+        Glyph& glyph = this->glyphs[static_cast<uint8_t>(character)];
+
+        glyph.advance = static_cast<uint32_t>(slot->advance.x / upsample);
+
+        auto bitmapWidth = static_cast<int32_t>(slot->bitmap.width);
+
+        auto bitmapHeight = static_cast<int32_t>(slot->bitmap.rows);
+
+        // Guard: Spaces only advance the pen
+        if (bitmapWidth == 0 || bitmapHeight == 0)
+        {
+            continue;
+        }
+
+        // Align the bitmap to the texels of the field; The offsets are in canvas pixels
+        auto left = static_cast<int32_t>(floorf(static_cast<float>(slot->bitmap_left) / upsample));
+
+        auto top = static_cast<int32_t>(ceilf(static_cast<float>(slot->bitmap_top) / upsample));
+
+        int32_t offsetX = slot->bitmap_left - left * upsample;
+
+        int32_t offsetY = top * upsample - slot->bitmap_top;
+
+        // The field extends `spread` texels beyond the bitmap on each side
+        int32_t fieldWidth = (offsetX + bitmapWidth + upsample - 1) / upsample + 2 * spread;
+
+        int32_t fieldHeight = (offsetY + bitmapHeight + upsample - 1) / upsample + 2 * spread;
+
+        glyph.width = static_cast<uint16_t>(fieldWidth);
+
+        glyph.height = static_cast<uint16_t>(fieldHeight);
+
+        glyph.bearingX = static_cast<int16_t>(left - spread);
+
+        glyph.bearingY = static_cast<int16_t>(top + spread);
+
+        // Threshold the coverage onto a canvas of `upsample` x `upsample` pixels per texel
+        int32_t canvasWidth = fieldWidth * upsample;
+
+        int32_t canvasHeight = fieldHeight * upsample;
+
+        toInside.assign(static_cast<size_t>(canvasWidth) * canvasHeight, FAR_AWAY);
+
+        toOutside.assign(static_cast<size_t>(canvasWidth) * canvasHeight, 0.f);
+
+        for (int32_t row = 0; row < bitmapHeight; row++)
+        {
+            for (int32_t column = 0; column < bitmapWidth; column++)
+            {
+                if (slot->bitmap.buffer[row * slot->bitmap.pitch + column] >= 128)
+                {
+                    size_t pixel = static_cast<size_t>(spread * upsample + offsetY + row) * canvasWidth + spread * upsample + offsetX + column;
+
+                    toInside[pixel] = 0.f;
+
+                    toOutside[pixel] = FAR_AWAY;
+                }
+            }
+        }
+
+        transformDistances(toInside, canvasWidth, canvasHeight);
+
+        transformDistances(toOutside, canvasWidth, canvasHeight);
+
+        // Sample the signed distance at the center of each texel, which lies between the middle four pixels
+        fields[index].resize(static_cast<size_t>(fieldWidth) * fieldHeight);
+
+        for (int32_t y = 0; y < fieldHeight; y++)
+        {
+            for (int32_t x = 0; x < fieldWidth; x++)
+            {
+                float distance = 0.f;
+
+                for (int32_t dy = upsample / 2 - 1; dy <= upsample / 2; dy++)
+                {
+                    for (int32_t dx = upsample / 2 - 1; dx <= upsample / 2; dx++)
+                    {
+                        size_t pixel = static_cast<size_t>(y * upsample + dy) * canvasWidth + x * upsample + dx;
+
+                        // Distances are measured between pixel centers, but the outline lies half a pixel in between
+                        float signedDistance = sqrtf(toInside[pixel]) - sqrtf(toOutside[pixel]);
+
+                        distance += signedDistance > 0.f ? signedDistance - 0.5f : signedDistance + 0.5f;
+                    }
+                }
+
+                // Positive outside, in texels
+                distance /= 4.f * upsample;
+
+                // 0.5 on the outline, 1 at `spread` texels inside and 0 at `spread` texels outside
+                float value = std::min(std::max(0.5f - distance / (2.f * spread), 0.f), 1.f);
+
+                fields[index][y * fieldWidth + x] = static_cast<uint8_t>(lroundf(value * 255.f));
+            }
+        }
+    }
+
+    FT_Done_Face(face);
+
+    FT_Done_FreeType(library);
+
+    this->distanceField = true;
+
+    this->pack(fields, DISTANCE_FIELD_PIXEL_SIZE);
+
+    return true;
+}
+
+///
+/// Upload the packed glyphs to a texture
+///
+/// @return `true` on success, `false` if the glyphs have not been rasterized.
+/// @note The pixels are released afterwards; Subsequent calls are silently ignored.
+///
+bool GlyphAtlas::upload()
+{
+    // Guard: Upload only once
+    if (this->texture != 0)
+    {
+        return true;
+    }
+
+    // Guard: The glyphs must be ready
+    if (!this->isRasterized())
+    {
+        return false;
+    }
+
+    glGenTextures(1, &this->texture);
+
+    glBindTexture(GL_TEXTURE_2D, this->texture);
+
+    // Rows of a single channel texture are not aligned to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, this->width, this->height, 0, GL_RED, GL_UNSIGNED_BYTE, this->pixels.data());
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    std::vector<uint8_t>().swap(this->pixels);
+
+    return glGetError() == GL_NO_ERROR;
+}
+
+///
+/// Release the texture
+///
+void GlyphAtlas::destroy()
+{
+    glDeleteTextures(1, &this->texture);
+
+    this->texture = 0;
+}
+
+///
+/// [Private Helper] Pack the images of the printable characters and publish the atlas
+///
+/// @param images The image of each printable character, sized as its glyph
+/// @param pixelSize The height of the characters in pixels
+///
+void GlyphAtlas::pack(const std::vector<std::vector<uint8_t>>& images, uint32_t pixelSize)
+{
+    uint32_t numChars = LAST_PRINTABLE_CHAR - FIRST_PRINTABLE_CHAR + 1;
+
+    uint32_t area = 0;
+
+    for (uint32_t index = 0; index < numChars; index++)
+    {
+        const Glyph& glyph = this->glyphs[FIRST_PRINTABLE_CHAR + index];
+
+        area += (glyph.width + 2 * PADDING) * (glyph.height + 2 * PADDING);
+    }
+
+    // Pass 1: Pack tall glyphs first onto shelves of a power of two width that makes the texture roughly square
+    std::vector<uint32_t> order(numChars);
+
+    for (uint32_t index = 0; index < numChars; index++)
+    {
+        order[index] = index;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [this] (uint32_t lhs, uint32_t rhs)
+    {
+        return this->glyphs[FIRST_PRINTABLE_CHAR + lhs].height > this->glyphs[FIRST_PRINTABLE_CHAR + rhs].height;
+    });
+
+    this->width = 64;
+
+    while (this->width * this->width < area)
+    {
+        this->width *= 2;
+    }
+
+    uint32_t x = 0, y = 0, shelfHeight = 0;
+
+    std::vector<std::pair<uint32_t, uint32_t>> origins(numChars);
+
+    for (uint32_t index : order)
+    {
+        const Glyph& glyph = this->glyphs[FIRST_PRINTABLE_CHAR + index];
+
+        uint32_t glyphWidth = glyph.width + 2 * PADDING;
+
+        uint32_t glyphHeight = glyph.height + 2 * PADDING;
+
+        // Start a new shelf if the current one is full
+        if (x + glyphWidth > this->width)
+        {
+            x = 0;
+
+            y += shelfHeight;
+
+            shelfHeight = 0;
+        }
+
+        origins[index] = {x + PADDING, y + PADDING};
+
+        x += glyphWidth;
+
+        shelfHeight = std::max(shelfHeight, glyphHeight);
+    }
+
+    this->height = std::max(y + shelfHeight, 1u);
+
+    // Pass 2: Copy the images and compute the texture coordinates
+    this->pixels.assign(static_cast<size_t>(this->width) * this->height, 0);
+
+    for (uint32_t index = 0; index < numChars; index++)
+    {
+        Glyph& glyph = this->glyphs[FIRST_PRINTABLE_CHAR + index];
+
+        uint32_t left = origins[index].first;
+
+        uint32_t top = origins[index].second;
+
+        for (uint32_t row = 0; row < glyph.height; row++)
+        {
+            memcpy(&this->pixels[(top + row) * this->width + left], &images[index][row * glyph.width], glyph.width);
+        }
+
+        glyph.uv = { static_cast<float>(left) / this->width,
+                     static_cast<float>(top) / this->height,
+                     static_cast<float>(glyph.width) / this->width,
+                     static_cast<float>(glyph.height) / this->height };
+    }
+
+    this->pixelSize = pixelSize;
+
+    this->rasterized.store(true, std::memory_order_release);
+}
@@ -0,0 +1,177 @@
+//
+//  GlyphAtlas.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef GlyphAtlas_hpp
+#define GlyphAtlas_hpp
+
+#include "Foundations/Foundations.hpp"
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+/// The printable ASCII characters of a font at one pixel size packed into a single texture
+///
+/// All glyphs are rasterized at once and packed on shelves, i.e. rows of glyphs sorted by height,
+/// into a texture with a single channel that holds the coverage, as expected by `character.fs.glsl`.
+/// The metrics live in a flat table indexed by the character, so laying out text needs no FreeType calls,
+/// and a whole string is drawn from one texture.
+/// Rasterizing uses a FreeType library of its own and no GL calls, so it may run on a worker thread;
+/// Only `upload()` must run on the thread that owns the GL context.
+///
+/// An atlas may hold signed distance fields instead, as expected by `character_sdf.fs.glsl`.
+/// Each texel then stores the distance to the outline, 0.5 on it and more inside, so the glyphs of a font
+/// are generated once at `DISTANCE_FIELD_PIXEL_SIZE` and scaled to any size with sharp edges.
+/// The metrics are those at `DISTANCE_FIELD_PIXEL_SIZE` and include the spread around each glyph.
+class GlyphAtlas
+{
+public:
+    /// The number of entries in the metrics table, one per ASCII character
+    static constexpr uint32_t NUM_CHARS = 128;
+
+    /// The first printable character
+    static constexpr char FIRST_PRINTABLE_CHAR = ' ';
+
+    /// The last printable character
+    static constexpr char LAST_PRINTABLE_CHAR = '~';
+
+    /// The number of empty pixels around each glyph so that filtering does not bleed
+    static constexpr uint32_t PADDING = 1;
+
+    /// The height of the characters in a distance field in texels
+    static constexpr uint32_t DISTANCE_FIELD_PIXEL_SIZE = 48;
+
+    /// The distance in texels from the outline at which a distance field saturates
+    static constexpr uint32_t DISTANCE_FIELD_SPREAD = 4;
+
+    /// The number of pixels per texel along each axis when thresholding the outlines of a distance field; Must be even.
+    static constexpr uint32_t DISTANCE_FIELD_UPSAMPLE = 4;
+
+    /// The metrics and the place of a glyph
+    struct Glyph
+    {
+        /// The rectangle in texture coordinates, the origin in `xy` and the size in `zw`
+        vec4 uv;
+
+        /// The size of the bitmap in pixels
+        uint16_t width, height;
+
+        /// The offset from the pen position to the top left of the bitmap
+        int16_t bearingX, bearingY;
+
+        /// The distance to the next pen position in 1/64 pixels, as `FT_GlyphSlot::advance.x`
+        uint32_t advance;
+    };
+
+    ///
+    /// Rasterize and pack the printable characters
+    ///
+    /// @param path The path to the font file
+    /// @param pixelSize The height of the characters in pixels
+    /// @return `true` on success, `false` otherwise.
+    /// @note This method makes no GL calls and is safe to call on a worker thread.
+    ///
+    bool rasterize(const char* path, uint32_t pixelSize);
+
+    ///
+    /// Generate and pack the signed distance fields of the printable characters
+    ///
+    /// @param path The path to the font file
+    /// @return `true` on success, `false` otherwise.
+    /// @note This method makes no GL calls and is safe to call on a worker thread.
+    ///
+    bool rasterizeDistanceField(const char* path);
+
+    ///
+    /// Upload the packed glyphs to a texture
+    ///
+    /// @return `true` on success, `false` if the glyphs have not been rasterized.
+    /// @note The pixels are released afterwards; Subsequent calls are silently ignored.
+    ///
+    bool upload();
+
+    ///
+    /// Release the texture
+    ///
+    void destroy();
+
+    ///
+    /// [FAST] Get the glyph of a character
+    ///
+    /// @note Characters that are not printable have an empty glyph.
+    ///
+    inline const Glyph& getGlyph(char character) const
+    {
+        return this->glyphs[static_cast<uint8_t>(character) % NUM_CHARS];
+    }
+
+    ///
+    /// [FAST] Get the texture; 0 until the glyphs are uploaded
+    ///
+    inline GLuint getTexture() const
+    {
+        return this->texture;
+    }
+
+    ///
+    /// [FAST] Get the height of the characters in pixels
+    ///
+    inline uint32_t getPixelSize() const
+    {
+        return this->pixelSize;
+    }
+
+    ///
+    /// [FAST] Check whether the atlas holds distance fields rather than coverage
+    ///
+    inline bool isDistanceField() const
+    {
+        return this->distanceField;
+    }
+
+    ///
+    /// [FAST] Check whether the glyphs have been rasterized
+    ///
+    /// @note Once this returns `true`, the glyphs may be read on any thread.
+    ///
+    inline bool isRasterized() const
+    {
+        return this->rasterized.load(std::memory_order_acquire);
+    }
+
+private:
+    /// The metrics table indexed by the character
+    Glyph glyphs[NUM_CHARS] = {};
+
+    /// The coverage of the packed glyphs; Released by `upload()`
+    std::vector<uint8_t> pixels;
+
+    /// The size of the texture
+    uint32_t width = 0, height = 0;
+
+    /// The height of the characters in pixels
+    uint32_t pixelSize = 0;
+
+    /// Indicates whether the pixels are distance fields
+    bool distanceField = false;
+
+    /// The texture
+    GLuint texture = 0;
+
+    /// Set once the glyphs and the pixels are complete
+    std::atomic<bool> rasterized{false};
+
+    ///
+    /// [Private Helper] Pack the images of the printable characters and publish the atlas
+    ///
+    /// @param images The image of each printable character, sized as its glyph
+    /// @param pixelSize The height of the characters in pixels
+    ///
+    void pack(const std::vector<std::vector<uint8_t>>& images, uint32_t pixelSize);
+};
+
+#endif /* GlyphAtlas_hpp */
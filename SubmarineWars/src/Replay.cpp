@@ -0,0 +1,363 @@
+//
+//  Replay.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-05.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "Replay.hpp"
+
+/// Private instance
+Replay* Replay::instance = nullptr;
+
+/// Get the shared instance
+Replay* Replay::shared()
+{
+    if (Replay::instance == nullptr)
+    {
+        Replay::instance = new Replay();
+    }
+
+    return Replay::instance;
+}
+
+///
+/// Start recording to the given file
+///
+/// @param path The replay file path
+/// @return `true` on success, `false` otherwise.
+/// @note The file is overwritten.
+///
+bool Replay::startRecording(const char* path)
+{
+    this->stop();
+
+    this->file = fopen(path, "wb");
+
+    if (this->file == nullptr)
+    {
+        pserror("Failed to create the replay file %s.", path);
+
+        return false;
+    }
+
+    uint32_t header[] = {Replay::MAGIC, Replay::VERSION};
+
+    this->write(header, sizeof(header));
+
+    this->mode = Mode::Recording;
+
+    this->numFrames = 0;
+
+    pinfo("Started recording the replay to %s.", path);
+
+    return true;
+}
+
+///
+/// Start playing back the given file
+///
+/// @param path The replay file path
+/// @return `true` on success, `false` otherwise.
+///
+bool Replay::startPlaying(const char* path)
+{
+    this->stop();
+
+    this->file = fopen(path, "rb");
+
+    if (this->file == nullptr)
+    {
+        pserror("Failed to open the replay file %s.", path);
+
+        return false;
+    }
+
+    uint32_t header[2] = {};
+
+    if (!this->read(header, sizeof(header)) || header[0] != Replay::MAGIC || header[1] != Replay::VERSION)
+    {
+        pserror("The replay file %s is invalid or was recorded by an incompatible version.", path);
+
+        fclose(this->file);
+
+        this->file = nullptr;
+
+        return false;
+    }
+
+    this->mode = Mode::Playing;
+
+    this->numFrames = 0;
+
+    pinfo("Started playing back the replay %s.", path);
+
+    return true;
+}
+
+///
+/// Stop recording or playing back
+///
+void Replay::stop()
+{
+    if (this->file == nullptr)
+    {
+        return;
+    }
+
+    fclose(this->file);
+
+    this->file = nullptr;
+
+    pinfo("Stopped the replay after %llu frames.", (unsigned long long) this->numFrames);
+
+    this->mode = Mode::Idle;
+}
+
+///
+/// Record a key event
+///
+/// @param key The keyboard key that was pressed or released
+/// @param scancode The system-specific scancode of the key
+/// @param action One of key action `GLFW_PRESS`, `GLFW_RELEASE` or `GLFW_REPEAT`
+/// @param mods Bit field describing which modifier keys were held down
+/// @note This method does nothing if the replay is not recording.
+///
+void Replay::recordKeyEvent(int key, int scancode, int action, int mods)
+{
+    if (!this->isRecording())
+    {
+        return;
+    }
+
+    uint8_t tag = Tag::kKey;
+
+    int16_t key16 = (int16_t) key;
+
+    int32_t scancode32 = scancode;
+
+    uint8_t bytes[] = {(uint8_t) action, (uint8_t) mods};
+
+    this->write(&tag, sizeof(tag));
+
+    this->write(&key16, sizeof(key16));
+
+    this->write(&scancode32, sizeof(scancode32));
+
+    this->write(bytes, sizeof(bytes));
+}
+
+///
+/// Record a mouse move event
+///
+/// @param xpos The new cursor x-coordinate
+/// @param ypos The new cursor y-coordinate
+/// @note This method does nothing if the replay is not recording.
+///
+void Replay::recordMouseMoveEvent(double xpos, double ypos)
+{
+    if (!this->isRecording())
+    {
+        return;
+    }
+
+    uint8_t tag = Tag::kMouseMove;
+
+    double position[] = {xpos, ypos};
+
+    this->write(&tag, sizeof(tag));
+
+    this->write(position, sizeof(position));
+}
+
+///
+/// Record a mouse button event
+///
+/// @param button The mouse button that was pressed or released.
+/// @param action One of button action `GLFW_PRESS` or `GLFW_RELEASE`
+/// @param mods Bit field describing which modifier keys were held down
+/// @note This method does nothing if the replay is not recording.
+///
+void Replay::recordMouseButtonEvent(int button, int action, int mods)
+{
+    if (!this->isRecording())
+    {
+        return;
+    }
+
+    uint8_t bytes[] = {Tag::kMouseButton, (uint8_t) button, (uint8_t) action, (uint8_t) mods};
+
+    this->write(bytes, sizeof(bytes));
+}
+
+///
+/// Advance to the next frame
+///
+/// @param ms The elapsed time of the frame measured by the caller; replaced by the recorded one on playback
+/// @param delegate The delegate to receive the input events of the frame on playback
+/// @return `false` if the playback has reached the end of the file or desynchronized, `true` otherwise.
+/// @note On playback, input events recorded before the frame are dispatched to the delegate before this method returns.
+/// @note Once the playback has finished or desynchronized, this method keeps returning `false`.
+///
+bool Replay::advanceFrame(float& ms, ReplayDelegate* delegate)
+{
+    if (this->mode == Mode::Recording)
+    {
+        uint8_t tag = Tag::kFrame;
+
+        this->write(&tag, sizeof(tag));
+
+        this->write(&ms, sizeof(ms));
+
+        this->numFrames++;
+
+        return true;
+    }
+
+    // Guard: A finished or desynchronized playback stays over
+    if (this->mode == Mode::Finished || this->mode == Mode::Desynchronized)
+    {
+        return false;
+    }
+
+    if (this->mode != Mode::Playing)
+    {
+        return true;
+    }
+
+    // Dispatch input events until the frame record
+    uint8_t tag;
+
+    while (this->read(&tag, sizeof(tag)))
+    {
+        switch (tag)
+        {
+            case Tag::kFrame:
+            {
+                if (!this->read(&ms, sizeof(ms)))
+                {
+                    break;
+                }
+
+                this->numFrames++;
+
+                return true;
+            }
+
+            case Tag::kKey:
+            {
+                int16_t key;
+
+                int32_t scancode;
+
+                uint8_t bytes[2];
+
+                if (!this->read(&key, sizeof(key)) || !this->read(&scancode, sizeof(scancode)) || !this->read(bytes, sizeof(bytes)))
+                {
+                    break;
+                }
+
+                delegate->replayDidPlayKeyEvent(key, scancode, bytes[0], bytes[1]);
+
+                continue;
+            }
+
+            case Tag::kMouseMove:
+            {
+                double position[2];
+
+                if (!this->read(position, sizeof(position)))
+                {
+                    break;
+                }
+
+                delegate->replayDidPlayMouseMoveEvent(position[0], position[1]);
+
+                continue;
+            }
+
+            case Tag::kMouseButton:
+            {
+                uint8_t bytes[3];
+
+                if (!this->read(bytes, sizeof(bytes)))
+                {
+                    break;
+                }
+
+                delegate->replayDidPlayMouseButtonEvent(bytes[0], bytes[1], bytes[2]);
+
+                continue;
+            }
+
+            default:
+                this->desynchronize("Found an unexpected record between frames.");
+
+                return false;
+        }
+
+        break;
+    }
+
+    // Guard: Distinguish an I/O error from the end of the replay
+    // A truncated last record is treated as the end, since the recording session may have crashed
+    if (ferror(this->file))
+    {
+        this->desynchronize("Failed to read the next record.");
+
+        return false;
+    }
+
+    pinfo("Finished playing back the replay.");
+
+    this->stop();
+
+    this->mode = Mode::Finished;
+
+    return false;
+}
+
+///
+/// [Private Helper] Write a random number record
+///
+void Replay::writeRandom(uint32_t bits)
+{
+    uint8_t tag = Tag::kRandom;
+
+    this->write(&tag, sizeof(tag));
+
+    this->write(&bits, sizeof(bits));
+}
+
+///
+/// [Private Helper] Read a random number record
+///
+/// @param bits Set to the raw bits of the recorded number on return
+/// @return `true` on success, `false` if the playback has desynchronized.
+///
+bool Replay::readRandom(uint32_t& bits)
+{
+    uint8_t tag;
+
+    if (!this->read(&tag, sizeof(tag)) || tag != Tag::kRandom || !this->read(&bits, sizeof(bits)))
+    {
+        this->desynchronize("The game drew a random number that was not recorded.");
+
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// [Private Helper] Report a corrupted or mismatched replay and stop the playback for good
+///
+void Replay::desynchronize(const char* reason)
+{
+    pserror("The replay has desynchronized at frame %llu: %s", (unsigned long long) this->numFrames, reason);
+
+    this->stop();
+
+    this->mode = Mode::Desynchronized;
+}
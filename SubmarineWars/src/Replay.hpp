@@ -0,0 +1,258 @@
+//
+//  Replay.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-05.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef Replay_hpp
+#define Replay_hpp
+
+#include "Foundations/Foundations.hpp"
+#include "ReplayDelegate.hpp"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+/// A singleton that records user input events, random numbers and frame times to a compact replay file
+/// and plays them back so that a session can be reproduced bit-exactly
+///
+/// The replay file starts with a header followed by a stream of records in the order they occur:
+/// input events of a frame, the frame record with its elapsed time, then random numbers drawn during the frame.
+class Replay
+{
+public:
+    /// Operating modes
+    enum class Mode
+    {
+        /// Neither recording nor playing
+        Idle,
+
+        /// Recording a session
+        Recording,
+
+        /// Playing back a session
+        Playing,
+
+        /// The playback has reached the end of the file
+        Finished,
+
+        /// The playback has stopped at a corrupted or mismatched record
+        Desynchronized
+    };
+
+    /// Get the shared instance
+    static Replay* shared();
+
+    ///
+    /// [FAST] Get the current mode
+    ///
+    inline Mode getMode() const
+    {
+        return this->mode;
+    }
+
+    ///
+    /// [FAST] Check whether the replay is recording
+    ///
+    inline bool isRecording() const
+    {
+        return this->mode == Mode::Recording;
+    }
+
+    ///
+    /// [FAST] Check whether the replay is playing back
+    ///
+    inline bool isPlaying() const
+    {
+        return this->mode == Mode::Playing;
+    }
+
+    ///
+    /// [FAST] Check whether the playback has stopped at a corrupted or mismatched record
+    ///
+    inline bool isDesynchronized() const
+    {
+        return this->mode == Mode::Desynchronized;
+    }
+
+    ///
+    /// Start recording to the given file
+    ///
+    /// @param path The replay file path
+    /// @return `true` on success, `false` otherwise.
+    /// @note The file is overwritten.
+    ///
+    bool startRecording(const char* path);
+
+    ///
+    /// Start playing back the given file
+    ///
+    /// @param path The replay file path
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool startPlaying(const char* path);
+
+    ///
+    /// Stop recording or playing back
+    ///
+    void stop();
+
+    ///
+    /// Record a key event
+    ///
+    /// @param key The keyboard key that was pressed or released
+    /// @param scancode The system-specific scancode of the key
+    /// @param action One of key action `GLFW_PRESS`, `GLFW_RELEASE` or `GLFW_REPEAT`
+    /// @param mods Bit field describing which modifier keys were held down
+    /// @note This method does nothing if the replay is not recording.
+    ///
+    void recordKeyEvent(int key, int scancode, int action, int mods);
+
+    ///
+    /// Record a mouse move event
+    ///
+    /// @param xpos The new cursor x-coordinate
+    /// @param ypos The new cursor y-coordinate
+    /// @note This method does nothing if the replay is not recording.
+    ///
+    void recordMouseMoveEvent(double xpos, double ypos);
+
+    ///
+    /// Record a mouse button event
+    ///
+    /// @param button The mouse button that was pressed or released.
+    /// @param action One of button action `GLFW_PRESS` or `GLFW_RELEASE`
+    /// @param mods Bit field describing which modifier keys were held down
+    /// @note This method does nothing if the replay is not recording.
+    ///
+    void recordMouseButtonEvent(int button, int action, int mods);
+
+    ///
+    /// Advance to the next frame
+    ///
+    /// @param ms The elapsed time of the frame measured by the caller; replaced by the recorded one on playback
+    /// @param delegate The delegate to receive the input events of the frame on playback
+    /// @return `false` if the playback has reached the end of the file or desynchronized, `true` otherwise.
+    /// @note On playback, input events recorded before the frame are dispatched to the delegate before this method returns.
+    /// @note Once the playback has finished or desynchronized, this method keeps returning `false`.
+    ///
+    bool advanceFrame(float& ms, ReplayDelegate* delegate);
+
+    ///
+    /// Draw a random number from the given generator
+    ///
+    /// @param generator A random number generator
+    /// @return The generated number on recording, the recorded number on playback.
+    /// @note Recording the numbers themselves rather than the generator seeds keeps the replay exact
+    ///       regardless of the generator implementation and the standard library in use.
+    ///
+    template <typename T>
+    T generate(Random<T>& generator)
+    {
+        static_assert(sizeof(T) == sizeof(uint32_t), "Only 32-bit random numbers are supported.");
+
+        uint32_t bits;
+
+        // Fall back to the generator if the playback has desynchronized
+        if (this->mode == Mode::Playing && this->readRandom(bits))
+        {
+            T value;
+
+            memcpy(&value, &bits, sizeof(T));
+
+            return value;
+        }
+
+        T value = generator.generate();
+
+        if (this->mode == Mode::Recording)
+        {
+            memcpy(&bits, &value, sizeof(T));
+
+            this->writeRandom(bits);
+        }
+
+        return value;
+    }
+
+private:
+    /// Record tags
+    enum Tag : uint8_t
+    {
+        /// A frame with its elapsed time
+        kFrame = 'F',
+
+        /// A key event
+        kKey = 'K',
+
+        /// A mouse move event
+        kMouseMove = 'M',
+
+        /// A mouse button event
+        kMouseButton = 'B',
+
+        /// A random number
+        kRandom = 'R'
+    };
+
+    /// The replay file magic
+    static constexpr uint32_t MAGIC = 0x50525753; // "SWRP"
+
+    /// The replay file version
+    static constexpr uint32_t VERSION = 1;
+
+    /// Private instance
+    static Replay* instance;
+
+    /// The current mode
+    Mode mode = Mode::Idle;
+
+    /// The replay file
+    FILE* file = nullptr;
+
+    /// The number of frames recorded or played back so far
+    uint64_t numFrames = 0;
+
+    ///
+    /// [Private Helper] Write a random number record
+    ///
+    void writeRandom(uint32_t bits);
+
+    ///
+    /// [Private Helper] Read a random number record
+    ///
+    /// @param bits Set to the raw bits of the recorded number on return
+    /// @return `true` on success, `false` if the playback has desynchronized.
+    ///
+    bool readRandom(uint32_t& bits);
+
+    ///
+    /// [Private Helper] Write raw bytes to the replay file
+    ///
+    inline void write(const void* bytes, size_t length)
+    {
+        fwrite(bytes, 1, length, this->file);
+    }
+
+    ///
+    /// [Private Helper] Read raw bytes from the replay file
+    ///
+    /// @return `true` on success, `false` if the end of file has been reached.
+    ///
+    inline bool read(void* bytes, size_t length)
+    {
+        return fread(bytes, 1, length, this->file) == length;
+    }
+
+    ///
+    /// [Private Helper] Report a corrupted or mismatched replay and stop the playback for good
+    ///
+    void desynchronize(const char* reason);
+
+    /// Private constructor
+    Replay() {}
+};
+
+#endif /* Replay_hpp */
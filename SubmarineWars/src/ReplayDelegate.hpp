@@ -0,0 +1,48 @@
+//
+//  ReplayDelegate.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-05.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef ReplayDelegate_hpp
+#define ReplayDelegate_hpp
+
+/// A set of methods implemented by the input handler to receive
+/// the user input events played back from a replay file
+class ReplayDelegate
+{
+public:
+    /// Virtual destructor
+    virtual ~ReplayDelegate() {}
+
+    ///
+    /// Called when the replay plays back a key event
+    ///
+    /// @param key The keyboard key that was pressed or released
+    /// @param scancode The system-specific scancode of the key
+    /// @param action One of key action `GLFW_PRESS`, `GLFW_RELEASE` or `GLFW_REPEAT`
+    /// @param mods Bit field describing which modifier keys were held down
+    ///
+    virtual void replayDidPlayKeyEvent(int key, int scancode, int action, int mods) = 0;
+
+    ///
+    /// Called when the replay plays back a mouse move event
+    ///
+    /// @param xpos The new cursor x-coordinate, relative to the left edge of the content area
+    /// @param ypos The new cursor y-coordinate, relative to the top edge of the content area
+    ///
+    virtual void replayDidPlayMouseMoveEvent(double xpos, double ypos) = 0;
+
+    ///
+    /// Called when the replay plays back a mouse button event
+    ///
+    /// @param button The mouse button that was pressed or released.
+    /// @param action One of button action `GLFW_PRESS` or `GLFW_RELEASE`
+    /// @param mods Bit field describing which modifier keys were held down
+    ///
+    virtual void replayDidPlayMouseButtonEvent(int button, int action, int mods) = 0;
+};
+
+#endif /* ReplayDelegate_hpp */
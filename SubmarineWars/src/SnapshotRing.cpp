@@ -0,0 +1,206 @@
+//
+//  SnapshotRing.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-09.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "SnapshotRing.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+#include <new>
+
+///
+/// Allocate the ring
+///
+/// @param duration The play time covered by the ring in milliseconds; 0 to release the ring
+/// @param interval The interval between two snapshots in milliseconds
+/// @return `true` on success, `false` if the ring could not be allocated.
+///
+bool SnapshotRing::configure(float duration, float interval)
+{
+    this->snapshots.reset();
+
+    this->capacity = 0;
+
+    this->interval = interval;
+
+    this->clear();
+
+    if (duration <= 0 || interval <= 0)
+    {
+        return true;
+    }
+
+    // One more snapshot so that the oldest one is still `duration` old after a new one is taken
+    uint32_t capacity = (uint32_t) (duration / interval) + 1;
+
+    this->snapshots.reset(new (std::nothrow) Snapshot[capacity]);
+
+    if (this->snapshots == nullptr)
+    {
+        pserror("Failed to allocate %u snapshots (%zu KB each).", capacity, sizeof(Snapshot) / 1024);
+
+        return false;
+    }
+
+    this->capacity = capacity;
+
+    pinfo("Allocated %u snapshots (%zu KB each) to rewind up to %.1f seconds.", capacity, sizeof(Snapshot) / 1024, duration / 1000);
+
+    return true;
+}
+
+///
+/// Take a snapshot if it is due
+///
+/// @param ms The elapsed time since the last update
+/// @param entityManager The entity manager to capture
+/// @param stageController The stage controller to capture
+/// @note Only normal stages are captured, and the play time does not advance elsewhere.
+///
+void SnapshotRing::update(float ms, EntityManager* entityManager, StageController* stageController)
+{
+    // Guard: The ring must be allocated and the current state must be capturable
+    if (!this->isEnabled() || !stageController->canTakeSnapshot())
+    {
+        return;
+    }
+
+    this->time += ms;
+
+    this->sinceCapture += ms;
+
+    // The first snapshot is taken right away
+    if (this->count > 0 && this->sinceCapture < this->interval)
+    {
+        return;
+    }
+
+    SW_TRACE_SCOPE("SnapshotRing::capture", "snapshot");
+
+    this->sinceCapture = 0;
+
+    Snapshot& snapshot = this->snapshots[this->head];
+
+    SnapshotRing::capture(&snapshot, entityManager, stageController);
+
+    snapshot.time = this->time;
+
+    this->head = (this->head + 1) % this->capacity;
+
+    this->count = std::min(this->count + 1, this->capacity);
+}
+
+///
+/// Rewind the play time
+///
+/// @param ms The play time to rewind in milliseconds
+/// @param entityManager The entity manager to restore
+/// @param stageController The stage controller to restore
+/// @return `true` on success, `false` if the ring is empty or the snapshot could not be restored.
+/// @note The newest snapshot at least `ms` old, or the oldest one if none is old enough, is restored,
+///       and all snapshots after it are discarded.
+///
+bool SnapshotRing::rewind(float ms, EntityManager* entityManager, StageController* stageController)
+{
+    // Guard: There must be something to rewind to
+    if (this->count == 0)
+    {
+        return false;
+    }
+
+    double target = this->time - ms;
+
+    // Walk from the newest snapshot to the oldest one
+    uint32_t age = 0;
+
+    while (age + 1 < this->count && this->snapshots[(this->head + this->capacity - 1 - age) % this->capacity].time > target)
+    {
+        age++;
+    }
+
+    uint32_t index = (this->head + this->capacity - 1 - age) % this->capacity;
+
+    const Snapshot& snapshot = this->snapshots[index];
+
+    if (!SnapshotRing::restore(snapshot, entityManager, stageController))
+    {
+        return false;
+    }
+
+    // The restored snapshot becomes the newest one
+    this->head = (index + 1) % this->capacity;
+
+    this->count -= age;
+
+    this->time = snapshot.time;
+
+    this->sinceCapture = 0;
+
+    pinfo("Rewound to %.2f seconds of play time.", this->time / 1000);
+
+    return true;
+}
+
+///
+/// Discard all snapshots
+///
+void SnapshotRing::clear()
+{
+    this->head = 0;
+
+    this->count = 0;
+
+    this->sinceCapture = 0;
+
+    this->time = 0;
+}
+
+///
+/// Capture the world into a snapshot
+///
+/// @param snapshot The snapshot to overwrite
+/// @param entityManager The entity manager to capture
+/// @param stageController The stage controller to capture
+///
+void SnapshotRing::capture(Snapshot* snapshot, EntityManager* entityManager, StageController* stageController)
+{
+    stageController->takeSnapshot(&snapshot->stage);
+
+    entityManager->takeSnapshot(&snapshot->entities);
+}
+
+///
+/// Restore the world from a snapshot
+///
+/// @param snapshot A snapshot taken by `capture()`
+/// @param entityManager The entity manager to restore
+/// @param stageController The stage controller to restore
+/// @return `true` on success, `false` otherwise.
+///
+bool SnapshotRing::restore(const Snapshot& snapshot, EntityManager* entityManager, StageController* stageController)
+{
+    if (!stageController->restoreSnapshot(snapshot.stage))
+    {
+        pserror("Failed to restore the stage progress from the snapshot.");
+
+        return false;
+    }
+
+    if (!entityManager->restoreSnapshot(snapshot.entities))
+    {
+        pserror("Failed to restore the entities from the snapshot.");
+
+        return false;
+    }
+
+    entityManager->updateStageLabel(snapshot.stage.progress.stage);
+
+    entityManager->updateMoneyLabel(snapshot.stage.progress.money);
+
+    entityManager->updateScoreLabel(snapshot.stage.progress.score);
+
+    return true;
+}
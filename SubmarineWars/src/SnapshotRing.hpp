@@ -0,0 +1,126 @@
+//
+//  SnapshotRing.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-09.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef SnapshotRing_hpp
+#define SnapshotRing_hpp
+
+#include "EntityManager.hpp"
+#include "StageController.hpp"
+#include <memory>
+
+/// A ring of in-memory snapshots of the last few seconds of play, taken at a fixed interval
+///
+/// All snapshots are allocated up front, so taking one is a plain copy of the component arrays.
+/// Restoring a snapshot is linear in the number of identifiers, which allows instant rewinds while debugging,
+/// and `capture()` and `restore()` can be used on their own to clone the state, e.g. for search-based bots.
+class SnapshotRing
+{
+public:
+    /// A snapshot of the world
+    struct Snapshot
+    {
+        /// The play time at which the snapshot was taken in milliseconds
+        double time;
+
+        /// The stage progress
+        StageController::SC_Snapshot stage;
+
+        /// The gameplay entities
+        EntityManager::EM_Snapshot entities;
+    };
+
+    /// The default interval between two snapshots in milliseconds
+    static constexpr float DEF_INTERVAL = 250.f;
+
+    ///
+    /// Allocate the ring
+    ///
+    /// @param duration The play time covered by the ring in milliseconds; 0 to release the ring
+    /// @param interval The interval between two snapshots in milliseconds
+    /// @return `true` on success, `false` if the ring could not be allocated.
+    ///
+    bool configure(float duration, float interval = SnapshotRing::DEF_INTERVAL);
+
+    ///
+    /// [FAST] Check whether the ring has been allocated
+    ///
+    inline bool isEnabled() const
+    {
+        return this->capacity > 0;
+    }
+
+    ///
+    /// Take a snapshot if it is due
+    ///
+    /// @param ms The elapsed time since the last update
+    /// @param entityManager The entity manager to capture
+    /// @param stageController The stage controller to capture
+    /// @note Only normal stages are captured, and the play time does not advance elsewhere.
+    ///
+    void update(float ms, EntityManager* entityManager, StageController* stageController);
+
+    ///
+    /// Rewind the play time
+    ///
+    /// @param ms The play time to rewind in milliseconds
+    /// @param entityManager The entity manager to restore
+    /// @param stageController The stage controller to restore
+    /// @return `true` on success, `false` if the ring is empty or the snapshot could not be restored.
+    /// @note The newest snapshot at least `ms` old, or the oldest one if none is old enough, is restored,
+    ///       and all snapshots after it are discarded.
+    ///
+    bool rewind(float ms, EntityManager* entityManager, StageController* stageController);
+
+    ///
+    /// Discard all snapshots
+    ///
+    void clear();
+
+    ///
+    /// Capture the world into a snapshot
+    ///
+    /// @param snapshot The snapshot to overwrite
+    /// @param entityManager The entity manager to capture
+    /// @param stageController The stage controller to capture
+    ///
+    static void capture(Snapshot* snapshot, EntityManager* entityManager, StageController* stageController);
+
+    ///
+    /// Restore the world from a snapshot
+    ///
+    /// @param snapshot A snapshot taken by `capture()`
+    /// @param entityManager The entity manager to restore
+    /// @param stageController The stage controller to restore
+    /// @return `true` on success, `false` otherwise.
+    ///
+    static bool restore(const Snapshot& snapshot, EntityManager* entityManager, StageController* stageController);
+
+private:
+    /// The storage of all snapshots
+    std::unique_ptr<Snapshot[]> snapshots;
+
+    /// The number of snapshots in the storage
+    uint32_t capacity = 0;
+
+    /// The index of the next snapshot to overwrite
+    uint32_t head = 0;
+
+    /// The number of snapshots taken
+    uint32_t count = 0;
+
+    /// The interval between two snapshots in milliseconds
+    float interval = SnapshotRing::DEF_INTERVAL;
+
+    /// Time since the last snapshot
+    float sinceCapture = 0;
+
+    /// The play time in milliseconds
+    double time = 0;
+};
+
+#endif /* SnapshotRing_hpp */
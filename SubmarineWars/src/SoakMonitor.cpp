@@ -0,0 +1,201 @@
+//
+//  SoakMonitor.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-07.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "SoakMonitor.hpp"
+#include "Foundations/FrameProfiler.hpp"
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+///
+/// Start monitoring
+///
+/// @param path The log file path; the file is overwritten
+/// @param duration The duration of the soak test in milliseconds of wall time
+/// @param interval The interval between two log entries in milliseconds of wall time
+/// @return `true` on success, `false` otherwise.
+/// @note Frame time percentiles are only logged if the frame profiler is enabled.
+///
+bool SoakMonitor::start(const char* path, float duration, float interval)
+{
+    this->file = fopen(path, "w");
+
+    if (this->file == nullptr)
+    {
+        pserror("Failed to create the soak test log %s.", path);
+
+        return false;
+    }
+
+    fprintf(this->file, "elapsed_s,frames,loops,stage,live,submarines,fishes,bombs,torpedoes,missiles,boat_missiles,explosions,smokes,characters,"
+                        "failed_spawns,rss_kb,frame_p50_ms,frame_p95_ms,frame_p99_ms,frame_max_ms\n");
+
+    this->startTime = Clock::now();
+
+    this->duration = duration;
+
+    this->interval = interval;
+
+    pinfo("Started a soak test of %.0f minutes. Logging to %s.", duration / 60000, path);
+
+    return true;
+}
+
+///
+/// Called when a frame has finished
+///
+/// @param entityManager The entity manager under test
+/// @param stageController The stage controller under test
+///
+void SoakMonitor::frameDidEnd(EntityManager* entityManager, StageController* stageController)
+{
+    if (this->file == nullptr)
+    {
+        return;
+    }
+
+    this->numFrames++;
+
+    // A loop starts when the first stage is entered
+    int stage = stageController->getCurrentStageNumber();
+
+    if (stage < this->lastStageNumber || (this->lastStageNumber < 0 && stage >= 0))
+    {
+        this->loopDidStart(entityManager);
+    }
+
+    this->lastStageNumber = stage;
+
+    float now = this->elapsed();
+
+    if (now - this->lastLogTime >= this->interval)
+    {
+        this->lastLogTime = now;
+
+        this->log(entityManager, stageController);
+    }
+}
+
+///
+/// Write the summary and close the log file
+///
+void SoakMonitor::stop()
+{
+    if (this->file == nullptr)
+    {
+        return;
+    }
+
+    fclose(this->file);
+
+    this->file = nullptr;
+
+    uint64_t rss = SoakMonitor::getResidentMemorySize();
+
+    float hours = this->elapsed() / 3600000;
+
+    pinfo("The soak test has finished after %llu frames and %u loops over all stages.", (unsigned long long) this->numFrames, this->numLoops);
+
+    pinfo("Resident memory: %llu KB at the first loop, %llu KB now (%+.0f KB per hour).",
+          (unsigned long long) this->baselineResidentMemory, (unsigned long long) rss,
+          hours > 0 ? ((double) rss - (double) this->baselineResidentMemory) / hours : 0.0);
+}
+
+///
+/// Get the resident memory size of the process
+///
+/// @return The resident memory size in kilobytes; 0 if not supported on the current platform.
+///
+uint64_t SoakMonitor::getResidentMemorySize()
+{
+#if defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+    {
+        return 0;
+    }
+
+    return info.resident_size / 1024;
+#elif defined(__linux__)
+    // The second field of statm is the resident set size in pages
+    FILE* statm = fopen("/proc/self/statm", "r");
+
+    if (statm == nullptr)
+    {
+        return 0;
+    }
+
+    unsigned long long pages = 0;
+
+    int matched = fscanf(statm, "%*s %llu", &pages);
+
+    fclose(statm);
+
+    return matched == 1 ? pages * sysconf(_SC_PAGESIZE) / 1024 : 0;
+#else
+    return 0;
+#endif
+}
+
+///
+/// [Private Helper] Write a log entry
+///
+void SoakMonitor::log(EntityManager* entityManager, StageController* stageController)
+{
+    auto counts = entityManager->getEntityCounts();
+
+    auto frame = FrameProfiler::shared()->getStatistics(ProfileSection::Frame);
+
+    fprintf(this->file, "%.1f,%llu,%u,%d,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%.4f,%.4f,%.4f,%.4f\n",
+            this->lastLogTime / 1000, (unsigned long long) this->numFrames, this->numLoops, stageController->getCurrentStageNumber(),
+            counts.live, counts.submarines, counts.fishes, counts.bombs, counts.torpedoes, counts.missiles, counts.boatMissiles,
+            counts.explosions, counts.smokes, counts.characters, stageController->getNumFailedSpawns(),
+            (unsigned long long) SoakMonitor::getResidentMemorySize(), frame.p50, frame.p95, frame.p99, frame.max);
+
+    // Keep the log usable if the soak test crashes
+    fflush(this->file);
+}
+
+///
+/// [Private Helper] Called when the soak test starts another loop over all stages
+///
+void SoakMonitor::loopDidStart(EntityManager* entityManager)
+{
+    uint32_t live = entityManager->getEntityCounts().live;
+
+    if (this->lastStageNumber < 0)
+    {
+        // The first loop sets the baseline
+        this->baselineLiveEntities = live;
+
+        this->baselineResidentMemory = SoakMonitor::getResidentMemorySize();
+    }
+    else
+    {
+        this->numLoops++;
+
+        // Entities left over from the previous stage may vary a little, but they should not keep accumulating
+        this->numGrowingLoops = live > this->lastLoopLiveEntities ? this->numGrowingLoops + 1 : 0;
+
+        pinfo("Soak loop #%u started with %u live entities (baseline %u).", this->numLoops, live, this->baselineLiveEntities);
+
+        if (this->numGrowingLoops >= 3)
+        {
+            pwarning("Live entities have grown for %u loops in a row (%u -> %u). Some entities might never be removed.",
+                     this->numGrowingLoops, this->baselineLiveEntities, live);
+        }
+    }
+
+    this->lastLoopLiveEntities = live;
+}
@@ -0,0 +1,128 @@
+//
+//  SoakMonitor.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-07.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef SoakMonitor_hpp
+#define SoakMonitor_hpp
+
+#include "EntityManager.hpp"
+#include "StageController.hpp"
+#include <chrono>
+#include <stdio.h>
+
+/// Monitors a long-running soak test and periodically logs frame time percentiles, entity counts and memory usage
+///
+/// The monitor also compares the live entities and the resident memory at the start of every loop over all stages,
+/// since both should return to the same level once a loop has been cleared; a steady growth indicates a leak.
+class SoakMonitor
+{
+public:
+    /// The default interval between two log entries in milliseconds
+    static constexpr float DEF_LOG_INTERVAL = 10000.f;
+
+    /// The default log file path
+    static constexpr const char* DEF_LOG_PATH = "SubmarineWars.soak.csv";
+
+    ///
+    /// Start monitoring
+    ///
+    /// @param path The log file path; the file is overwritten
+    /// @param duration The duration of the soak test in milliseconds of wall time
+    /// @param interval The interval between two log entries in milliseconds of wall time
+    /// @return `true` on success, `false` otherwise.
+    /// @note Frame time percentiles are only logged if the frame profiler is enabled.
+    ///
+    bool start(const char* path, float duration, float interval = SoakMonitor::DEF_LOG_INTERVAL);
+
+    ///
+    /// Called when a frame has finished
+    ///
+    /// @param entityManager The entity manager under test
+    /// @param stageController The stage controller under test
+    ///
+    void frameDidEnd(EntityManager* entityManager, StageController* stageController);
+
+    ///
+    /// [FAST] Check whether the soak test has finished
+    ///
+    inline bool isFinished() const
+    {
+        return this->file != nullptr && this->elapsed() >= this->duration;
+    }
+
+    ///
+    /// Write the summary and close the log file
+    ///
+    void stop();
+
+    ///
+    /// Get the resident memory size of the process
+    ///
+    /// @return The resident memory size in kilobytes; 0 if not supported on the current platform.
+    ///
+    static uint64_t getResidentMemorySize();
+
+private:
+    /// The clock used to measure the wall time
+    using Clock = std::chrono::steady_clock;
+
+    /// The log file
+    FILE* file = nullptr;
+
+    /// The start time
+    Clock::time_point startTime;
+
+    /// The duration of the soak test in milliseconds
+    float duration = 0;
+
+    /// The interval between two log entries in milliseconds
+    float interval = 0;
+
+    /// The wall time of the last log entry in milliseconds
+    float lastLogTime = 0;
+
+    /// The number of frames so far
+    uint64_t numFrames = 0;
+
+    /// The number of completed loops over all stages
+    uint32_t numLoops = 0;
+
+    /// The stage number in the last frame
+    int lastStageNumber = -1;
+
+    /// The number of live entities at the start of the first loop
+    uint32_t baselineLiveEntities = 0;
+
+    /// The resident memory size at the start of the first loop in kilobytes
+    uint64_t baselineResidentMemory = 0;
+
+    /// The number of live entities at the start of the last loop
+    uint32_t lastLoopLiveEntities = 0;
+
+    /// The number of consecutive loops that ended with more live entities than they started with
+    uint32_t numGrowingLoops = 0;
+
+    ///
+    /// [Private Helper] Get the elapsed wall time in milliseconds
+    ///
+    inline float elapsed() const
+    {
+        return std::chrono::duration<float, std::milli>(Clock::now() - this->startTime).count();
+    }
+
+    ///
+    /// [Private Helper] Write a log entry
+    ///
+    void log(EntityManager* entityManager, StageController* stageController);
+
+    ///
+    /// [Private Helper] Called when the soak test starts another loop over all stages
+    ///
+    void loopDidStart(EntityManager* entityManager);
+};
+
+#endif /* SoakMonitor_hpp */
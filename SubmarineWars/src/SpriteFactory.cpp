@@ -8,6 +8,7 @@
 
 #include "SpriteFactory.hpp"
 #include "ProjectPath.hpp"
+#include <stb_image.h>
 
 /// Private instance
 SpriteFactory* SpriteFactory::instance = nullptr;
@@ -118,6 +119,173 @@ SpriteFactory::SpriteFactory()
     }
 }
 
+///
+/// [Private Helper] Build the collision mask from the alpha channel of an image file
+///
+/// @param mask The mask built on return
+/// @param path The path to the image file
+/// @return `true` on success, `false` otherwise.
+///
+bool SpriteFactory::loadCollisionMask(CollisionMask& mask, const char* path)
+{
+    int width = 0, height = 0, channels = 0;
+
+    // Always ask for 4 channels, so images without alpha are fully opaque
+    stbi_uc* pixels = stbi_load(path, &width, &height, &channels, 4);
+
+    // Guard: The image must be readable
+    if (pixels == nullptr)
+    {
+        pserror("Failed to load the image at %s: %s.", path, stbi_failure_reason());
+
+        return false;
+    }
+
+    bool result = mask.initFromAlpha(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+    stbi_image_free(pixels);
+
+    return result;
+}
+
+///
+/// Pack the textures of all entity types into atlases
+///
+/// @return `true` on success, `false` otherwise.
+/// @note Each file is read once however many times it is listed, and files with identical pixels share a region.
+///       The frames of each page are registered with the shared sprite batch, which must be set up first.
+/// @note The game does not load the atlas yet, because sprites are still drawn from the textures loaded by `make()`;
+///       Loading it as well would only add the pages to the texture memory.
+///
+bool SpriteFactory::loadAtlas()
+{
+    SW_TRACE_SCOPE("SpriteFactory::loadAtlas", "io");
+
+    // Guard: Load the atlas only once
+    if (this->atlas.isBuilt())
+    {
+        return true;
+    }
+
+    for (const auto& pair : SpriteFactory::texturePathsMap)
+    {
+        std::vector<uint32_t>& regions = this->atlasRegionsMap[pair.first];
+
+        regions.clear();
+
+        for (const char* path : pair.second)
+        {
+            int32_t region = this->atlas.add(path);
+
+            // Guard: Every texture must be loaded
+            if (region < 0)
+            {
+                pserror("Failed to add the texture at %s to the atlas.", path);
+
+                return false;
+            }
+
+            regions.push_back(static_cast<uint32_t>(region));
+        }
+    }
+
+    // Guard: Pack and upload the pages
+    if (!this->atlas.build())
+    {
+        pserror("Failed to build the texture atlas.");
+
+        return false;
+    }
+
+    for (uint32_t page = 0; page < this->atlas.getNumPages(); page++)
+    {
+        std::vector<vec4> frames = this->atlas.getFrames(page);
+
+        SpriteBatch::shared()->setFrames(this->atlas.getTexture(page), frames.data(), static_cast<uint32_t>(frames.size()));
+    }
+
+    auto statistics = this->atlas.getStatistics();
+
+    pinfo("The texture atlas packs %u unique images of %u into %u pages at %.1f%% occupancy.",
+          statistics.numUniqueImages, statistics.numImages, statistics.numPages, statistics.occupancy * 100.f);
+
+    pinfo("The texture atlas pages take %.2f MB; The same images take %.2f MB as separate textures.",
+          statistics.bytesWithAtlas / 1048576.0, statistics.bytesWithoutAtlas / 1048576.0);
+
+    return true;
+}
+
+///
+/// Generate the distance field atlas of a font on a worker thread
+///
+/// @param font The font
+/// @note `getDistanceFieldAtlas()` waits for the worker if the requested atlas is not ready yet.
+///
+void SpriteFactory::preloadDistanceFieldAtlas(Character::Font font)
+{
+    // Only one worker at a time, so no atlas is generated twice
+    if (this->glyphLoader.valid())
+    {
+        this->glyphLoader.wait();
+    }
+
+    auto& atlas = this->distanceFieldAtlasMap[font];
+
+    // Guard: The atlas exists already
+    if (atlas != nullptr)
+    {
+        return;
+    }
+
+    atlas.reset(new GlyphAtlas());
+
+    // The worker only touches the new atlas, never the map
+    GlyphAtlas* job = atlas.get();
+
+    const char* path = Character::pathForFont(font);
+
+    this->glyphLoader = std::async(std::launch::async, [job, path] ()
+    {
+        SW_TRACE_SCOPE("SpriteFactory::preloadDistanceFieldAtlas", "io");
+
+        job->rasterizeDistanceField(path);
+    }).share();
+}
+
+///
+/// Get the distance field atlas of a font, which renders text of any size
+///
+/// @param font The font
+/// @return The atlas with its texture uploaded, or `nullptr` if the font cannot be rasterized.
+/// @note An atlas that has not been preloaded is generated on the calling thread.
+///
+const GlyphAtlas* SpriteFactory::getDistanceFieldAtlas(Character::Font font)
+{
+    auto& atlas = this->distanceFieldAtlasMap[font];
+
+    if (atlas == nullptr)
+    {
+        SW_TRACE_SCOPE("SpriteFactory::loadDistanceFieldAtlas", "io");
+
+        atlas.reset(new GlyphAtlas());
+
+        atlas->rasterizeDistanceField(Character::pathForFont(font));
+    }
+    else if (!atlas->isRasterized() && this->glyphLoader.valid())
+    {
+        // The atlas is being preloaded
+        this->glyphLoader.wait();
+    }
+
+    // Guard: The glyphs must be rasterized and uploaded
+    if (!atlas->upload())
+    {
+        return nullptr;
+    }
+
+    return atlas.get();
+}
+
 ///
 /// Make the sprite for Character entity type
 /// @param sprite The sprite created on return
@@ -139,7 +307,14 @@ bool SpriteFactory::make<Character>(Sprite* sprite, void* info)
     
     // Retrieve the character and font info
     auto attribute = reinterpret_cast<Character::Attribute*>(info);
+
+    passert(attribute->pixelSize.width == 0, "API Usage Error: Font width is not supported. Set the height instead.");
+
+    // Retrieve the cached texture for this combination of font and size
+    auto& textures = this->characterTextureMap[SpriteFactory::makeFontKey(attribute->font, attribute->pixelSize.height)];
     
+    auto& texture = textures[attribute->character];
+
     auto& face = this->fontFaceMap[attribute->font];
     
     // Guard: Check the shared font face cache
@@ -165,20 +340,13 @@ bool SpriteFactory::make<Character>(Sprite* sprite, void* info)
         return false;
     }
     
-    passert(attribute->pixelSize.width == 0, "API Usage Error: Font width is not supported. Set the height instead.");
-    
-    // Retrieve the cached texture for this combination of font and size
-    uint64_t key = ((uint64_t) static_cast<std::underlying_type_t<Character::Font>>(attribute->font) << 32) | ((uint32_t) attribute->pixelSize.height);
-    
-    auto& textures = this->characterTextureMap[key];
-    
-    auto& texture = textures[attribute->character];
-    
     // Guard: Check the shared texture cache
     if (!texture.isValid())
     {
         // No cached texture for this combination of font and size
         // Guard: Load the texture for the requested character
+        SW_TRACE_SCOPE("SpriteFactory::loadGlyph", "io");
+
         if (!texture.loadFromFace(attribute->character, face))
         {
             pserror("Failed to load the character texture from the font face.");
@@ -189,13 +357,13 @@ bool SpriteFactory::make<Character>(Sprite* sprite, void* info)
     
     // Populate the character attributes
     attribute->size.width = face->glyph->bitmap.width;
-    
+
     attribute->size.height = face->glyph->bitmap.rows;
-    
+
     attribute->bearing.x = face->glyph->bitmap_left;
-    
+
     attribute->bearing.y = face->glyph->bitmap_top;
-    
+
     attribute->advance = (uint32_t) face->glyph->advance.x;
     
     // Initialize the sprite
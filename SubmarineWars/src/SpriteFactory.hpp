@@ -10,12 +10,18 @@
 #define SpriteFactory_hpp
 
 #include "Foundations/Foundations.hpp"
+#include "Foundations/TraceRecorder.hpp"
 #include "Entities/Entities.hpp"
 #include "Components/Sprite.hpp"
+#include "Systems/CollisionMask.hpp"
+#include "Systems/SpriteBatch.hpp"
+#include "TextureAtlas.hpp"
+#include "GlyphAtlas.hpp"
+#include <future>
+#include <memory>
 #include <typeindex>
 #include <type_traits>
 #include <unordered_map>
-#include <initializer_list>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
@@ -47,12 +53,16 @@ public:
         // as the map [] operator will create one for us.
         std::vector<Texture>& textures = this->texturesMap[typeid(T)];
 
+        std::vector<CollisionMask>& masks = this->collisionMasksMap[typeid(T)];
+
         // Guard: Check the shared textures cache [Stage 1]
         if (textures.empty())
         {
             // No cached textures for the given entity type
             // Reserved the memory for the number of textures
             textures.resize(SpriteFactory::texturePathsMap[typeid(T)].size());
+
+            masks.resize(textures.size());
         }
 
         // Guard: Consistency check
@@ -66,6 +76,8 @@ public:
         // Guard: Check the shared textures cache [Stage 2]
         auto piterator = SpriteFactory::texturePathsMap[typeid(T)].begin();
 
+        auto miterator = masks.begin();
+
         for (auto& texture : textures)
         {
 			// Guard: Check each cached texture
@@ -73,12 +85,21 @@ public:
             {
                 // No cached texture for the given entity type
                 // Load the texture from the file
+                SW_TRACE_SCOPE("SpriteFactory::loadTexture", "io");
+
                 if (!texture.loadFromFile(*piterator))
                 {
                     pserror("Failed to load the texture #%ld for entity type %s.", std::distance(SpriteFactory::texturePathsMap[typeid(T)].begin(), piterator), typeid(T).name());
 
                     return false;
                 }
+
+                // Build the collision mask from the same file while it is hot in the page cache
+                // The texture is usable without a mask, so the collision system falls back to the bounding box.
+                if (!SpriteFactory::loadCollisionMask(*miterator, *piterator))
+                {
+                    pwarning("Failed to build the collision mask #%ld for entity type %s.", std::distance(SpriteFactory::texturePathsMap[typeid(T)].begin(), piterator), typeid(T).name());
+                }
             }
 
             // Guard: Initialize the sprite with each texture
@@ -89,13 +110,93 @@ public:
                 return false;
             }
 
-            // Increment the path iterator
+            // Increment the path and mask iterators
             std::advance(piterator, 1);
+
+            std::advance(miterator, 1);
         }
         
         // All done without errors
         return true;
     }
+
+    ///
+    /// Get the collision mask for the given entity type
+    ///
+    /// @param frame The index of the texture for animated entities
+    /// @return The mask built from the alpha channel of the texture, or `nullptr` if the texture has not been loaded by `make()` yet.
+    /// @note The mask lives as long as the factory; Use `CollisionMask::getVariant()` for flipped or rotated entities.
+    ///
+    template <typename T> // Restricted: T must be a subclass of Entity
+    std::enable_if_t<std::is_base_of<Entity, T>::value, CollisionMask*> getCollisionMask(uint32_t frame = 0)
+    {
+        auto iterator = this->collisionMasksMap.find(typeid(T));
+
+        // Guard: The textures must be loaded
+        if (iterator == this->collisionMasksMap.end() || frame >= iterator->second.size() || !iterator->second[frame].isValid())
+        {
+            return nullptr;
+        }
+
+        return &iterator->second[frame];
+    }
+
+    ///
+    /// Pack the textures of all entity types into atlases
+    ///
+    /// @return `true` on success, `false` otherwise.
+    /// @note Each file is read once however many times it is listed, and files with identical pixels share a region.
+    ///       The frames of each page are registered with the shared sprite batch, which must be set up first.
+    /// @note The game does not load the atlas yet, because sprites are still drawn from the textures loaded by `make()`;
+    ///       Loading it as well would only add the pages to the texture memory.
+    ///
+    bool loadAtlas();
+
+    ///
+    /// Get the atlas region for the given entity type
+    ///
+    /// @param frame The index of the texture for animated entities
+    /// @return The region of the texture, or `nullptr` if the atlas has not been loaded.
+    /// @note Draw the region with the page texture `getAtlas().getTexture(region->page)` and the frame index `region->frame`.
+    ///
+    template <typename T> // Restricted: T must be a subclass of Entity
+    std::enable_if_t<std::is_base_of<Entity, T>::value, const TextureAtlas::Region*> getAtlasRegion(uint32_t frame = 0)
+    {
+        auto iterator = this->atlasRegionsMap.find(typeid(T));
+
+        // Guard: The atlas must be loaded
+        if (!this->atlas.isBuilt() || iterator == this->atlasRegionsMap.end() || frame >= iterator->second.size())
+        {
+            return nullptr;
+        }
+
+        return &this->atlas.getRegion(iterator->second[frame]);
+    }
+
+    ///
+    /// Generate the distance field atlas of a font on a worker thread
+    ///
+    /// @param font The font
+    /// @note `getDistanceFieldAtlas()` waits for the worker if the requested atlas is not ready yet.
+    ///
+    void preloadDistanceFieldAtlas(Character::Font font);
+
+    ///
+    /// Get the distance field atlas of a font, which renders text of any size
+    ///
+    /// @param font The font
+    /// @return The atlas with its texture uploaded, or `nullptr` if the font cannot be rasterized.
+    /// @note An atlas that has not been preloaded is generated on the calling thread.
+    ///
+    const GlyphAtlas* getDistanceFieldAtlas(Character::Font font);
+
+    ///
+    /// [FAST] Get the atlas of the textures of all entity types
+    ///
+    inline const TextureAtlas& getAtlas() const
+    {
+        return this->atlas;
+    }
     
 private:
     /// The number of ASCII characters
@@ -104,6 +205,9 @@ private:
     /// A texture map type that maps the Entity type to its cached texture objects
     typedef std::unordered_map<std::type_index, std::vector<Texture>> TexturesMap;
     
+    /// A collision mask map type that maps the Entity type to the masks of its cached textures
+    typedef std::unordered_map<std::type_index, std::vector<CollisionMask>> CollisionMasksMap;
+
     /// A texture path map that maps the Entity type to its texture file paths
     typedef std::unordered_map<std::type_index, std::vector<const char*>> TexturePathsMap;
     
@@ -113,6 +217,12 @@ private:
     /// A texture map type that maps the pair of font and size to cached texture objects for all ASCII characters
     typedef std::unordered_map<uint64_t, Texture[NUM_ASCII_CHARS]> CharacterTextureMap;
 
+    /// An atlas region map type that maps the Entity type to the regions of its textures
+    typedef std::unordered_map<std::type_index, std::vector<uint32_t>> AtlasRegionsMap;
+
+    /// A distance field atlas map type that maps the font to the distance fields of the printable characters
+    typedef std::unordered_map<Character::Font, std::unique_ptr<GlyphAtlas>> DistanceFieldAtlasMap;
+
     /// A font face map type that maps the font to cached font face handle
     typedef std::unordered_map<Character::Font, FT_Face> FontFaceMap;
     
@@ -123,11 +233,33 @@ private:
     /// For animated entity, there will be multiple cached textures.
     TexturesMap texturesMap;
 
+    /// A map that contains the collision masks of the cached textures
+    /// where key is the type id of the entity;
+    /// and value is the masks in the same order as the cached textures.
+    CollisionMasksMap collisionMasksMap;
+
+    /// The atlas that packs the textures of all entity types
+    /// Pages hold at most as many regions as the sprite batch has frames per texture.
+    TextureAtlas atlas{TextureAtlas::DEF_PAGE_SIZE, SpriteBatch::MAX_NUM_FRAMES};
+
+    /// A map that contains the atlas regions of the textures
+    /// where key is the type id of the entity;
+    /// and value is the indices of the regions in the same order as the texture file paths.
+    AtlasRegionsMap atlasRegionsMap;
+
     /// A map that contains cached textures for all ASCII characters
     /// where key is the pair of font type and size, represented in UInt64;
     /// and value is an array of cached texture indexed by the ASCII character.
     CharacterTextureMap characterTextureMap;
 
+    /// A map that contains the distance field atlases
+    /// where key is the font type;
+    /// and value is the atlas, which stays at the same address while the worker fills it.
+    DistanceFieldAtlasMap distanceFieldAtlasMap;
+
+    /// The worker that generates the preloaded distance field atlases
+    std::shared_future<void> glyphLoader;
+
     /// A map that contains cached font face handles
     /// where key is the font type;
     /// and value is the cached font face handle object.
@@ -161,6 +293,23 @@ private:
         return SpriteFactory::shaderPathsMap.find(type) == SpriteFactory::shaderPathsMap.end() ? SpriteFactory::defaultShaderPaths : SpriteFactory::shaderPathsMap[type];
     }
     
+    ///
+    /// [Private Helper] Make the key of the pair of font and size
+    ///
+    static inline uint64_t makeFontKey(Character::Font font, uint32_t size)
+    {
+        return ((uint64_t) static_cast<std::underlying_type_t<Character::Font>>(font) << 32) | size;
+    }
+
+    ///
+    /// [Private Helper] Build the collision mask from the alpha channel of an image file
+    ///
+    /// @param mask The mask built on return
+    /// @param path The path to the image file
+    /// @return `true` on success, `false` otherwise.
+    ///
+    static bool loadCollisionMask(CollisionMask& mask, const char* path);
+
     /// Private constructor
     SpriteFactory();
 };
@@ -9,12 +9,28 @@
 #include "Stage.hpp"
 #include "Foundations/JSON.hpp"
 #include "Foundations/Debug.hpp"
+#include "Foundations/TraceRecorder.hpp"
 #include "ProjectPath.hpp"
 #include <fstream>
+#include <algorithm>
 #include <sstream>
 
 using JSON = nlohmann::json;
 
+/// The directory from which stage files are loaded
+char Stage::directory[1024] = SWDataPath "/stages";
+
+///
+/// Set the directory from which stage files are loaded
+///
+/// @param path The stage directory; by default the `stages` folder in the data directory
+/// @note Stages that have been loaded are not reloaded.
+///
+void Stage::setDirectory(const char* path)
+{
+    snprintf(Stage::directory, sizeof(Stage::directory), "%s", path);
+}
+
 ///
 /// Load a stage
 ///
@@ -22,9 +38,11 @@ using JSON = nlohmann::json;
 ///
 bool Stage::load(uint32_t number)
 {
+    SW_TRACE_SCOPE("Stage::load", "io");
+
     char* path = new char[1024]();
     
-    snprintf(path, 1024, "%s/stages/Stage%d.json", SWDataPath, number);
+    snprintf(path, 1024, "%s/Stage%d.json", Stage::directory, number);
     
     pinfo("Stage file is %s.", path);
     
@@ -93,6 +111,15 @@ bool Stage::load(uint32_t number)
     printf("Read current %f\n", getFloat(Keys::CurrVec, Submarine::Type::I));
     this->currentVec.y = getFloat(Keys::CurrVec, Submarine::Type::II);
 
+    // Stages that predate the spawn keys use the default interval and wave size
+    Keys::get(keybuf, size(keybuf), Keys::SpawnInterval, Submarine::Type::I);
+
+    this->spawnInterval = object.value(keybuf, float(Stage::DEF_SPAWN_INTERVAL));
+
+    Keys::get(keybuf, size(keybuf), Keys::SpawnWaveSize, Submarine::Type::I);
+
+    this->spawnWaveSize = std::max<uint32_t>(object.value(keybuf, uint32_t(Stage::DEF_SPAWN_WAVE_SIZE)), 1);
+
     // TODO: IMP THIS
     // Decoding required control data later, e.g. Attack AI data, etc.
     return true;
@@ -17,13 +17,30 @@
 /// Represents a stage in the game
 class Stage
 {
+    /// The stage generator encodes stage files with the same keys
+    friend class StageGenerator;
+
 public:
+    /// The default interval between two spawn waves in milliseconds
+    static constexpr float DEF_SPAWN_INTERVAL = 1000.f;
+
+    /// The default maximum number of submarines of each type in a spawn wave
+    static constexpr uint32_t DEF_SPAWN_WAVE_SIZE = 1;
+
     ///
     /// Load a stage
     ///
     /// @param number The stage number
     ///
     bool load(uint32_t number);
+
+    ///
+    /// Set the directory from which stage files are loaded
+    ///
+    /// @param path The stage directory; by default the `stages` folder in the data directory
+    /// @note Stages that have been loaded are not reloaded.
+    ///
+    static void setDirectory(const char* path);
     
     //
     // MARK:- Query Stage Control Data
@@ -95,6 +112,22 @@ public:
         return this->currentVec;
     }
 
+    ///
+    /// [FAST] Get the interval between two spawn waves in milliseconds
+    ///
+    inline float getSpawnInterval()
+    {
+        return this->spawnInterval;
+    }
+
+    ///
+    /// [FAST] Get the maximum number of submarines of each type in a spawn wave
+    ///
+    inline uint32_t getSpawnWaveSize()
+    {
+        return this->spawnWaveSize;
+    }
+
     ///
     /// Get the type of the current stage
     /// 0 = normal
@@ -131,6 +164,15 @@ private:
 
     /// Gets the type of this stage
     int sType;
+
+    /// The interval between two spawn waves in milliseconds
+    float spawnInterval;
+
+    /// The maximum number of submarines of each type in a spawn wave
+    uint32_t spawnWaveSize;
+
+    /// The directory from which stage files are loaded
+    static char directory[1024];
     
     /// Enumerates all keys used in encoding and decoding stage control data
     struct Keys
@@ -167,7 +209,13 @@ private:
             /// The type of the current stage
             /// 0 = Normal
             /// 1 = Store
-            StageType
+            StageType,
+
+            /// [Optional] The interval between two spawn waves in milliseconds
+            SpawnInterval,
+
+            /// [Optional] The maximum number of submarines of each type in a spawn wave
+            SpawnWaveSize
         };
         
         ///
@@ -207,6 +255,12 @@ private:
                 case StageType:
                     return "StageType";
 
+                case SpawnInterval:
+                    return "SpawnInterval";
+
+                case SpawnWaveSize:
+                    return "SpawnWaveSize";
+
                 default:
                     pserror("[Fatal] Unimplemented switch case.");
                     
@@ -8,6 +8,9 @@
 
 #include "StageController.hpp"
 #include "Sounds/SoundPlayer.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include "Replay.hpp"
+#include <algorithm>
 
 /// A stage cache to allow lazy initialization
 Stage StageController::stages[TOTAL_NUM_STAGES + 1];
@@ -29,15 +32,21 @@ StageController::StageController(EntityManager* entityManager)
     this->drandom.init(0, 1);
     this->fishRandom.init(200.f, 700.f);
 
-    sinceSpawn = 1000;
+    spawnTimer = 0;
+    smokeTimer = 0;
     betweenSpawns = 1000;
-    sinceSmokeSpawn = 500;
-    sinceSmokeSpawn = 500;
+    betweenSmokeSpawns = 500;
+    spawnWaveSize = 1;
     subsDead = 0;
     loading = false;
     fishCount = 0;
     storeInit = false;
     storeEnded = false;
+
+    // An entity is removed at most once per update session
+    this->removals.reserve(EntityManager::MAX_NUM_ON_SCREEN_ENTITIES);
+
+    this->collisionEvents.reserve(EntityManager::MAX_NUM_ON_SCREEN_ENTITIES);
 }
 
 void StageController::signalGameActive(bool active)
@@ -71,47 +80,18 @@ void StageController::update(float elapsed_ms)
 /// @param elapsed_ms The elapsed time since last tick
 ///
 void StageController::updateNormalStage(float elapsed_ms) {
-    // Spawn one submarine of each type that must be spawned
-    uint32_t typeIToSpawn = this->resSubCounts[Submarine::Type::I];
-    uint32_t typeIIToSpawn = this->resSubCounts[Submarine::Type::II];
-    uint32_t typeIIIToSpawn = this->resSubCounts[Submarine::Type::III];
-
-    uint32_t fishToSpawn = this->resFishCount;
-
-    if (sinceSpawn + elapsed_ms > betweenSpawns) {
-        sinceSpawn = 0;
-        if (typeIToSpawn > 0) { // Spawn a type I submarine
-            spawnSubmarine(Submarine::Type::I);
-            this->resSubCounts[Submarine::Type::I] -= 1; // Dec by 1
-        }
-        if (typeIIToSpawn > 0) { // Spawn a type II submarine
-            spawnSubmarine(Submarine::Type::II);
-            this->resSubCounts[Submarine::Type::II] -= 1; // Dec by 1
-        }
-        if (typeIIIToSpawn > 0) { // Spawn a type III submarine
-            spawnSubmarine(Submarine::Type::III);
-            this->resSubCounts[Submarine::Type::III] -= 1; // Dec by 1
-        }
-        if (fishToSpawn > 0 && fishCount <= totalFish) { // Spawn a fish
-            spawnFish();
-            //printf("Spawning fish from here");
-            this->resFishCount -= 1;
-            fishCount += 1; // Inc by 1
-        }
-    } else {
-        sinceSpawn += elapsed_ms;
-    }
-
-    if (sinceSpawn + elapsed_ms > betweenSpawns && gameIsActive == true) {
-        sinceSpawn = 0;
-        spawnSmoke();
-    } else {
-        sinceSpawn += elapsed_ms;
-    }
+    // Spawn waves and smoke
+    this->timers.advance(elapsed_ms);
 
     // Check if all submarines have been removed and advance stage
     if (isStageClear() && gameIsActive == true /*&& loading == false*/)
     {
+        // A soak test starts over once it has cleared the last stage
+        if (soakMode && !hasNextStage())
+        {
+            this->currentStageNumber = -1;
+        }
+
         // TODO: Not Robust
         //loading = true;
         nextStage();
@@ -147,6 +127,11 @@ void StageController::updateStoreStage(float elapsed_ms) {
         storeInit = true;
     }
 
+    // Nobody is there to shop during a soak test
+    if (soakMode) {
+        storeEnded = true;
+    }
+
     if (storeEnded) {
         this->entityManager->removeAllEntities(); // Clear the stage
 
@@ -170,6 +155,8 @@ void StageController::updateStoreStage(float elapsed_ms) {
 ///
 Entity::Identifier StageController::spawnBomb(Position& position, vec2 boatVel)
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     // Guard: Check whether the player has reached the limit
     if (!this->player->hasAvailableBombs())
     {
@@ -201,6 +188,8 @@ Entity::Identifier StageController::spawnBomb(Position& position, vec2 boatVel)
 ///
 Entity::Identifier StageController::spawnExplosion(Position& position)
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     Explosion explosion;
 
     if (!this->entityManager->makeExplosion(explosion, position))
@@ -224,12 +213,14 @@ Entity::Identifier StageController::spawnExplosion(Position& position)
 ///
 Entity::Identifier StageController::spawnSubmarine(Submarine::Type type)
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     // Generate a direction and a position
-    Position position(0, this->yrandoms[type].generate());
+    Position position(0, Replay::shared()->generate(this->yrandoms[type]));
     
     Direction direction = Direction::Right;
     
-    if (this->drandom.generate() == 0)
+    if (Replay::shared()->generate(this->drandom) == 0)
     {
         direction = Direction::Left;
 
@@ -263,7 +254,7 @@ Entity::Identifier StageController::spawnSubIHelper(Position pos, Direction dir)
 
     // TODO: Read the score for each submarine type from the stage control data
     // TODO: Read the radar radius for each submarine type from the stage control data
-    if (!this->entityManager->makeSubmarine(submarine, pos, dir, this->vrandoms[type].generate(), type, 3, FLT_MAX))
+    if (!this->entityManager->makeSubmarine(submarine, pos, dir, Replay::shared()->generate(this->vrandoms[type]), type, 3, FLT_MAX))
     {
         return 0;
     }
@@ -289,7 +280,7 @@ Entity::Identifier StageController::spawnSubIIHelper(Position pos, Direction dir
 
     // TODO: Read the score for each submarine type from the stage control data
     // TODO: Read the radar radius for each submarine type from the stage control data
-    if (!this->entityManager->makeSubmarine(submarine, pos, dir, this->vrandoms[type].generate(), type, 3, FLT_MAX))
+    if (!this->entityManager->makeSubmarine(submarine, pos, dir, Replay::shared()->generate(this->vrandoms[type]), type, 3, FLT_MAX))
     {
         return 0;
     }
@@ -315,7 +306,7 @@ Entity::Identifier StageController::spawnSubIIIHelper(Position pos, Direction di
 
     // TODO: Read the score for each submarine type from the stage control data
     // TODO: Read the radar radius for each submarine type from the stage control data
-    if (!this->entityManager->makeSubmarine(submarine, pos, dir, this->vrandoms[type].generate(), type, 3, FLT_MAX))
+    if (!this->entityManager->makeSubmarine(submarine, pos, dir, Replay::shared()->generate(this->vrandoms[type]), type, 3, FLT_MAX))
     {
         return 0;
     }
@@ -335,13 +326,15 @@ Entity::Identifier StageController::spawnSubIIIHelper(Position pos, Direction di
 ///
 Entity::Identifier StageController::spawnFish()
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     // Generate a direction and a position
 
-    Position position(0, fishRandom.generate());
+    Position position(0, Replay::shared()->generate(this->fishRandom));
 
     Direction direction = Direction::Right;
 
-    if (this->drandom.generate() == 0)
+    if (Replay::shared()->generate(this->drandom) == 0)
     {
         direction = Direction::Left;
 
@@ -371,6 +364,8 @@ Entity::Identifier StageController::spawnFish()
 ///
 Entity::Identifier StageController::spawnTorpedo(Position &position, vec2 initVel)
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     Torpedo torpedo;
 
     if (!this->entityManager->makeTorpedo(torpedo, position, initVel))
@@ -391,6 +386,8 @@ Entity::Identifier StageController::spawnTorpedo(Position &position, vec2 initVe
 ///
 bool StageController::spawnSmoke()
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     Smoke smoke;
 
     if (!this->entityManager->makeSmoke(smoke))
@@ -412,6 +409,8 @@ bool StageController::spawnSmoke()
 ///
 Entity::Identifier StageController::spawnMissile(Position &position)
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     Missile missile;
 
     if(!this->entityManager->makeMissile(missile, position))
@@ -434,6 +433,8 @@ Entity::Identifier StageController::spawnMissile(Position &position)
 ///
 Entity::Identifier StageController::spawnBoatMissile(Position &position, Position& target)
 {
+    SW_PROFILE_SCOPE(Spawn);
+
     BoatMissile boatMissile;
 
     // Guard: Check whether the player has reached the limit
@@ -467,6 +468,7 @@ Entity::Identifier StageController::spawnBoatMissile(Position &position, Positio
 /// @return A positive entity identifier on success, `0` otherwise.
 ///
 Entity::Identifier StageController::spawnBuyLives(Position& position) {
+    SW_PROFILE_SCOPE(Spawn);
 
     BuyLives buyLives;
 
@@ -487,6 +489,8 @@ Entity::Identifier StageController::spawnBuyLives(Position& position) {
 /// @return A positive entity identifier on success, `0` otherwise.
 ///
 Entity::Identifier StageController::spawnBuyMissiles(Position& position) {
+    SW_PROFILE_SCOPE(Spawn);
+
     BuyMissiles buyMissiles;
 
     if(!this->entityManager->makeBuyMissiles(buyMissiles, position))
@@ -506,6 +510,8 @@ Entity::Identifier StageController::spawnBuyMissiles(Position& position) {
 /// @return A positive entity identifier on success, `0` otherwise.
 ///
 Entity::Identifier StageController::spawnEndStore(Position& position) {
+    SW_PROFILE_SCOPE(Spawn);
+
     EndStore endStore;
 
     if(!this->entityManager->makeEndStore(endStore, position))
@@ -568,10 +574,66 @@ bool StageController::loadGame(SC_SaveGameData data)
     
     // Reinitialize the random number generators
     this->initRandomNumGen(nextStage);
+
+    betweenSpawns = nextStage->getSpawnInterval();
+    spawnWaveSize = nextStage->getSpawnWaveSize();
+    scheduleStageTimers(0, betweenSmokeSpawns);
     
     return true;
 }
 
+///
+/// Check whether the current state can be captured by a snapshot
+///
+/// @return `true` if a normal stage is being played, `false` on menu screens and in stores.
+///
+bool StageController::canTakeSnapshot()
+{
+    return gameIsActive && !tutorialActive && stageType == 0;
+}
+
+///
+/// Capture the stage progress
+///
+/// @param snapshot The snapshot to overwrite
+///
+void StageController::takeSnapshot(SC_Snapshot* snapshot)
+{
+    this->saveGame(&snapshot->progress);
+
+    snapshot->resFishCount = this->resFishCount;
+
+    snapshot->fishCount = this->fishCount;
+
+    snapshot->spawnDelay = this->timers.getRemaining(this->spawnTimer);
+
+    snapshot->smokeDelay = this->timers.getRemaining(this->smokeTimer);
+}
+
+///
+/// Restore the stage progress from a snapshot
+///
+/// @param snapshot A snapshot taken by `takeSnapshot()`
+/// @return `true` on success, `false` otherwise.
+/// @note The spawn and smoke timers resume with the time that was left when the snapshot was taken.
+///
+bool StageController::restoreSnapshot(const SC_Snapshot& snapshot)
+{
+    if (!this->loadGame(snapshot.progress))
+    {
+        return false;
+    }
+
+    this->resFishCount = snapshot.resFishCount;
+
+    this->fishCount = snapshot.fishCount;
+
+    // Loading the progress restarts the timers, so put them back in phase
+    this->scheduleStageTimers(std::max(snapshot.spawnDelay, 0.f), std::max(snapshot.smokeDelay, 0.f));
+
+    return true;
+}
+
 //
 // MARK:- Manages Game Stages
 //
@@ -613,6 +675,8 @@ void StageController::initRandomNumGen(Stage* stage)
 ///
 bool StageController::nextStage()
 {
+    SW_TRACE_SCOPE("StageController::nextStage", "stage");
+
     // Guard: Must have a next stage
     passert(this->hasNextStage(), "[Fatal] Must have a next stage.");
     
@@ -647,6 +711,10 @@ bool StageController::nextStage()
 
     this->stageType = nextStage->getStageType();
 
+    betweenSpawns = nextStage->getSpawnInterval();
+    spawnWaveSize = nextStage->getSpawnWaveSize();
+    scheduleStageTimers(0, betweenSmokeSpawns);
+
     storeInit = false;
     storeEnded = false;
 
@@ -686,41 +754,281 @@ bool StageController::isStageClear()
 ///
 void StageController::beginUpdates()
 {
-    // Clear all identifiers to be removed
-    this->rmbombs.clear();
-    
-    this->rmsubmarines.clear();
-    
-    this->rmfishes.clear();
-    
-    this->rmtorpedoes.clear();
-    
-    this->rmmissiles.clear();
+    // Clear the marks of the entities removed in the last update session
+    for (const auto& removal : this->removals)
+    {
+        this->removalMarks.reset(removal.identifier);
+    }
+
+    this->removals.clear();
+}
+
+///
+/// Called with all collisions found by the collision system in this update session
+///
+/// @param events The collision events in the order they were detected
+///
+void StageController::handleCollisionEvents(const CollisionEventBuffer& events)
+{
+    bool scoreDidChange = false;
+
+    for (const auto& event : events)
+    {
+        switch (event.type)
+        {
+            case CollisionEvent::Type::BombDidGenerateExplosion:
+                this->handleBombDidGenerateExplosion(event.first);
+                break;
+
+            case CollisionEvent::Type::BoatMissileDidGenerateExplosion:
+                this->handleBoatMissileDidGenerateExplosion(event.first);
+                break;
+
+            case CollisionEvent::Type::ExplosionDidCollideWithSubmarine:
+                scoreDidChange |= this->handleExplosionDidCollideWithSubmarine(event.first);
+                break;
+
+            case CollisionEvent::Type::ExplosionDidCollideWithFish:
+                scoreDidChange |= this->handleExplosionDidCollideWithFish(event.first);
+                break;
+
+            case CollisionEvent::Type::ExplosionDidCollideWithMissile:
+                this->handleExplosionDidCollideWithMissile(event.first);
+                break;
+
+            case CollisionEvent::Type::ExplosionDidCollideWithTorpedo:
+                this->handleExplosionDidCollideWithTorpedo(event.first);
+                break;
+
+            case CollisionEvent::Type::ExplosionDidCollideWithStoreIcon:
+                this->handleExplosionDidCollideWithStoreIcon(event.first);
+                break;
+
+            case CollisionEvent::Type::TorpedoDidCollideWithBoat:
+                this->handleTorpedoDidCollideWithBoat(event.first, event.second);
+                break;
+
+            case CollisionEvent::Type::MissileDidCollideWithBoat:
+                this->handleMissileDidCollideWithBoat(event.first, event.second);
+                break;
+
+            case CollisionEvent::Type::SubmarineDidMoveOutOfScreen:
+                this->handleSubmarineDidMoveOutOfScreen(event.first);
+                break;
+
+            case CollisionEvent::Type::BombDidMoveOutOfScreen:
+                this->handleBombDidMoveOutOfScreen(event.first);
+                break;
+
+            case CollisionEvent::Type::MissileDidMoveOutOfScreen:
+                this->handleMissileDidMoveOutOfScreen(event.first);
+                break;
+
+            case CollisionEvent::Type::TorpedoDidMoveOutOfOceanSurface:
+                this->handleTorpedoDidMoveOutOfOceanSurface(event.first);
+                break;
+
+            case CollisionEvent::Type::SmokeDidMoveOutOfScreen:
+                this->handleSmokeDidMoveOutOfScreen(event.first);
+                break;
+
+            default:
+                pserror("[Fatal] Unimplemented switch case.");
+                break;
+        }
+    }
 
-    this->rmboatmissiles.clear();
+    // Commit the score once for the whole batch
+    // No need to worry about updating the score label,
+    // as these will be handled by the PlayerDelegate (i.e. delegate chaining)
+    if (scoreDidChange)
+    {
+        this->player->commitScore();
+    }
 }
 
 //
-// MARK: Player attacks enemies and fishes
+// MARK: Per-scenario callbacks
 //
 
 ///
 /// Called when a bomb collides with a destroyable entity and consequently causes an explosion
 ///
-/// @param bomb The identifier of the bomb that collides with a submarine
-/// @param pos The identifier of the submarine that will be destroyed by the bomb
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
 ///
 void StageController::bombDidGenerateExplosion(Entity::Identifier bomb)
 {
+    this->collisionEvents.push(CollisionEvent::Type::BombDidGenerateExplosion, bomb);
+}
+
+///
+/// Called when a boat missile reaches the end of its path and consequently causes an explosion
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::boatMissileDidGenerateExplosion(Entity::Identifier boatMissile)
+{
+    this->collisionEvents.push(CollisionEvent::Type::BoatMissileDidGenerateExplosion, boatMissile);
+}
+
+///
+/// Called when an explosion collides with submarines
+///
+/// @note The events are handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::explosionDidCollideWithSubmarines(const std::vector<Entity::Identifier>& submarines)
+{
+    for (auto submarine : submarines)
+    {
+        this->collisionEvents.push(CollisionEvent::Type::ExplosionDidCollideWithSubmarine, submarine);
+    }
+}
+
+///
+/// Called when an explosion collides with fish
+///
+/// @note The events are handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::explosionDidCollideWithFishes(const std::vector<Entity::Identifier>& fishes)
+{
+    for (auto fish : fishes)
+    {
+        this->collisionEvents.push(CollisionEvent::Type::ExplosionDidCollideWithFish, fish);
+    }
+}
+
+///
+/// Called when an explosion collides with missiles
+///
+/// @note The events are handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::explosionDidCollideWithMissiles(const std::vector<Entity::Identifier>& missiles)
+{
+    for (auto missile : missiles)
+    {
+        this->collisionEvents.push(CollisionEvent::Type::ExplosionDidCollideWithMissile, missile);
+    }
+}
+
+///
+/// Called when an explosion collides with torpedoes
+///
+/// @note The events are handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::explosionDidCollideWithTorpedoes(const std::vector<Entity::Identifier>& torpedoes)
+{
+    for (auto torpedo : torpedoes)
+    {
+        this->collisionEvents.push(CollisionEvent::Type::ExplosionDidCollideWithTorpedo, torpedo);
+    }
+}
+
+///
+/// Called when an explosion collides with store icons
+///
+/// @note The events are handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::explosionDidCollideWithStoreIcons(const std::vector<Entity::Identifier>& storeIcons)
+{
+    for (auto storeIcon : storeIcons)
+    {
+        this->collisionEvents.push(CollisionEvent::Type::ExplosionDidCollideWithStoreIcon, storeIcon);
+    }
+}
+
+///
+/// Called when a torpedo collides with the player boat
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::torpedoDidCollideWithBoat(Entity::Identifier torpedo, Entity::Identifier boat)
+{
+    this->collisionEvents.push(CollisionEvent::Type::TorpedoDidCollideWithBoat, torpedo, boat);
+}
+
+///
+/// Called when a missile collides with the player boat
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::missileDidCollideWithBoat(Entity::Identifier missile, Entity::Identifier boat)
+{
+    this->collisionEvents.push(CollisionEvent::Type::MissileDidCollideWithBoat, missile, boat);
+}
+
+///
+/// Called when a submarine did move out of screen
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::submarineDidMoveOutOfScreen(Entity::Identifier submarine)
+{
+    this->collisionEvents.push(CollisionEvent::Type::SubmarineDidMoveOutOfScreen, submarine);
+}
+
+///
+/// Called when a bomb did move out of screen
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::bombDidMoveOutOfScreen(Entity::Identifier bomb)
+{
+    this->collisionEvents.push(CollisionEvent::Type::BombDidMoveOutOfScreen, bomb);
+}
+
+///
+/// Called when a missile did move out of screen
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::missileDidMoveOutOfScreen(Entity::Identifier missile)
+{
+    this->collisionEvents.push(CollisionEvent::Type::MissileDidMoveOutOfScreen, missile);
+}
+
+///
+/// Called when a torpedo did move out of the ocean surface
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::torpedoDidMoveOutOfOceanSurface(Entity::Identifier torpedo)
+{
+    this->collisionEvents.push(CollisionEvent::Type::TorpedoDidMoveOutOfOceanSurface, torpedo);
+}
+
+///
+/// Called when smoke moves above top of screen
+///
+/// @note The event is handled with the rest of the batch in `endUpdates()`.
+///
+void StageController::smokeDidMoveOutOfScreen(Entity::Identifier smoke)
+{
+    this->collisionEvents.push(CollisionEvent::Type::SmokeDidMoveOutOfScreen, smoke);
+}
+
+//
+// MARK: Player attacks enemies and fishes
+//
+
+///
+/// [Handler] Called when a bomb collides with a destroyable entity and consequently causes an explosion
+///
+/// @param bomb The identifier of the bomb that collides with a submarine
+///
+void StageController::handleBombDidGenerateExplosion(Entity::Identifier bomb)
+{
+    // Guard: A bomb explodes once even if it hits several entities
+    if (!this->markForRemoval(RemovalKind::Bomb, bomb))
+    {
+        return;
+    }
+
     // Spawn an explosion at the bomb position
     psoftassert(this->spawnExplosion(this->entityManager->componentsForType<Position>()[bomb]), "Failed to spawn an explosion.");
     
     // Play the explosion sound effect
     psoftassert(SoundPlayer::shared()->playExplosionSoundEffect(), "Failed to play the explosion sound effect.");
     
-    // Set the bomb to be removed
-    this->rmbombs.insert(bomb);
-    
     // We now have one more available bomb
     // No need to worry about updating the bomb status label
     // as these will be handled by the PlayerDelegate (i.e. delegate chaining)
@@ -728,115 +1036,112 @@ void StageController::bombDidGenerateExplosion(Entity::Identifier bomb)
 }
 
 ///
-/// Called when a boat missile reaches the end of its path and consequently causes an explosion
+/// [Handler] Called when a boat missile reaches the end of its path and consequently causes an explosion
 ///
 /// @param boatMissile The identifier of the boat missile that's exploding
 ///
-void StageController::boatMissileDidGenerateExplosion(Entity::Identifier boatMissile) {
+void StageController::handleBoatMissileDidGenerateExplosion(Entity::Identifier boatMissile) {
+    if (!this->markForRemoval(RemovalKind::BoatMissile, boatMissile)) {
+        return;
+    }
+
     this->spawnExplosion(this->entityManager->componentsForType<Position>()[boatMissile]);
 
     SoundPlayer::shared()->playExplosionSoundEffect();
-
-    this->rmboatmissiles.insert(boatMissile);
 }
 
 ///
-/// Called when an explosion collides with submarines
+/// [Handler] Called when an explosion collides with a submarine
 ///
-/// @param submarines Identifiers of submarines that will be destroyed by the bomb
-/// @note This delegate method enables the collision handling for chaining explosions on submarines.
+/// @param submarine The identifier of the submarine that will be destroyed by the explosion
+/// @return `true` if the player score changed, `false` otherwise.
+/// @note This handler enables the collision handling for chaining explosions on submarines.
 ///
-void StageController::explosionDidCollideWithSubmarines(std::vector<Entity::Identifier> submarines)
+bool StageController::handleExplosionDidCollideWithSubmarine(Entity::Identifier submarine)
 {
-    // Remove the submarines
-    this->rmsubmarines.insert(submarines.begin(), submarines.end());
-    
+    // Guard: A submarine hit by several explosions scores once
+    if (!this->markForRemoval(RemovalKind::Submarine, submarine))
+    {
+        return false;
+    }
+
     // Add the player score
-    std::for_each(submarines.begin(), submarines.end(), [this] (auto& id) { this->player->incrementScore(this->entityManager->componentsForType<Score>()[id].score); });
-    
-    // Commit the score
-    // No need to worry about updating the score label,
-    // as these will be handled by the PlayerDelegate (i.e. delegate chaining)
-    this->player->commitScore();
+    this->player->incrementScore(this->entityManager->componentsForType<Score>()[submarine].score);
+
+    return true;
 }
 
 ///
-/// Called when an explosion collides with fish
+/// [Handler] Called when an explosion collides with a fish
 ///
-/// @param fishes Identifiers of fishes that will be destroyed by the bomb
-/// @note This delegate method enables the collision handling for chaining explosions on fishes.
+/// @param fish The identifier of the fish that will be destroyed by the explosion
+/// @return `true` if the player score changed, `false` otherwise.
+/// @note This handler enables the collision handling for chaining explosions on fishes.
 ///
-void StageController::explosionDidCollideWithFishes(std::vector<Entity::Identifier> fishes)
+bool StageController::handleExplosionDidCollideWithFish(Entity::Identifier fish)
 {
-    // Remove the fishes
-    this->rmfishes.insert(fishes.begin(), fishes.end());
-    
+    // Guard: A fish hit by several explosions scores once
+    if (!this->markForRemoval(RemovalKind::Fish, fish))
+    {
+        return false;
+    }
+
     // Add the player score
-    std::for_each(fishes.begin(), fishes.end(), [this] (auto& id) { this->player->incrementScore(this->entityManager->componentsForType<Score>()[id].score); });
-    
-    // Commit the score
-    // No need to worry about updating the score label,
-    // as these will be handled by the PlayerDelegate (i.e. delegate chaining)
-    this->player->commitScore();
+    this->player->incrementScore(this->entityManager->componentsForType<Score>()[fish].score);
+
+    return true;
 }
 
 ///
-/// Called when an explosion collides with missile
+/// [Handler] Called when an explosion collides with a missile
 ///
-/// @param missiles Identifiers of missiles that will be destroyed by the bomb
-/// @note This delegate method enables the collision handling for chaining explosions on missiles.
+/// @param missile The identifier of the missile that will be destroyed by the explosion
+/// @note This handler enables the collision handling for chaining explosions on missiles.
 ///
-void StageController::explosionDidCollideWithMissiles(std::vector<Entity::Identifier> missiles) {
-    // Remove the missiles
-    this->rmmissiles.insert(missiles.begin(), missiles.end());
+void StageController::handleExplosionDidCollideWithMissile(Entity::Identifier missile) {
+    if (!this->markForRemoval(RemovalKind::Missile, missile)) {
+        return;
+    }
 
-    // Spawn an explosion for each missile
-    std::for_each(missiles.begin(), missiles.end(), [this] (auto& id) {
-        this->spawnExplosion(this->entityManager->componentsForType<Position>()[id]);
-        SoundPlayer::shared()->playExplosionSoundEffect();
-    });
+    // Spawn an explosion for the missile
+    this->spawnExplosion(this->entityManager->componentsForType<Position>()[missile]);
+    SoundPlayer::shared()->playExplosionSoundEffect();
 }
 
 ///
-/// Called when an explosion collides with torpedo
+/// [Handler] Called when an explosion collides with a torpedo
 ///
-/// @param torpedoes Identifiers of torpedoes that will be destroyed by the bomb
-/// @note This delegate method enables the collision handling for chaining explosions on torpedoes.
+/// @param torpedo The identifier of the torpedo that will be destroyed by the explosion
+/// @note This handler enables the collision handling for chaining explosions on torpedoes.
 ///
-void StageController::explosionDidCollideWithTorpedoes(std::vector<Entity::Identifier> torpedoes) {
-    // Remove the torpedoes
-    this->rmtorpedoes.insert(torpedoes.begin(), torpedoes.end());
+void StageController::handleExplosionDidCollideWithTorpedo(Entity::Identifier torpedo) {
+    if (!this->markForRemoval(RemovalKind::Torpedo, torpedo)) {
+        return;
+    }
 
-    // Spawn an explosion for each torpedo
-    std::for_each(torpedoes.begin(), torpedoes.end(), [this] (auto& id) {
-        this->spawnExplosion(this->entityManager->componentsForType<Position>()[id]);
-        SoundPlayer::shared()->playExplosionSoundEffect();
-    });
+    // Spawn an explosion for the torpedo
+    this->spawnExplosion(this->entityManager->componentsForType<Position>()[torpedo]);
+    SoundPlayer::shared()->playExplosionSoundEffect();
 }
 
 ///
-/// Called when an explosion collides with store icon
+/// [Handler] Called when an explosion collides with a store icon
 ///
-/// @param storeIcons Identifiers of store icons that will be destroyed by the bomb
-/// @note This delegate method enables the collision handling for chaining explosions on store icons.
+/// @param storeIcon The identifier of the store icon hit by the explosion
 ///
-void StageController::explosionDidCollideWithStoreIcons(std::vector<Entity::Identifier> storeIcons) {
-    auto storeArr = this->entityManager->componentsForType<Store>(); // Get all entities with store components
-
-    for (auto it = storeIcons.begin(); it != storeIcons.end(); ++it) {
-        switch(storeArr[*it].type) {
-            case Store::sType::boatMissile :
-                playerDidBuyMissile();
-                break;
-            case Store::sType::life :
-                playerDidBuyLife();
-                break;
-            case Store::sType::end :
-                playerDidExitStore();
-                break;
-            default:
-                break;
-        }
+void StageController::handleExplosionDidCollideWithStoreIcon(Entity::Identifier storeIcon) {
+    switch(this->entityManager->componentsForType<Store>()[storeIcon].type) {
+        case Store::sType::boatMissile :
+            playerDidBuyMissile();
+            break;
+        case Store::sType::life :
+            playerDidBuyLife();
+            break;
+        case Store::sType::end :
+            playerDidExitStore();
+            break;
+        default:
+            break;
     }
 }
 
@@ -845,30 +1150,36 @@ void StageController::explosionDidCollideWithStoreIcons(std::vector<Entity::Iden
 //
 
 ///
-/// Called when a torpedo collides with the player boat
+/// [Handler] Called when a torpedo collides with the player boat
 ///
 /// @param torpedo The identifier of the torpedo that collides with the player boat
 /// @param boat The identifier of the player boat
 ///
-void StageController::torpedoDidCollideWithBoat(Entity::Identifier torpedo, Entity::Identifier boat)
+void StageController::handleTorpedoDidCollideWithBoat(Entity::Identifier torpedo, Entity::Identifier boat)
 {
-    // Remove the torpedoes
-    this->rmtorpedoes.insert(torpedo);
+    // Guard: The torpedo may have been destroyed by an explosion in this update session
+    if (!this->markForRemoval(RemovalKind::Torpedo, torpedo))
+    {
+        return;
+    }
     
     // Call the common helper method
     this->projectileDidCollideWithBoat(boat);
 }
 
 ///
-/// Called when a missile collides with the player boat
+/// [Handler] Called when a missile collides with the player boat
 ///
 /// @param missile The identifier of the missile that collides with the player boat
 /// @param boat The identifier of the player boat
 ///
-void StageController::missileDidCollideWithBoat(Entity::Identifier missile, Entity::Identifier boat)
+void StageController::handleMissileDidCollideWithBoat(Entity::Identifier missile, Entity::Identifier boat)
 {
-    // Remove the missiles
-    this->rmmissiles.insert(missile);
+    // Guard: The missile may have been destroyed by an explosion in this update session
+    if (!this->markForRemoval(RemovalKind::Missile, missile))
+    {
+        return;
+    }
     
     // Call the common helper method
     this->projectileDidCollideWithBoat(boat);
@@ -887,6 +1198,12 @@ void StageController::projectileDidCollideWithBoat(Entity::Identifier boat)
     // Play the explosion sound effect
     psoftassert(SoundPlayer::shared()->playExplosionSoundEffect(), "Failed to play the explosion sound effect.");
     
+    // The player boat is invulnerable during a soak test so that it can run unattended
+    if (soakMode)
+    {
+        return;
+    }
+
     // Set the player boat destroyed
     // No need to worry about the rest of lives, resetting the stage, updating the label, etc.
     // as these will be handled by the PlayerDelegate (i.e. delegate chaining)
@@ -898,60 +1215,61 @@ void StageController::projectileDidCollideWithBoat(Entity::Identifier boat)
 //
 
 ///
-/// Called when a submarine did move out of screen
+/// [Handler] Called when a submarine did move out of screen
 ///
 /// @param submarine The identifier of the submarine that collides with the left/right screen boundary
 ///
-void StageController::submarineDidMoveOutOfScreen(Entity::Identifier submarine)
+void StageController::handleSubmarineDidMoveOutOfScreen(Entity::Identifier submarine)
 {
     // Just remove the submarine; No need to update the score in this case
-    this->rmsubmarines.insert(submarine);
+    this->markForRemoval(RemovalKind::Submarine, submarine);
 }
 
 ///
-/// Called when a bomb did move out of screen
+/// [Handler] Called when a bomb did move out of screen
 ///
 /// @param bomb The identifier of the bomb that collides with the screen bottom
 ///
-void StageController::bombDidMoveOutOfScreen(Entity::Identifier bomb)
+void StageController::handleBombDidMoveOutOfScreen(Entity::Identifier bomb)
 {
     // Just remove the bomb; No need to update the score in this case
-    this->rmbombs.insert(bomb);
-    
-    this->player->incrementNumAvailableBombs();
+    if (this->markForRemoval(RemovalKind::Bomb, bomb))
+    {
+        this->player->incrementNumAvailableBombs();
+    }
 }
 
 ///
-/// Called when a missile did move out of screen
+/// [Handler] Called when a missile did move out of screen
 ///
 /// @param missile The identifier of the missile that collides with the screen top
 ///
-void StageController::missileDidMoveOutOfScreen(Entity::Identifier missile)
+void StageController::handleMissileDidMoveOutOfScreen(Entity::Identifier missile)
 {
     // Just remove the missile; No need to reset the player boat
-    this->rmmissiles.insert(missile);
+    this->markForRemoval(RemovalKind::Missile, missile);
 }
 
 ///
-/// Called when a torpedo did move out of the ocean surface
+/// [Handler] Called when a torpedo did move out of the ocean surface
 ///
 /// @param torpedo The identifier of the torpedo that collides with the water surface
 ///
-void StageController::torpedoDidMoveOutOfOceanSurface(Entity::Identifier torpedo)
+void StageController::handleTorpedoDidMoveOutOfOceanSurface(Entity::Identifier torpedo)
 {
     // Just remove the torpedo No need to reset the player boat
-    this->rmtorpedoes.insert(torpedo);
+    this->markForRemoval(RemovalKind::Torpedo, torpedo);
 }
 
 ///
-/// Called when a smoke moves out of screen
+/// [Handler] Called when a smoke moves out of screen
 ///
-/// @param smoke The identifier of the torpedo that with top of screen
+/// @param smoke The identifier of the smoke that leaves the screen
 ///
-void StageController::smokeDidMoveOutOfScreen(Entity::Identifier smoke)
+void StageController::handleSmokeDidMoveOutOfScreen(Entity::Identifier smoke)
 {
-    // Just remove the torpedo No need to reset the player boat
-    this->rmsmoke.insert(smoke);
+    // Just remove the smoke
+    this->markForRemoval(RemovalKind::Smoke, smoke);
 }
 
 ///
@@ -959,24 +1277,59 @@ void StageController::smokeDidMoveOutOfScreen(Entity::Identifier smoke)
 ///
 void StageController::endUpdates()
 {
-    if(!this->entityManager->checkIfGameOver())
+    // Handle the collisions reported through the per-scenario callbacks
+    if (this->collisionEvents.size() > 0)
     {
-        // Remove those entities from the entity manager
-        std::for_each(this->rmbombs.begin(), this->rmbombs.end(), [this] (auto& id) { this->entityManager->removeBomb(id); });
+        this->handleCollisionEvents(this->collisionEvents);
 
-        std::for_each(this->rmboatmissiles.begin(), this->rmboatmissiles.end(), [this] (auto& id) { this->entityManager->removeBoatMissile(id); });
+        this->collisionEvents.clear();
+    }
 
-        std::for_each(this->rmmissiles.begin(), this->rmmissiles.end(), [this] (auto& id) { this->entityManager->removeMissile(id); });
-    
-        std::for_each(this->rmtorpedoes.begin(), this->rmtorpedoes.end(), [this] (auto& id) { this->entityManager->removeTorpedo(id); });
-    
-        std::for_each(this->rmsubmarines.begin(), this->rmsubmarines.end(), [this] (auto& id) { this->entityManager->removeSubmarine(id);
-                                                                                                            subsDead += 1; });
+    // Guard: The game over screen keeps the entities
+    if (this->entityManager->checkIfGameOver())
+    {
+        return;
+    }
 
-        std::for_each(this->rmfishes.begin(), this->rmfishes.end(), [this] (auto& id) { this->entityManager->removeFish(id);
-                                                                                                                    fishCount -= 1;});
+    // Remove the marked entities from the entity manager
+    for (const auto& removal : this->removals)
+    {
+        switch (removal.kind)
+        {
+            case RemovalKind::Bomb:
+                this->entityManager->removeBomb(removal.identifier);
+                break;
 
-        std::for_each(this->rmsmoke.begin(), this->rmsmoke.end(),[this](auto& id) {    this->entityManager->removeSmoke(id); });
+            case RemovalKind::BoatMissile:
+                this->entityManager->removeBoatMissile(removal.identifier);
+                break;
+
+            case RemovalKind::Missile:
+                this->entityManager->removeMissile(removal.identifier);
+                break;
+
+            case RemovalKind::Torpedo:
+                this->entityManager->removeTorpedo(removal.identifier);
+                break;
+
+            case RemovalKind::Submarine:
+                this->entityManager->removeSubmarine(removal.identifier);
+                subsDead += 1;
+                break;
+
+            case RemovalKind::Fish:
+                this->entityManager->removeFish(removal.identifier);
+                fishCount -= 1;
+                break;
+
+            case RemovalKind::Smoke:
+                this->entityManager->removeSmoke(removal.identifier);
+                break;
+
+            default:
+                pserror("[Fatal] Unimplemented switch case.");
+                break;
+        }
     }
 }
 
@@ -1084,7 +1437,7 @@ void StageController::enterTutorial()
     
     // Add enemy descriptions
     pos = {200,240};
-    this->entityManager->makeStringLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 24, "ENEMYS");
+    this->entityManager->makeTextLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 24, "ENEMYS");
     
     pos = {235,300};
     this->entityManager->makeSubmarine(this->entityManager->tutorialSub, pos, Direction::Right, 0, Submarine::Type::I, 0);
@@ -1096,7 +1449,7 @@ void StageController::enterTutorial()
     
     // Add attack descriptions
     pos = {587,240};
-    this->entityManager->makeStringLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 24, "DEFENCES");
+    this->entityManager->makeTextLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 24, "DEFENCES");
     
     pos = {640,300};
     this->entityManager->makeBomb(this->entityManager->tutorialBomb, pos, {0,0});
@@ -1108,7 +1461,7 @@ void StageController::enterTutorial()
     
     // TODO: Add other attack descriptions
     pos = {970,240};
-    this->entityManager->makeStringLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 24, "ATTACKERS");
+    this->entityManager->makeTextLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 24, "ATTACKERS");
     
     pos = {1030,300};
     this->entityManager->makeTorpedo(this->entityManager->tutorialTorpedo, pos, {0,0});
@@ -1120,7 +1473,7 @@ void StageController::enterTutorial()
     
     // TODO: Add a start button
     pos = {435,570};
-    this->entityManager->makeStringLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 50, "CLICK TO START");
+    this->entityManager->makeTextLabel(tutorialTextArray[i++], pos, Character::Font::SFMonoRegular, Color::black, 50, "CLICK TO START");
 }
 
 void StageController::exitTutorial()
@@ -1128,12 +1481,9 @@ void StageController::exitTutorial()
     if(tutorialActive)
     {
         // Remove all tutorial items on screen
-        for(StringLabel sl: tutorialTextArray)
+        for(TextRenderer::Label& label: tutorialTextArray)
         {
-            for(int c: sl.getIdentifiers())
-            {
-                this->entityManager->removeCharacter(c);
-            }
+            this->entityManager->removeTextLabel(label);
         }
         this->entityManager->removeSubmarine(this->entityManager->tutorialSub.getIdentifier());
         this->entityManager->removeFish(this->entityManager->tutorialFish.getIdentifier());
@@ -1150,3 +1500,113 @@ void StageController::exitTutorial()
         this->nextStage();
     }
 }
+
+///
+/// Start a soak test that loops all stages unattended
+///
+void StageController::enterSoak()
+{
+    soakMode = true;
+
+    this->signalGameActive(true);
+    this->currentStageNumber = -1;
+    entityManager->resetGame();
+    this->nextStage();
+}
+
+///
+/// [Private Helper] Mark an entity to be removed at the end of the update session
+///
+/// @param kind The kind of the entity
+/// @param identifier The entity identifier
+/// @return `true` if the entity is newly marked, `false` if it has been marked already in this update session.
+///
+bool StageController::markForRemoval(RemovalKind kind, Entity::Identifier identifier)
+{
+    // Guard: Each entity is removed once
+    if (this->removalMarks.test(identifier))
+    {
+        return false;
+    }
+
+    this->removalMarks.set(identifier);
+
+    this->removals.push_back({kind, identifier});
+
+    return true;
+}
+
+///
+/// [Private Helper] Spawn a wave of submarines and fish
+///
+void StageController::spawnWave()
+{
+    SW_TRACE_SCOPE("StageController::spawnWave", "spawn");
+
+    // Spawn submarines of each type that must be spawned
+    if (this->resSubCounts[Submarine::Type::I] > 0) { // Spawn type I submarines
+        this->spawnSubmarinesInWave(Submarine::Type::I);
+    }
+    if (this->resSubCounts[Submarine::Type::II] > 0) { // Spawn type II submarines
+        this->spawnSubmarinesInWave(Submarine::Type::II);
+    }
+    if (this->resSubCounts[Submarine::Type::III] > 0) { // Spawn type III submarines
+        this->spawnSubmarinesInWave(Submarine::Type::III);
+    }
+    if (this->resFishCount > 0 && fishCount <= totalFish) { // Spawn a fish
+        spawnFish();
+        this->resFishCount -= 1;
+        fishCount += 1; // Inc by 1
+    }
+}
+
+///
+/// [Private Helper] Restart the spawn and smoke timers of the current stage
+///
+/// @param spawnDelay The delay of the first spawn wave in milliseconds; 0 spawns it on the next tick
+/// @param smokeDelay The delay of the first smoke in milliseconds
+///
+void StageController::scheduleStageTimers(float spawnDelay, float smokeDelay)
+{
+    this->timers.cancel(this->spawnTimer);
+
+    this->timers.cancel(this->smokeTimer);
+
+    TimerWheel::Callback spawnCallback = [](int identifier, void* userptr)
+    {
+        reinterpret_cast<StageController*>(userptr)->spawnWave();
+    };
+
+    this->spawnTimer = this->timers.schedule(spawnDelay, spawnCallback, 0, this, betweenSpawns);
+
+    TimerWheel::Callback smokeCallback = [](int identifier, void* userptr)
+    {
+        auto controller = reinterpret_cast<StageController*>(userptr);
+
+        if (controller->gameIsActive)
+        {
+            controller->spawnSmoke();
+        }
+    };
+
+    this->smokeTimer = this->timers.schedule(smokeDelay, smokeCallback, 0, this, betweenSmokeSpawns);
+}
+
+///
+/// [Private Helper] Spawn submarines of the given type as part of a spawn wave
+///
+/// @param type The submarine type
+/// @note A submarine that cannot be spawned, e.g. because no free identifier is left,
+///       is counted as dead so that the stage can still be cleared.
+///
+void StageController::spawnSubmarinesInWave(Submarine::Type type)
+{
+    for (uint32_t index = 0; index < spawnWaveSize && this->resSubCounts[type] > 0; index++) {
+        this->resSubCounts[type] -= 1; // Dec by 1
+
+        if (spawnSubmarine(type) == 0) {
+            subsDead += 1;
+            numFailedSpawns += 1;
+        }
+    }
+}
@@ -10,6 +10,7 @@
 #define StageController_hpp
 
 #include "Foundations/Foundations.hpp"
+#include "Foundations/TimerWheel.hpp"
 #include "Entities/Entities.hpp"
 #include "Components/Components.hpp"
 #include "Components/PlayerDelegate.hpp"
@@ -24,7 +25,8 @@
 #include <SDL_mixer.h>
 
 #include <unordered_map>
-#include <unordered_set>
+#include <bitset>
+#include <vector>
 
 /// StageController manages game stages and related control data
 /// It also acts as an entity spawner to spawn entities based on control data of each stage
@@ -170,6 +172,48 @@ public:
     void saveGame(SC_SaveGameData* data);
     bool loadGame(SC_SaveGameData data);
 
+    /// An in-memory snapshot of the stage progress
+    struct SC_Snapshot
+    {
+        /// The stage, the residual submarines, the score, the money and the lives
+        SC_SaveGameData progress;
+
+        /// The residual number of fish to be spawned
+        uint32_t resFishCount;
+
+        /// The number of fish on stage
+        int fishCount;
+
+        /// The time left until the next spawn wave in milliseconds
+        float spawnDelay;
+
+        /// The time left until the next smoke in milliseconds
+        float smokeDelay;
+    };
+
+    ///
+    /// Check whether the current state can be captured by a snapshot
+    ///
+    /// @return `true` if a normal stage is being played, `false` on menu screens and in stores.
+    ///
+    bool canTakeSnapshot();
+
+    ///
+    /// Capture the stage progress
+    ///
+    /// @param snapshot The snapshot to overwrite
+    ///
+    void takeSnapshot(SC_Snapshot* snapshot);
+
+    ///
+    /// Restore the stage progress from a snapshot
+    ///
+    /// @param snapshot A snapshot taken by `takeSnapshot()`
+    /// @return `true` on success, `false` otherwise.
+    /// @note The spawn and smoke timers resume with the time that was left when the snapshot was taken.
+    ///
+    bool restoreSnapshot(const SC_Snapshot& snapshot);
+
     ///
     /// [Convenient] Spawn smoke at boat position
     ///
@@ -215,6 +259,29 @@ public:
     ///
     void exitTutorial();
 
+    ///
+    /// Start a soak test that loops all stages unattended
+    ///
+    /// @note The player boat is invulnerable and stores are skipped during a soak test.
+    ///
+    void enterSoak();
+
+    ///
+    /// [FAST] Get the current stage number; -1 if not started
+    ///
+    inline int getCurrentStageNumber()
+    {
+        return this->currentStageNumber;
+    }
+
+    ///
+    /// [FAST] Get the number of submarines that could not be spawned so far
+    ///
+    inline uint32_t getNumFailedSpawns()
+    {
+        return this->numFailedSpawns;
+    }
+
 private:
     /// The total number of stages in this game
     static constexpr int TOTAL_NUM_STAGES = 26;
@@ -225,6 +292,12 @@ private:
     bool gameIsActive = false;
     
     bool tutorialActive = false;
+
+    /// Indicates a soak test is running
+    bool soakMode = false;
+
+    /// The number of submarines that could not be spawned so far
+    uint32_t numFailedSpawns = 0;
     
     /// A reference to the entity manager to make entities
     EntityManager* entityManager;
@@ -239,7 +312,7 @@ private:
     Random<int> drandom;
 
     /// An array of texts that can be displayed during the tutorial
-    StringLabel tutorialTextArray[5];
+    TextRenderer::Label tutorialTextArray[5] = {};
 
     /// Random number generators to determine the submarine velocity
     std::unordered_map<Submarine::Type, Random<float>> vrandoms;
@@ -265,37 +338,57 @@ private:
     /// The stage type of this stage
     int stageType;
 
-    /// Record identifiers of bombs to be removed due to detected collisions
-    std::unordered_set<Entity::Identifier> rmbombs;
-    
-    /// Record identifiers of submarines to be removed due to detected collisions
-    std::unordered_set<Entity::Identifier> rmsubmarines;
+    /// Kinds of entities removed due to detected collisions
+    enum class RemovalKind: uint8_t
+    {
+        Bomb,
 
-    /// Record identifiers of fish to be removed due to detected collisions
-    std::unordered_set<Entity::Identifier> rmfishes;
-    
-    /// Record identifiers of torpedoes to be removed due to detected collisions
-    std::unordered_set<Entity::Identifier> rmtorpedoes;
-    
-    /// Record identifiers of missiles to be removed due to detected collisions
-    std::unordered_set<Entity::Identifier> rmmissiles;
+        BoatMissile,
+
+        Missile,
 
-    /// Record identifiers of boat missiles to be removed due to exploding
-    std::unordered_set<Entity::Identifier> rmboatmissiles;
+        Torpedo,
 
-    /// Record identifiers of smoke to be removed due to detected collisions
-    std::unordered_set<Entity::Identifier> rmsmoke;
+        Submarine,
 
-    /// Time since last sub spawn
-    float sinceSpawn;
+        Fish,
+
+        Smoke
+    };
+
+    /// An entity to be removed at the end of the update session
+    struct Removal
+    {
+        RemovalKind kind;
+
+        Entity::Identifier identifier;
+    };
+
+    /// Marks the entities to be removed at the end of the update session, indexed by their identifiers
+    std::bitset<EntityManager::MAX_NUM_ON_SCREEN_ENTITIES> removalMarks;
+
+    /// Entities to be removed at the end of the update session in the order they were marked
+    std::vector<Removal> removals;
+
+    /// Collisions reported through the per-scenario callbacks in this update session
+    CollisionEventBuffer collisionEvents;
+
+    /// Timers of the current stage on the simulation clock
+    TimerWheel timers;
+
+    /// The timer that spawns submarine waves
+    TimerWheel::Handle spawnTimer;
+
+    /// The timer that spawns smoke
+    TimerWheel::Handle smokeTimer;
 
     /// Time between sub spawns
     float betweenSpawns;
 
-    /// Time since last sub spawn
-    float sinceSmokeSpawn;
+    /// The maximum number of submarines of each type in a spawn wave
+    uint32_t spawnWaveSize;
 
-    /// Time between sub spawns
+    /// Time between smoke spawns
     float betweenSmokeSpawns;
 
     /// Total number of submarines in the stage
@@ -349,6 +442,36 @@ private:
     /// @return The ID of the new submarine
     ///
     Entity::Identifier spawnSubIIIHelper(Position pos, Direction dir);
+
+    ///
+    /// Helper to spawn submarines of the given type as part of a spawn wave
+    ///
+    /// @param type The submarine type
+    /// @note A submarine that cannot be spawned is counted as dead so that the stage can still be cleared.
+    ///
+    void spawnSubmarinesInWave(Submarine::Type type);
+
+    ///
+    /// Helper to spawn a wave of submarines and fish
+    ///
+    void spawnWave();
+
+    ///
+    /// Helper to restart the spawn and smoke timers of the current stage
+    ///
+    /// @param spawnDelay The delay of the first spawn wave in milliseconds; 0 spawns it on the next tick
+    /// @param smokeDelay The delay of the first smoke in milliseconds
+    ///
+    void scheduleStageTimers(float spawnDelay, float smokeDelay);
+
+    ///
+    /// Helper to mark an entity to be removed at the end of the update session
+    ///
+    /// @param kind The kind of the entity
+    /// @param identifier The entity identifier
+    /// @return `true` if the entity is newly marked, `false` if it has been marked already in this update session.
+    ///
+    bool markForRemoval(RemovalKind kind, Entity::Identifier identifier);
     
     ///
     /// Return `true` if there is a next stage
@@ -375,63 +498,146 @@ private:
     ///
     void beginUpdates() override;
     
+    ///
+    /// Called with all collisions found by the collision system in this update session
+    ///
+    /// @param events The collision events in the order they were detected
+    ///
+    void handleCollisionEvents(const CollisionEventBuffer& events) override;
+
+    //
+    // MARK: Per-scenario callbacks
+    // Each callback only appends an event to `collisionEvents`, which is handled as one batch in `endUpdates()`.
+    //
+
+    ///
+    /// Called when a bomb collides with a destroyable entity and consequently causes an explosion
+    ///
+    void bombDidGenerateExplosion(Entity::Identifier bomb) override;
+
+    ///
+    /// Called when a boat missile reaches the end of its path and consequently causes an explosion
+    ///
+    void boatMissileDidGenerateExplosion(Entity::Identifier boatMissile) override;
+
+    ///
+    /// Called when an explosion collides with submarines
+    ///
+    void explosionDidCollideWithSubmarines(const std::vector<Entity::Identifier>& submarines) override;
+
+    ///
+    /// Called when an explosion collides with fish
+    ///
+    void explosionDidCollideWithFishes(const std::vector<Entity::Identifier>& fishes) override;
+
+    ///
+    /// Called when an explosion collides with missiles
+    ///
+    void explosionDidCollideWithMissiles(const std::vector<Entity::Identifier>& missiles) override;
+
+    ///
+    /// Called when an explosion collides with torpedoes
+    ///
+    void explosionDidCollideWithTorpedoes(const std::vector<Entity::Identifier>& torpedoes) override;
+
+    ///
+    /// Called when an explosion collides with store icons
+    ///
+    void explosionDidCollideWithStoreIcons(const std::vector<Entity::Identifier>& storeIcons) override;
+
+    ///
+    /// Called when a torpedo collides with the player boat
+    ///
+    void torpedoDidCollideWithBoat(Entity::Identifier torpedo, Entity::Identifier boat) override;
+
+    ///
+    /// Called when a missile collides with the player boat
+    ///
+    void missileDidCollideWithBoat(Entity::Identifier missile, Entity::Identifier boat) override;
+
+    ///
+    /// Called when a submarine did move out of screen
+    ///
+    void submarineDidMoveOutOfScreen(Entity::Identifier submarine) override;
+
+    ///
+    /// Called when a bomb did move out of screen
+    ///
+    void bombDidMoveOutOfScreen(Entity::Identifier bomb) override;
+
+    ///
+    /// Called when a missile did move out of screen
+    ///
+    void missileDidMoveOutOfScreen(Entity::Identifier missile) override;
+
+    ///
+    /// Called when a torpedo did move out of the ocean surface
+    ///
+    void torpedoDidMoveOutOfOceanSurface(Entity::Identifier torpedo) override;
+
+    ///
+    /// Called when smoke moves above top of screen
+    ///
+    void smokeDidMoveOutOfScreen(Entity::Identifier smoke) override;
+
     //
     // MARK: Player attacks enemies and fishes
     //
     
     ///
-    /// Called when a bomb collides with a destroyable entity and consequently causes an explosion
+    /// [Handler] Called when a bomb collides with a destroyable entity and consequently causes an explosion
     ///
     /// @param bomb The identifier of the bomb that collides with a submarine
     ///
-    void bombDidGenerateExplosion(Entity::Identifier bomb) override;
+    void handleBombDidGenerateExplosion(Entity::Identifier bomb);
 
     ///
-    /// Called when a boat missile reaches the end of its path and consequently causes an explosion
+    /// [Handler] Called when a boat missile reaches the end of its path and consequently causes an explosion
     ///
     /// @param boatMissile The identifier of the boat missile that's exploding
     ///
-    void boatMissileDidGenerateExplosion(Entity::Identifier boatMissile) override;
+    void handleBoatMissileDidGenerateExplosion(Entity::Identifier boatMissile);
     
     ///
-    /// Called when an explosion collides with submarines
+    /// [Handler] Called when an explosion collides with a submarine
     ///
-    /// @param submarines Identifiers of submarines that will be destroyed by the bomb
-    /// @note This delegate method enables the collision handling for chaining explosions on submarines.
+    /// @param submarine The identifier of the submarine that will be destroyed by the explosion
+    /// @return `true` if the player score changed, `false` otherwise.
+    /// @note This handler enables the collision handling for chaining explosions on submarines.
     ///
-    void explosionDidCollideWithSubmarines(std::vector<Entity::Identifier> submarines) override;
+    bool handleExplosionDidCollideWithSubmarine(Entity::Identifier submarine);
     
     ///
-    /// Called when an explosion collides with fish
+    /// [Handler] Called when an explosion collides with a fish
     ///
-    /// @param fishes Identifiers of fishes that will be destroyed by the bomb
-    /// @note This delegate method enables the collision handling for chaining explosions on fishes.
+    /// @param fish The identifier of the fish that will be destroyed by the explosion
+    /// @return `true` if the player score changed, `false` otherwise.
+    /// @note This handler enables the collision handling for chaining explosions on fishes.
     ///
-    void explosionDidCollideWithFishes(std::vector<Entity::Identifier> fishes) override;
+    bool handleExplosionDidCollideWithFish(Entity::Identifier fish);
 
     ///
-    /// Called when an explosion collides with missile
+    /// [Handler] Called when an explosion collides with a missile
     ///
-    /// @param missiles Identifiers of missiles that will be destroyed by the bomb
-    /// @note This delegate method enables the collision handling for chaining explosions on missiles.
+    /// @param missile The identifier of the missile that will be destroyed by the explosion
+    /// @note This handler enables the collision handling for chaining explosions on missiles.
     ///
-    void explosionDidCollideWithMissiles(std::vector<Entity::Identifier> missiles) override;
+    void handleExplosionDidCollideWithMissile(Entity::Identifier missile);
 
     ///
-    /// Called when an explosion collides with torpedo
+    /// [Handler] Called when an explosion collides with a torpedo
     ///
-    /// @param torpedoes Identifiers of torpedoes that will be destroyed by the bomb
-    /// @note This delegate method enables the collision handling for chaining explosions on torpedoes.
+    /// @param torpedo The identifier of the torpedo that will be destroyed by the explosion
+    /// @note This handler enables the collision handling for chaining explosions on torpedoes.
     ///
-    void explosionDidCollideWithTorpedoes(std::vector<Entity::Identifier> torpedoes) override;
+    void handleExplosionDidCollideWithTorpedo(Entity::Identifier torpedo);
 
     ///
-    /// Called when an explosion collides with store icon
+    /// [Handler] Called when an explosion collides with a store icon
     ///
-    /// @param storeIcons Identifiers of store icons that will be destroyed by the bomb
-    /// @note This delegate method enables the collision handling for chaining explosions on store icons.
+    /// @param storeIcon The identifier of the store icon hit by the explosion
     ///
-    void explosionDidCollideWithStoreIcons(std::vector<Entity::Identifier> storeIcons) override;
+    void handleExplosionDidCollideWithStoreIcon(Entity::Identifier storeIcon);
 
 
     //
@@ -439,20 +645,20 @@ private:
     //
     
     ///
-    /// Called when a torpedo collides with the player boat
+    /// [Handler] Called when a torpedo collides with the player boat
     ///
     /// @param torpedo The identifier of the torpedo that collides with the player boat
     /// @param boat The identifier of the player boat
     ///
-    void torpedoDidCollideWithBoat(Entity::Identifier torpedo, Entity::Identifier boat) override;
+    void handleTorpedoDidCollideWithBoat(Entity::Identifier torpedo, Entity::Identifier boat);
     
     ///
-    /// Called when a missile collides with the player boat
+    /// [Handler] Called when a missile collides with the player boat
     ///
     /// @param missile The identifier of the missile that collides with the player boat
     /// @param boat The identifier of the player boat
     ///
-    void missileDidCollideWithBoat(Entity::Identifier missile, Entity::Identifier boat) override;
+    void handleMissileDidCollideWithBoat(Entity::Identifier missile, Entity::Identifier boat);
     
     ///
     /// [Private Helper] Called when the enemy projectile collides with the player boat
@@ -466,39 +672,39 @@ private:
     //
     
     ///
-    /// Called when a submarine did move out of screen
+    /// [Handler] Called when a submarine did move out of screen
     ///
     /// @param submarine The identifier of the submarine that collides with the left/right screen boundary
     ///
-    void submarineDidMoveOutOfScreen(Entity::Identifier submarine) override;
+    void handleSubmarineDidMoveOutOfScreen(Entity::Identifier submarine);
     
     ///
-    /// Called when a bomb did move out of screen
+    /// [Handler] Called when a bomb did move out of screen
     ///
     /// @param bomb The identifier of the bomb that collides with the screen bottom
     ///
-    void bombDidMoveOutOfScreen(Entity::Identifier bomb) override;
+    void handleBombDidMoveOutOfScreen(Entity::Identifier bomb);
     
     ///
-    /// Called when a missile did move out of screen
+    /// [Handler] Called when a missile did move out of screen
     ///
     /// @param missile The identifier of the missile that collides with the screen top
     ///
-    void missileDidMoveOutOfScreen(Entity::Identifier missile) override;
+    void handleMissileDidMoveOutOfScreen(Entity::Identifier missile);
     
     ///
-    /// Called when a torpedo did move out of the ocean surface
+    /// [Handler] Called when a torpedo did move out of the ocean surface
     ///
     /// @param torpedo The identifier of the torpedo that collides with the water surface
     ///
-    void torpedoDidMoveOutOfOceanSurface(Entity::Identifier torpedo) override;
+    void handleTorpedoDidMoveOutOfOceanSurface(Entity::Identifier torpedo);
 
     ///
-    /// Called when smoke moves out of screen
+    /// [Handler] Called when smoke moves out of screen
     ///
     /// @param smoke The identifier of the smoke that leaves the screen
     ///
-    void smokeDidMoveOutOfScreen(Entity::Identifier smoke) override;
+    void handleSmokeDidMoveOutOfScreen(Entity::Identifier smoke);
     
     ///
     /// Called when the collision system finishes finding all collisions
@@ -0,0 +1,155 @@
+//
+//  StageGenerator.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-07.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "StageGenerator.hpp"
+#include "StageController.hpp"
+#include "Foundations/JSON.hpp"
+#include "Foundations/Debug.hpp"
+#include <fstream>
+#include <math.h>
+
+using JSON = nlohmann::json;
+
+///
+/// Get the default parameters
+///
+/// @return Parameters that generate as many stages as the game has, with modest counts.
+///
+StageGenerator::Parameters StageGenerator::defaultParameters()
+{
+    Parameters parameters;
+
+    // Stage 0 to the last stage the stage controller can load
+    parameters.numStages = StageController::TOTAL_NUM_STAGES + 1;
+
+    for (auto& type : Submarine::allTypes)
+    {
+        parameters.subcounts[type] = 0;
+    }
+
+    parameters.subcounts[Submarine::Type::I] = 100;
+
+    parameters.subcounts[Submarine::Type::II] = 100;
+
+    parameters.subcounts[Submarine::Type::III] = 100;
+
+    parameters.fishcount = 100;
+
+    parameters.spawnInterval = Stage::DEF_SPAWN_INTERVAL;
+
+    parameters.spawnWaveSize = Stage::DEF_SPAWN_WAVE_SIZE;
+
+    parameters.subvrange = Range<float>(50.f, 150.f);
+
+    parameters.subyrange = Range<float>(250.f, 680.f);
+
+    parameters.subrrrange = Range<float>(200.f, 600.f);
+
+    parameters.current = {0, 0};
+
+    return parameters;
+}
+
+///
+/// Generate stage files in the given directory
+///
+/// @param directory An existing directory to which stage files are written
+/// @param parameters The parameters of the generated stages
+/// @return `true` on success, `false` otherwise.
+/// @note Stage `n` of `N` gets `(n + 1) / N` of the given submarine and fish counts,
+///       so that a soak test over the generated stages shows where the engine stops scaling.
+/// @note The number of stages is clamped to the number of stages the stage controller can load.
+///
+bool StageGenerator::generate(const char* directory, const Parameters& parameters)
+{
+    char path[1024];
+
+    char keybuf[64];
+
+    uint32_t numStages = parameters.numStages;
+
+    // Guard: The stage controller caches a fixed number of stages, so any stage beyond them could never be loaded
+    if (numStages > StageController::TOTAL_NUM_STAGES + 1)
+    {
+        numStages = StageController::TOTAL_NUM_STAGES + 1;
+
+        pwarning("The game loads at most %u stages. Generating %u stages instead of %u.", numStages, numStages, parameters.numStages);
+    }
+
+    for (uint32_t number = 0; number < numStages; number++)
+    {
+        float ratio = (float) (number + 1) / numStages;
+
+        // A convenient lambda function that takes the coding key and submarine type, and returns the key string
+        auto key = [&keybuf] (Stage::Keys::Key key, Submarine::Type type) -> const char*
+        {
+            Stage::Keys::get(keybuf, size(keybuf), key, type);
+
+            return keybuf;
+        };
+
+        JSON object;
+
+        uint32_t numEntities = 0;
+
+        for (auto& type : Submarine::allTypes)
+        {
+            auto iterator = parameters.subcounts.find(type);
+
+            uint32_t count = iterator == parameters.subcounts.end() ? 0 : (uint32_t) ceilf(iterator->second * ratio);
+
+            object[key(Stage::Keys::SubVelRangeLower, type)] = parameters.subvrange.lower;
+
+            object[key(Stage::Keys::SubVelRangeUpper, type)] = parameters.subvrange.upper;
+
+            object[key(Stage::Keys::SubYcoordLower, type)] = parameters.subyrange.lower;
+
+            object[key(Stage::Keys::SubYcoordUpper, type)] = parameters.subyrange.upper;
+
+            object[key(Stage::Keys::SubRadarRadiusRangeLower, type)] = parameters.subrrrange.lower;
+
+            object[key(Stage::Keys::SubRadarRadiusRangeUpper, type)] = parameters.subrrrange.upper;
+
+            object[key(Stage::Keys::SubCountLimit, type)] = count;
+
+            numEntities += count;
+        }
+
+        uint32_t fishcount = (uint32_t) ceilf(parameters.fishcount * ratio);
+
+        object[key(Stage::Keys::FishCount, Submarine::Type::I)] = fishcount;
+
+        object[key(Stage::Keys::CurrVec, Submarine::Type::I)] = parameters.current.x;
+
+        object[key(Stage::Keys::CurrVec, Submarine::Type::II)] = parameters.current.y;
+
+        // Generated stages are always normal stages
+        object[key(Stage::Keys::StageType, Submarine::Type::I)] = 0;
+
+        object[key(Stage::Keys::SpawnInterval, Submarine::Type::I)] = parameters.spawnInterval;
+
+        object[key(Stage::Keys::SpawnWaveSize, Submarine::Type::I)] = parameters.spawnWaveSize;
+
+        snprintf(path, sizeof(path), "%s/Stage%d.json", directory, number);
+
+        std::ofstream sfile(path);
+
+        if (!sfile.good())
+        {
+            pserror("Failed to create the stage file %s.", path);
+
+            return false;
+        }
+
+        sfile << object.dump(4) << std::endl;
+
+        pinfo("Generated stage #%d with %u submarines and %u fish.", number, numEntities, fishcount);
+    }
+
+    return true;
+}
@@ -0,0 +1,72 @@
+//
+//  StageGenerator.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-07.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef StageGenerator_hpp
+#define StageGenerator_hpp
+
+#include "Foundations/Foundations.hpp"
+#include "Entities/Submarine.hpp"
+#include "Stage.hpp"
+#include <unordered_map>
+
+/// Generates synthetic stress stages whose entity counts ramp up from the first stage to the last one
+class StageGenerator
+{
+public:
+    /// Parameters of the generated stages
+    struct Parameters
+    {
+        /// The number of stage files to generate, starting from `Stage0.json`; At most `StageController::TOTAL_NUM_STAGES + 1`.
+        uint32_t numStages;
+
+        /// The number of submarines of each type in the last stage
+        std::unordered_map<Submarine::Type, uint32_t> subcounts;
+
+        /// The number of fish in the last stage
+        uint32_t fishcount;
+
+        /// The interval between two spawn waves in milliseconds
+        float spawnInterval;
+
+        /// The maximum number of submarines of each type in a spawn wave
+        uint32_t spawnWaveSize;
+
+        /// The velocity range of all submarines
+        Range<float> subvrange;
+
+        /// The y-coordinate range of all submarines
+        Range<float> subyrange;
+
+        /// The radar radius range of all submarines
+        Range<float> subrrrange;
+
+        /// The water current of all stages
+        vec2 current;
+    };
+
+    ///
+    /// Get the default parameters
+    ///
+    /// @return Parameters that generate as many stages as the game has, with modest counts.
+    ///
+    static Parameters defaultParameters();
+
+    ///
+    /// Generate stage files in the given directory
+    ///
+    /// @param directory An existing directory to which stage files are written
+    /// @param parameters The parameters of the generated stages
+    /// @return `true` on success, `false` otherwise.
+    /// @note Stage `n` of `N` gets `(n + 1) / N` of the given submarine and fish counts,
+    ///       so that a soak test over the generated stages shows where the engine stops scaling.
+    /// @note The number of stages is clamped to the number of stages the stage controller can load.
+    ///
+    static bool generate(const char* directory, const Parameters& parameters);
+};
+
+#endif /* StageGenerator_hpp */
@@ -0,0 +1,132 @@
+//
+//  CollisionBands.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionBands.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+
+///
+/// Set up the grid and start the worker threads
+///
+/// @param width The width of the covered area
+/// @param height The height of the covered area
+/// @param cellSize The side length of a cell; ideally about the size of a typical collider
+/// @param numThreads The number of threads, including the calling thread; 1 runs everything on the calling thread.
+/// @param capacity The number of colliders to reserve memory for
+/// @return `true` on success, `false` if the given size is invalid.
+///
+bool CollisionBands::init(float width, float height, float cellSize, uint32_t numThreads, uint32_t capacity)
+{
+    // Guard: Initialize the grid
+    if (!this->grid.init(width, height, cellSize, capacity))
+    {
+        return false;
+    }
+
+    this->pool.reset();
+
+    if (numThreads > 1)
+    {
+        this->pool.reset(new WorkerPool(numThreads));
+    }
+
+    this->bands.clear();
+
+    this->bands.resize(this->getNumThreads() == 1 ? 1 : this->getNumThreads() * CollisionBands::NUM_BANDS_PER_THREAD);
+
+    this->collisions.reserve(capacity);
+
+    return true;
+}
+
+///
+/// Find the pairs of colliders whose bounding boxes overlap
+///
+/// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+/// @param count The number of boxes
+/// @return The overlapping pairs in the same order as `CollisionGrid` followed by `CollisionNarrowphase` find them.
+/// @note The returned buffer is reused by the next call.
+///
+const std::vector<CollisionBroadphase::Pair>& CollisionBands::findCollisions(const CollisionBroadphase::AABB* boxes, uint32_t count)
+{
+    this->collisions.clear();
+
+    this->grid.build(boxes, count);
+
+    this->boxes = boxes;
+
+    this->split();
+
+    // Each band writes to its own buffers
+    if (this->pool == nullptr)
+    {
+        this->runBand(0);
+    }
+    else
+    {
+        this->pool->run(static_cast<uint32_t>(this->bands.size()), [this] (uint32_t index) { this->runBand(index); });
+    }
+
+    // Merge the hits in the order of the bands
+    for (const Band& band : this->bands)
+    {
+        this->collisions.insert(this->collisions.end(), band.hits->begin(), band.hits->end());
+    }
+
+    return this->collisions;
+}
+
+///
+/// [Private Helper] Split the cells into bands that hold about the same number of entries
+///
+/// @note The cost of a cell grows with the square of its entries, so the split is a cheap estimate
+///       that keeps a dense cluster from landing in one band together with half of the screen.
+///
+void CollisionBands::split()
+{
+    uint32_t numBands = static_cast<uint32_t>(this->bands.size());
+
+    uint32_t numEntries = this->grid.getNumCellEntries();
+
+    uint32_t cell = 0;
+
+    for (uint32_t index = 0; index < numBands; index++)
+    {
+        Band& band = this->bands[index];
+
+        band.firstCell = cell;
+
+        // The last band always reaches the end of the grid
+        if (index + 1 == numBands)
+        {
+            cell = this->grid.getNumCells();
+        }
+        else
+        {
+            cell = std::max(cell, this->grid.findCellAt(static_cast<uint32_t>(static_cast<uint64_t>(numEntries) * (index + 1) / numBands)));
+        }
+
+        band.endCell = cell;
+    }
+}
+
+///
+/// [Private Helper] Find and test the pairs of the given band
+///
+void CollisionBands::runBand(uint32_t index)
+{
+    SW_TRACE_SCOPE("CollisionBands::runBand", "system");
+
+    Band& band = this->bands[index];
+
+    band.candidates.clear();
+
+    this->grid.findCandidatePairs(band.firstCell, band.endCell, band.candidates);
+
+    band.hits = &band.narrowphase.findCollisions(this->boxes, band.candidates);
+}
@@ -0,0 +1,120 @@
+//
+//  CollisionBands.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionBands_hpp
+#define CollisionBands_hpp
+
+#include "CollisionGrid.hpp"
+#include "CollisionNarrowphase.hpp"
+#include "Foundations/WorkerPool.hpp"
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+/// Finds the overlapping pairs of colliders on several threads
+///
+/// The grid is built on the calling thread, and its cells are then split, row by row, into bands
+/// that hold about the same number of entries.
+/// Each band finds the pairs whose first shared cell lies in the band and tests them in its own narrow phase,
+/// so bands share no output, and a pair that spans two bands is found by exactly one of them.
+/// The hits of the bands are concatenated in the order of the bands,
+/// which is the same order a single thread finds them in, so the collision delegate sees the same events
+/// no matter how many threads are used.
+class CollisionBands
+{
+public:
+    /// The number of bands per thread; More bands than threads let fast threads pick up the slack of busy bands
+    static constexpr uint32_t NUM_BANDS_PER_THREAD = 4;
+
+    ///
+    /// Set up the grid and start the worker threads
+    ///
+    /// @param width The width of the covered area
+    /// @param height The height of the covered area
+    /// @param cellSize The side length of a cell; ideally about the size of a typical collider
+    /// @param numThreads The number of threads, including the calling thread; 1 runs everything on the calling thread.
+    /// @param capacity The number of colliders to reserve memory for
+    /// @return `true` on success, `false` if the given size is invalid.
+    ///
+    bool init(float width, float height, float cellSize, uint32_t numThreads, uint32_t capacity = 0);
+
+    ///
+    /// Find the pairs of colliders whose bounding boxes overlap
+    ///
+    /// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+    /// @param count The number of boxes
+    /// @return The overlapping pairs in the same order as `CollisionGrid` followed by `CollisionNarrowphase` find them.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    const std::vector<CollisionBroadphase::Pair>& findCollisions(const CollisionBroadphase::AABB* boxes, uint32_t count);
+
+    ///
+    /// Set the collision filters used by the following calls
+    ///
+    /// @param filters The collision filters of all colliders; Pass `nullptr` to let all pairs through.
+    ///
+    inline void setFilters(const CollisionBroadphase::Filter* filters)
+    {
+        this->grid.setFilters(filters);
+    }
+
+    ///
+    /// [FAST] Get the number of threads, including the calling thread
+    ///
+    inline uint32_t getNumThreads() const
+    {
+        return this->pool == nullptr ? 1 : this->pool->getNumThreads();
+    }
+
+private:
+    /// A range of cells searched by one task
+    struct Band
+    {
+        /// The first cell of the band
+        uint32_t firstCell;
+
+        /// The cell after the last one of the band
+        uint32_t endCell;
+
+        /// The candidate pairs found in the band
+        std::vector<CollisionBroadphase::Pair> candidates;
+
+        /// The narrow phase of the band and its buffers
+        CollisionNarrowphase narrowphase;
+
+        /// The overlapping pairs found in the band; Owned by the narrow phase
+        const std::vector<CollisionBroadphase::Pair>* hits = nullptr;
+    };
+
+    /// The grid shared by all bands; Read-only while the bands run
+    CollisionGrid grid;
+
+    /// The worker threads; `nullptr` if a single thread is used
+    std::unique_ptr<WorkerPool> pool;
+
+    /// The bands
+    std::vector<Band> bands;
+
+    /// The boxes of the current call
+    const CollisionBroadphase::AABB* boxes = nullptr;
+
+    /// The buffer of overlapping pairs
+    std::vector<CollisionBroadphase::Pair> collisions;
+
+    ///
+    /// [Private Helper] Split the cells into bands that hold about the same number of entries
+    ///
+    void split();
+
+    ///
+    /// [Private Helper] Find and test the pairs of the given band
+    ///
+    void runBand(uint32_t index);
+};
+
+#endif /* CollisionBands_hpp */
@@ -0,0 +1,213 @@
+//
+//  CollisionBounds.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionBounds.hpp"
+#include "Components/Components.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <math.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SW_BOUNDS_BATCH_SIZE 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SW_BOUNDS_BATCH_SIZE 4
+#else
+#define SW_BOUNDS_BATCH_SIZE 1
+#endif
+
+static_assert(Collision::NUM_ENTITIES <= CollisionBounds::MAX_NUM_TYPES, "Each collision type needs a kill rectangle.");
+
+///
+/// [Constructor] Create the bounds with no rectangles
+///
+CollisionBounds::CollisionBounds()
+{
+    for (uint32_t type = 0; type < CollisionBounds::MAX_NUM_TYPES; type++)
+    {
+        this->clearBounds(type);
+    }
+}
+
+///
+/// Make the bounds used by the game
+///
+/// @param width The width of the screen
+/// @param height The height of the screen
+/// @param surface The y-coordinate of the water surface
+/// @return Bounds that report the out of screen events handled by the collision delegate.
+///
+CollisionBounds CollisionBounds::makeDefault(float width, float height, float surface)
+{
+    CollisionBounds bounds;
+
+    // Submarines leave through the left and right screen boundaries
+    bounds.setBounds(Collision::submarine, {0, -INFINITY, width, INFINITY}, CollisionEvent::Type::SubmarineDidMoveOutOfScreen);
+
+    // Bombs sink through the screen bottom
+    bounds.setBounds(Collision::bomb, {-INFINITY, -INFINITY, INFINITY, height}, CollisionEvent::Type::BombDidMoveOutOfScreen);
+
+    // Missiles and smoke rise through the screen top
+    bounds.setBounds(Collision::missile, {-INFINITY, 0, INFINITY, INFINITY}, CollisionEvent::Type::MissileDidMoveOutOfScreen);
+
+    bounds.setBounds(Collision::smoke, {-INFINITY, 0, INFINITY, INFINITY}, CollisionEvent::Type::SmokeDidMoveOutOfScreen);
+
+    // Torpedoes stop at the water surface
+    bounds.setBounds(Collision::torpedo, {-INFINITY, surface, INFINITY, INFINITY}, CollisionEvent::Type::TorpedoDidMoveOutOfOceanSurface);
+
+    return bounds;
+}
+
+///
+/// Set the kill rectangle of an entity type
+///
+/// @param type The entity type, e.g. `Collision::eType`
+/// @param bounds The rectangle the position must stay in; Use infinities for unbounded sides.
+/// @param event The event reported once the position leaves the rectangle
+/// @return `true` on success, `false` if the type is out of range.
+///
+bool CollisionBounds::setBounds(uint32_t type, const AABB& bounds, CollisionEvent::Type event)
+{
+    // Guard: The type must be valid
+    if (type >= CollisionBounds::MAX_NUM_TYPES)
+    {
+        return false;
+    }
+
+    this->minX[type] = bounds.minX;
+
+    this->minY[type] = bounds.minY;
+
+    this->maxX[type] = bounds.maxX;
+
+    this->maxY[type] = bounds.maxY;
+
+    this->events[type] = event;
+
+    return true;
+}
+
+///
+/// Remove the kill rectangle of an entity type
+///
+/// @param type The entity type
+///
+void CollisionBounds::clearBounds(uint32_t type)
+{
+    if (type >= CollisionBounds::MAX_NUM_TYPES)
+    {
+        return;
+    }
+
+    // An infinite rectangle holds every position, so the event is never reported
+    this->minX[type] = -INFINITY;
+
+    this->minY[type] = -INFINITY;
+
+    this->maxX[type] = INFINITY;
+
+    this->maxY[type] = INFINITY;
+
+    this->events[type] = CollisionEvent::Type::SubmarineDidMoveOutOfScreen;
+}
+
+///
+/// Find the entities that are outside their kill rectangles
+///
+/// @param xs The x-coordinate of each entity
+/// @param ys The y-coordinate of each entity
+/// @param types The type of each entity in [0, MAX_NUM_TYPES)
+/// @param entities The identifier of each entity
+/// @param count The number of entities
+/// @param events An event is appended for each entity outside its rectangle, in the order of the entities
+///
+void CollisionBounds::cull(const float* xs, const float* ys, const uint32_t* types, const Entity::Identifier* entities, uint32_t count, CollisionEventBuffer& events) const
+{
+    SW_PROFILE_SCOPE(CollisionNarrowphase);
+
+    uint32_t index = 0;
+
+    // Test full batches; Most batches have no entity outside, which costs a single branch
+    for (; index + SW_BOUNDS_BATCH_SIZE <= count; index += SW_BOUNDS_BATCH_SIZE)
+    {
+        uint32_t mask = this->testBatch(xs, ys, types, index);
+
+        for (uint32_t lane = 0; mask != 0; lane++, mask >>= 1)
+        {
+            if (mask & 1)
+            {
+                events.push(this->events[types[index + lane]], entities[index + lane]);
+            }
+        }
+    }
+
+    // Test the remaining entities one at a time
+    for (; index < count; index++)
+    {
+        if (this->test(xs[index], ys[index], types[index]))
+        {
+            events.push(this->events[types[index]], entities[index]);
+        }
+    }
+}
+
+///
+/// [Private Helper] Test a batch of entities starting at the given index
+///
+/// @return A bit mask of the entities in the batch that are outside their rectangles.
+///
+uint32_t CollisionBounds::testBatch(const float* xs, const float* ys, const uint32_t* types, uint32_t index) const
+{
+#if SW_BOUNDS_BATCH_SIZE == 8
+    __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&types[index]));
+
+    __m256 x = _mm256_loadu_ps(&xs[index]);
+
+    __m256 y = _mm256_loadu_ps(&ys[index]);
+
+    // Gather the rectangle of each lane by its type
+    __m256 outsideX = _mm256_or_ps(_mm256_cmp_ps(x, _mm256_i32gather_ps(this->minX, lanes, 4), _CMP_LT_OQ),
+                                   _mm256_cmp_ps(x, _mm256_i32gather_ps(this->maxX, lanes, 4), _CMP_GT_OQ));
+
+    __m256 outsideY = _mm256_or_ps(_mm256_cmp_ps(y, _mm256_i32gather_ps(this->minY, lanes, 4), _CMP_LT_OQ),
+                                   _mm256_cmp_ps(y, _mm256_i32gather_ps(this->maxY, lanes, 4), _CMP_GT_OQ));
+
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_or_ps(outsideX, outsideY)));
+#elif SW_BOUNDS_BATCH_SIZE == 4
+    const uint32_t* lanes = &types[index];
+
+    __m128 x = _mm_loadu_ps(&xs[index]);
+
+    __m128 y = _mm_loadu_ps(&ys[index]);
+
+    // SSE2 has no gather, so the rectangles are assembled from the tables
+    __m128 minX = _mm_setr_ps(this->minX[lanes[0]], this->minX[lanes[1]], this->minX[lanes[2]], this->minX[lanes[3]]);
+
+    __m128 maxX = _mm_setr_ps(this->maxX[lanes[0]], this->maxX[lanes[1]], this->maxX[lanes[2]], this->maxX[lanes[3]]);
+
+    __m128 minY = _mm_setr_ps(this->minY[lanes[0]], this->minY[lanes[1]], this->minY[lanes[2]], this->minY[lanes[3]]);
+
+    __m128 maxY = _mm_setr_ps(this->maxY[lanes[0]], this->maxY[lanes[1]], this->maxY[lanes[2]], this->maxY[lanes[3]]);
+
+    __m128 outsideX = _mm_or_ps(_mm_cmplt_ps(x, minX), _mm_cmpgt_ps(x, maxX));
+
+    __m128 outsideY = _mm_or_ps(_mm_cmplt_ps(y, minY), _mm_cmpgt_ps(y, maxY));
+
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_or_ps(outsideX, outsideY)));
+#else
+    return this->test(xs[index], ys[index], types[index]) ? 1 : 0;
+#endif
+}
+
+///
+/// [Private Helper] Test a single entity
+///
+bool CollisionBounds::test(float x, float y, uint32_t type) const
+{
+    return x < this->minX[type] || x > this->maxX[type] || y < this->minY[type] || y > this->maxY[type];
+}
@@ -0,0 +1,102 @@
+//
+//  CollisionBounds.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionBounds_hpp
+#define CollisionBounds_hpp
+
+#include "CollisionBroadphase.hpp"
+#include "CollisionEvents.hpp"
+#include <stdint.h>
+
+/// Culls the entities that leave their kill rectangles, separately from the pair collisions
+///
+/// Each entity type may have a rectangle its position must stay in, e.g. a bomb must stay above the screen bottom,
+/// together with the event reported once it leaves, e.g. `BombDidMoveOutOfScreen`.
+/// The positions are tested in structure-of-arrays form, 8 at a time with AVX2 or 4 at a time with SSE2,
+/// and the rectangle of each lane is looked up by its type, so a single pass covers all types.
+/// Types without a rectangle are never culled.
+class CollisionBounds
+{
+public:
+    /// An axis-aligned rectangle
+    using AABB = CollisionBroadphase::AABB;
+
+    /// The maximum number of entity types
+    static constexpr uint32_t MAX_NUM_TYPES = 32;
+
+    ///
+    /// [Constructor] Create the bounds with no rectangles
+    ///
+    CollisionBounds();
+
+    ///
+    /// Make the bounds used by the game
+    ///
+    /// @param width The width of the screen
+    /// @param height The height of the screen
+    /// @param surface The y-coordinate of the water surface
+    /// @return Bounds that report the out of screen events handled by the collision delegate.
+    ///
+    static CollisionBounds makeDefault(float width, float height, float surface);
+
+    ///
+    /// Set the kill rectangle of an entity type
+    ///
+    /// @param type The entity type, e.g. `Collision::eType`
+    /// @param bounds The rectangle the position must stay in; Use infinities for unbounded sides.
+    /// @param event The event reported once the position leaves the rectangle
+    /// @return `true` on success, `false` if the type is out of range.
+    ///
+    bool setBounds(uint32_t type, const AABB& bounds, CollisionEvent::Type event);
+
+    ///
+    /// Remove the kill rectangle of an entity type
+    ///
+    /// @param type The entity type
+    ///
+    void clearBounds(uint32_t type);
+
+    ///
+    /// Find the entities that are outside their kill rectangles
+    ///
+    /// @param xs The x-coordinate of each entity
+    /// @param ys The y-coordinate of each entity
+    /// @param types The type of each entity in [0, MAX_NUM_TYPES)
+    /// @param entities The identifier of each entity
+    /// @param count The number of entities
+    /// @param events An event is appended for each entity outside its rectangle, in the order of the entities
+    ///
+    void cull(const float* xs, const float* ys, const uint32_t* types, const Entity::Identifier* entities, uint32_t count, CollisionEventBuffer& events) const;
+
+private:
+    /// The kill rectangle of each type
+    float minX[MAX_NUM_TYPES];
+
+    float minY[MAX_NUM_TYPES];
+
+    float maxX[MAX_NUM_TYPES];
+
+    float maxY[MAX_NUM_TYPES];
+
+    /// The event reported for each type
+    CollisionEvent::Type events[MAX_NUM_TYPES];
+
+    ///
+    /// [Private Helper] Test a batch of entities starting at the given index
+    ///
+    /// @return A bit mask of the entities in the batch that are outside their rectangles.
+    ///
+    uint32_t testBatch(const float* xs, const float* ys, const uint32_t* types, uint32_t index) const;
+
+    ///
+    /// [Private Helper] Test a single entity
+    ///
+    bool test(float x, float y, uint32_t type) const;
+};
+
+#endif /* CollisionBounds_hpp */
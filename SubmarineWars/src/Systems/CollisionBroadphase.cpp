@@ -0,0 +1,68 @@
+//
+//  CollisionBroadphase.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-11.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionBroadphase.hpp"
+#include "CollisionGrid.hpp"
+#include "CollisionSweepAndPrune.hpp"
+
+///
+/// Make a broadphase of the given type
+///
+/// @param type The broadphase type
+/// @param width The width of the covered area
+/// @param height The height of the covered area
+/// @param capacity The number of colliders to reserve memory for
+/// @return A non-null broadphase on success, `nullptr` otherwise.
+///
+std::unique_ptr<CollisionBroadphase> CollisionBroadphase::make(Type type, float width, float height, uint32_t capacity)
+{
+    switch (type)
+    {
+        case Type::Grid:
+        {
+            std::unique_ptr<CollisionGrid> grid(new CollisionGrid());
+
+            if (!grid->init(width, height, CollisionBroadphase::DEF_CELL_SIZE, capacity))
+            {
+                return nullptr;
+            }
+
+            return grid;
+        }
+
+        case Type::SweepAndPrune:
+        {
+            std::unique_ptr<CollisionSweepAndPrune> sap(new CollisionSweepAndPrune());
+
+            sap->reserve(capacity);
+
+            return sap;
+        }
+
+        default:
+            return nullptr;
+    }
+}
+
+///
+/// Get the name of the given broadphase type
+///
+const char* CollisionBroadphase::typeToString(Type type)
+{
+    switch (type)
+    {
+        case Type::Grid:
+            return "grid";
+
+        case Type::SweepAndPrune:
+            return "sap";
+
+        default:
+            return "unknown";
+    }
+}
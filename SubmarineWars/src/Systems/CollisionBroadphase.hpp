@@ -0,0 +1,149 @@
+//
+//  CollisionBroadphase.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-11.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionBroadphase_hpp
+#define CollisionBroadphase_hpp
+
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+/// The interface of a broadphase that finds pairs of colliders that may collide
+///
+/// The collision system hands the bounding boxes of all colliders to `build()` once per frame,
+/// and then tests the candidate pairs in the narrow phase.
+/// Implementations are interchangeable behind `make()`, so the bench can compare them on the same layouts.
+class CollisionBroadphase
+{
+public:
+    /// An axis-aligned bounding box
+    struct AABB
+    {
+        float minX;
+
+        float minY;
+
+        float maxX;
+
+        float maxY;
+    };
+
+    /// A pair of entry indices whose boxes may overlap
+    struct Pair
+    {
+        /// The smaller index
+        uint32_t first;
+
+        /// The larger index
+        uint32_t second;
+    };
+
+    /// The collision filter of a collider
+    ///
+    /// Two colliders may collide only if the category of each one is in the mask of the other,
+    /// so pairs that can never collide are rejected by a bit test before any geometry work.
+    struct Filter
+    {
+        /// The layers the collider belongs to
+        uint32_t category;
+
+        /// The layers the collider collides with
+        uint32_t mask;
+    };
+
+    /// Enumerates all broadphase implementations
+    enum class Type: uint8_t
+    {
+        /// A uniform grid rebuilt every frame; Suits colliders spread over the whole screen
+        Grid,
+
+        /// An insertion-sorted sweep along the x-axis; Suits colliders that live in horizontal bands and move along x
+        SweepAndPrune
+    };
+
+    /// The default cell size of the grid in pixels
+    static constexpr float DEF_CELL_SIZE = 64.f;
+
+    ///
+    /// Make a broadphase of the given type
+    ///
+    /// @param type The broadphase type
+    /// @param width The width of the covered area
+    /// @param height The height of the covered area
+    /// @param capacity The number of colliders to reserve memory for
+    /// @return A non-null broadphase on success, `nullptr` otherwise.
+    ///
+    static std::unique_ptr<CollisionBroadphase> make(Type type, float width, float height, uint32_t capacity = 0);
+
+    ///
+    /// Get the name of the given broadphase type
+    ///
+    static const char* typeToString(Type type);
+
+    ///
+    /// [Destructor] Destroy the broadphase
+    ///
+    virtual ~CollisionBroadphase() = default;
+
+    ///
+    /// Update the broadphase with the bounding boxes of this frame
+    ///
+    /// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+    /// @param count The number of boxes
+    ///
+    virtual void build(const AABB* boxes, uint32_t count) = 0;
+
+    ///
+    /// Find all pairs of entries that may overlap
+    ///
+    /// @return The candidate pairs; each pair is reported once.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    virtual const std::vector<Pair>& findCandidatePairs() = 0;
+
+    ///
+    /// Get the type of this broadphase
+    ///
+    virtual Type getType() const = 0;
+
+    ///
+    /// Set the collision filters used by the following builds
+    ///
+    /// @param filters The collision filters of all colliders; Entry `i` refers to `filters[i]`.
+    ///                Pass `nullptr` to let all pairs through.
+    /// @note The filters must stay valid until the candidate pairs have been found.
+    ///
+    inline void setFilters(const Filter* filters)
+    {
+        this->filters = filters;
+    }
+
+protected:
+    /// The collision filters of all colliders; `nullptr` if all pairs pass
+    const Filter* filters = nullptr;
+
+    ///
+    /// [Helper] Check whether the given entry may collide with anything
+    ///
+    inline bool isCollidable(uint32_t entry) const
+    {
+        return this->filters == nullptr || (this->filters[entry].category != 0 && this->filters[entry].mask != 0);
+    }
+
+    ///
+    /// [Helper] Check whether the given entries may collide with each other
+    ///
+    inline bool canCollide(uint32_t first, uint32_t second) const
+    {
+        return this->filters == nullptr ||
+               ((this->filters[first].category & this->filters[second].mask) != 0 &&
+                (this->filters[second].category & this->filters[first].mask) != 0);
+    }
+};
+
+#endif /* CollisionBroadphase_hpp */
@@ -0,0 +1,269 @@
+//
+//  CollisionGrid.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-10.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionGrid.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+#include <math.h>
+
+///
+/// Set up the grid
+///
+/// @param width The width of the covered area
+/// @param height The height of the covered area
+/// @param cellSize The side length of a cell; ideally about the size of a typical collider
+/// @param capacity The number of colliders to reserve memory for
+/// @return `true` on success, `false` if the given size is invalid.
+/// @note Boxes outside the covered area are clamped to the border cells.
+///
+bool CollisionGrid::init(float width, float height, float cellSize, uint32_t capacity)
+{
+    // Guard: Cell coordinates must fit in the cell ranges
+    if (width <= 0 || height <= 0 || cellSize <= 0 || width / cellSize > UINT16_MAX || height / cellSize > UINT16_MAX)
+    {
+        return false;
+    }
+
+    this->numColumns = static_cast<uint32_t>(ceilf(width / cellSize));
+
+    this->numRows = static_cast<uint32_t>(ceilf(height / cellSize));
+
+    this->inverseCellSize = 1.f / cellSize;
+
+    uint32_t numCells = this->numColumns * this->numRows;
+
+    this->offsets.assign(numCells + 1, 0);
+
+    this->cursors.assign(numCells, 0);
+
+    this->entries.reserve(capacity);
+
+    this->ranges.reserve(capacity);
+
+    this->pairs.reserve(capacity);
+
+    return true;
+}
+
+///
+/// Rebuild the grid
+///
+/// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+/// @param count The number of boxes
+///
+void CollisionGrid::build(const AABB* boxes, uint32_t count)
+{
+    SW_PROFILE_SCOPE(CollisionBroadphase);
+
+    uint32_t numCells = this->numColumns * this->numRows;
+
+    // Pass 1: Count the entries of each cell
+    // The count of cell `c` is kept in `offsets[c + 1]`, so that the prefix sum below yields the offsets directly
+    std::fill(this->offsets.begin(), this->offsets.end(), 0);
+
+    this->ranges.resize(count);
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        CellRange range = this->getCellRange(boxes[index]);
+
+        this->ranges[index] = range;
+
+        // Colliders that collide with nothing stay out of the cells
+        if (!this->isCollidable(index))
+        {
+            continue;
+        }
+
+        for (uint32_t y = range.y0; y <= range.y1; y++)
+        {
+            for (uint32_t x = range.x0; x <= range.x1; x++)
+            {
+                this->offsets[y * this->numColumns + x + 1]++;
+            }
+        }
+    }
+
+    // Pass 2: Turn the counts into offsets
+    for (uint32_t cell = 1; cell <= numCells; cell++)
+    {
+        this->offsets[cell] += this->offsets[cell - 1];
+    }
+
+    // Pass 3: Pack the entries by cell, in ascending order within a cell
+    this->entries.resize(this->offsets[numCells]);
+
+    std::copy(this->offsets.begin(), this->offsets.end() - 1, this->cursors.begin());
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const CellRange& range = this->ranges[index];
+
+        if (!this->isCollidable(index))
+        {
+            continue;
+        }
+
+        for (uint32_t y = range.y0; y <= range.y1; y++)
+        {
+            for (uint32_t x = range.x0; x <= range.x1; x++)
+            {
+                this->entries[this->cursors[y * this->numColumns + x]++] = index;
+            }
+        }
+    }
+}
+
+///
+/// Find all pairs of entries that share at least one cell
+///
+/// @return The candidate pairs; each pair is reported once, no matter how many cells it shares.
+/// @note The returned buffer is reused by the next call.
+///
+const std::vector<CollisionBroadphase::Pair>& CollisionGrid::findCandidatePairs()
+{
+    SW_PROFILE_SCOPE(CollisionBroadphase);
+
+    this->pairs.clear();
+
+    this->findCandidatePairs(0, this->getNumCells(), this->pairs);
+
+    return this->pairs;
+}
+
+///
+/// Find the pairs whose first shared cell lies in the given range of cells
+///
+/// @param firstCell The first cell in the range; Cells are numbered row by row
+/// @param endCell The cell after the last one in the range
+/// @param result The candidate pairs are appended to this buffer
+/// @note Ranges that do not overlap yield disjoint pairs, so bands of cells can be searched by different threads,
+///       and concatenating their pairs in the order of the bands gives the same order as `findCandidatePairs()`.
+///
+void CollisionGrid::findCandidatePairs(uint32_t firstCell, uint32_t endCell, std::vector<Pair>& result) const
+{
+    for (uint32_t cell = firstCell; cell < endCell; cell++)
+    {
+        uint32_t x = cell % this->numColumns;
+
+        uint32_t y = cell / this->numColumns;
+
+        uint32_t begin = this->offsets[cell];
+
+        uint32_t end = this->offsets[cell + 1];
+
+        for (uint32_t i = begin; i + 1 < end; i++)
+        {
+            uint32_t first = this->entries[i];
+
+            const CellRange& a = this->ranges[first];
+
+            for (uint32_t j = i + 1; j < end; j++)
+            {
+                uint32_t second = this->entries[j];
+
+                // Layers that never collide cost a bit test
+                if (!this->canCollide(first, second))
+                {
+                    continue;
+                }
+
+                const CellRange& b = this->ranges[second];
+
+                // Two boxes that span several cells meet in all of them, so only report them in the first shared cell
+                if (std::max(a.x0, b.x0) != x || std::max(a.y0, b.y0) != y)
+                {
+                    continue;
+                }
+
+                result.push_back({first, second});
+            }
+        }
+    }
+}
+
+///
+/// Find the cell that holds the entry at the given position of the packed entries
+///
+/// @param position A position in [0, getNumCellEntries()]
+/// @return The index of the cell; `getNumCells()` for the position past the last entry.
+/// @note Use this to split the cells into bands that hold about the same number of entries.
+///
+uint32_t CollisionGrid::findCellAt(uint32_t position) const
+{
+    // The first cell whose end lies past the position; Empty cells before it are skipped
+    auto iterator = std::upper_bound(this->offsets.begin() + 1, this->offsets.end(), position);
+
+    return static_cast<uint32_t>(std::distance(this->offsets.begin() + 1, iterator));
+}
+
+///
+/// Find all entries that share at least one cell with the given box
+///
+/// @param box The box to query
+/// @param result Entry indices in no particular order on return; each entry is reported once.
+///
+void CollisionGrid::query(const AABB& box, std::vector<uint32_t>& result) const
+{
+    result.clear();
+
+    CellRange range = this->getCellRange(box);
+
+    for (uint32_t y = range.y0; y <= range.y1; y++)
+    {
+        for (uint32_t x = range.x0; x <= range.x1; x++)
+        {
+            uint32_t cell = y * this->numColumns + x;
+
+            for (uint32_t i = this->offsets[cell]; i < this->offsets[cell + 1]; i++)
+            {
+                uint32_t entry = this->entries[i];
+
+                const CellRange& other = this->ranges[entry];
+
+                // Report each entry in the first cell it shares with the box
+                if (std::max(range.x0, other.x0) == x && std::max(range.y0, other.y0) == y)
+                {
+                    result.push_back(entry);
+                }
+            }
+        }
+    }
+}
+
+///
+/// [Private Helper] Find the cells overlapped by the given box
+///
+CollisionGrid::CellRange CollisionGrid::getCellRange(const AABB& box) const
+{
+    // A convenient lambda function that converts a coordinate to a cell index clamped to the grid
+    auto cell = [this] (float coordinate, uint32_t count) -> uint16_t
+    {
+        float index = floorf(coordinate * this->inverseCellSize);
+
+        // Also catches NaN
+        if (!(index > 0.f))
+        {
+            return 0;
+        }
+
+        return static_cast<uint16_t>(std::min(index, static_cast<float>(count - 1)));
+    };
+
+    CellRange range;
+
+    range.x0 = cell(box.minX, this->numColumns);
+
+    range.y0 = cell(box.minY, this->numRows);
+
+    range.x1 = cell(box.maxX, this->numColumns);
+
+    range.y1 = cell(box.maxY, this->numRows);
+
+    return range;
+}
@@ -0,0 +1,146 @@
+//
+//  CollisionGrid.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-10.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionGrid_hpp
+#define CollisionGrid_hpp
+
+#include "CollisionBroadphase.hpp"
+
+/// A uniform grid broadphase that is rebuilt from scratch every frame
+///
+/// The grid is stored as flat arrays: the number of entries in each cell is counted first,
+/// a prefix sum turns the counts into cell offsets, and a second pass packs the entry indices by cell (counting sort).
+/// The arrays only grow when the number of colliders reaches a new high, so a steady frame does not allocate memory,
+/// and the entries of a cell are contiguous in memory.
+class CollisionGrid: public CollisionBroadphase
+{
+public:
+    ///
+    /// Set up the grid
+    ///
+    /// @param width The width of the covered area
+    /// @param height The height of the covered area
+    /// @param cellSize The side length of a cell; ideally about the size of a typical collider
+    /// @param capacity The number of colliders to reserve memory for
+    /// @return `true` on success, `false` if the given size is invalid.
+    /// @note Boxes outside the covered area are clamped to the border cells.
+    ///
+    bool init(float width, float height, float cellSize, uint32_t capacity = 0);
+
+    ///
+    /// Rebuild the grid
+    ///
+    /// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+    /// @param count The number of boxes
+    ///
+    void build(const AABB* boxes, uint32_t count) override;
+
+    ///
+    /// Find all pairs of entries that share at least one cell
+    ///
+    /// @return The candidate pairs; each pair is reported once, no matter how many cells it shares.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    const std::vector<Pair>& findCandidatePairs() override;
+
+    ///
+    /// Find the pairs whose first shared cell lies in the given range of cells
+    ///
+    /// @param firstCell The first cell in the range; Cells are numbered row by row
+    /// @param endCell The cell after the last one in the range
+    /// @param result The candidate pairs are appended to this buffer
+    /// @note Ranges that do not overlap yield disjoint pairs, so bands of cells can be searched by different threads,
+    ///       and concatenating their pairs in the order of the bands gives the same order as `findCandidatePairs()`.
+    ///
+    void findCandidatePairs(uint32_t firstCell, uint32_t endCell, std::vector<Pair>& result) const;
+
+    ///
+    /// Get the type of this broadphase
+    ///
+    Type getType() const override
+    {
+        return Type::Grid;
+    }
+
+    ///
+    /// Find all entries that share at least one cell with the given box
+    ///
+    /// @param box The box to query
+    /// @param result Entry indices in no particular order on return; each entry is reported once.
+    ///
+    void query(const AABB& box, std::vector<uint32_t>& result) const;
+
+    ///
+    /// [FAST] Get the number of entries in the grid, counting an entry once per cell it overlaps
+    ///
+    inline uint32_t getNumCellEntries() const
+    {
+        return static_cast<uint32_t>(this->entries.size());
+    }
+
+    ///
+    /// [FAST] Get the number of cells
+    ///
+    inline uint32_t getNumCells() const
+    {
+        return this->numColumns * this->numRows;
+    }
+
+    ///
+    /// Find the cell that holds the entry at the given position of the packed entries
+    ///
+    /// @param position A position in [0, getNumCellEntries()]
+    /// @return The index of the cell; `getNumCells()` for the position past the last entry.
+    /// @note Use this to split the cells into bands that hold about the same number of entries.
+    ///
+    uint32_t findCellAt(uint32_t position) const;
+
+private:
+    /// The range of cells overlapped by a box, inclusive
+    struct CellRange
+    {
+        uint16_t x0;
+
+        uint16_t y0;
+
+        uint16_t x1;
+
+        uint16_t y1;
+    };
+
+    /// The number of columns
+    uint32_t numColumns = 0;
+
+    /// The number of rows
+    uint32_t numRows = 0;
+
+    /// The reciprocal of the cell size
+    float inverseCellSize = 0;
+
+    /// The offset of the first entry of each cell; The last element is the total number of entries
+    std::vector<uint32_t> offsets;
+
+    /// The next free position of each cell while packing entries
+    std::vector<uint32_t> cursors;
+
+    /// Entry indices packed by cell
+    std::vector<uint32_t> entries;
+
+    /// The cells overlapped by each entry
+    std::vector<CellRange> ranges;
+
+    /// The buffer of candidate pairs
+    std::vector<Pair> pairs;
+
+    ///
+    /// [Private Helper] Find the cells overlapped by the given box
+    ///
+    CellRange getCellRange(const AABB& box) const;
+};
+
+#endif /* CollisionGrid_hpp */
@@ -0,0 +1,72 @@
+//
+//  CollisionLayers.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-12.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionLayers.hpp"
+#include "Components/Components.hpp"
+
+static_assert(Collision::NUM_ENTITIES <= CollisionLayers::MAX_NUM_LAYERS, "Each collision type needs a layer.");
+
+///
+/// Make the matrix used by the game
+///
+/// @return A matrix that lets through exactly the pairs handled by the collision delegate.
+///
+CollisionLayers CollisionLayers::makeDefault()
+{
+    CollisionLayers layers;
+
+    // Explosions destroy submarines, fish, missiles, torpedoes and store icons
+    for (auto type : {Collision::submarine, Collision::fish, Collision::missile, Collision::torpedo, Collision::storeIcon})
+    {
+        layers.setCollides(Collision::explosion, type);
+
+        // Bombs and boat missiles explode on anything an explosion destroys
+        layers.setCollides(Collision::bomb, type);
+
+        layers.setCollides(Collision::boatMissile, type);
+    }
+
+    // Torpedoes and missiles hit the boat
+    layers.setCollides(Collision::torpedo, Collision::boat);
+
+    layers.setCollides(Collision::missile, Collision::boat);
+
+    return layers;
+}
+
+///
+/// Set whether two layers collide with each other
+///
+/// @param first The first layer
+/// @param second The second layer; may be the same as the first one
+/// @param collides Pass `false` to let the two layers pass through each other
+/// @return `true` on success, `false` if either layer is out of range.
+///
+bool CollisionLayers::setCollides(uint32_t first, uint32_t second, bool collides)
+{
+    // Guard: Both layers must be valid
+    if (first >= CollisionLayers::MAX_NUM_LAYERS || second >= CollisionLayers::MAX_NUM_LAYERS)
+    {
+        return false;
+    }
+
+    if (collides)
+    {
+        this->masks[first] |= 1u << second;
+
+        this->masks[second] |= 1u << first;
+    }
+    else
+    {
+        this->masks[first] &= ~(1u << second);
+
+        this->masks[second] &= ~(1u << first);
+    }
+
+    return true;
+}
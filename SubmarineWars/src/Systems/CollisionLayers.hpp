@@ -0,0 +1,64 @@
+//
+//  CollisionLayers.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-12.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionLayers_hpp
+#define CollisionLayers_hpp
+
+#include "CollisionBroadphase.hpp"
+
+/// A symmetric matrix that tells which collision layers collide with each other
+///
+/// Each collision type is a layer, and each layer keeps a mask of the layers it collides with.
+/// The broadphase tests the masks before any geometry work,
+/// so pairs that no callback of the collision delegate cares about, e.g. fish and fish, or submarine and submarine,
+/// are rejected by a single bit test.
+class CollisionLayers
+{
+public:
+    /// The maximum number of layers
+    static constexpr uint32_t MAX_NUM_LAYERS = 32;
+
+    ///
+    /// Make the matrix used by the game
+    ///
+    /// @return A matrix that lets through exactly the pairs handled by the collision delegate.
+    ///
+    static CollisionLayers makeDefault();
+
+    ///
+    /// Set whether two layers collide with each other
+    ///
+    /// @param first The first layer
+    /// @param second The second layer; may be the same as the first one
+    /// @param collides Pass `false` to let the two layers pass through each other
+    /// @return `true` on success, `false` if either layer is out of range.
+    ///
+    bool setCollides(uint32_t first, uint32_t second, bool collides = true);
+
+    ///
+    /// [FAST] Check whether two layers collide with each other
+    ///
+    inline bool collides(uint32_t first, uint32_t second) const
+    {
+        return (this->masks[first] & (1u << second)) != 0;
+    }
+
+    ///
+    /// [FAST] Get the collision filter of a collider on the given layer
+    ///
+    inline CollisionBroadphase::Filter getFilter(uint32_t layer) const
+    {
+        return {1u << layer, this->masks[layer]};
+    }
+
+private:
+    /// The layers each layer collides with; Nothing collides by default
+    uint32_t masks[MAX_NUM_LAYERS] = {};
+};
+
+#endif /* CollisionLayers_hpp */
@@ -0,0 +1,229 @@
+//
+//  CollisionMask.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-13.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionMask.hpp"
+#include <algorithm>
+#include <math.h>
+
+///
+/// Build the mask from the alpha channel of an image
+///
+/// @param pixels The RGBA pixels of the image, row by row from the top
+/// @param width The width of the image
+/// @param height The height of the image
+/// @param threshold The alpha value at or above which a pixel is opaque
+/// @return `true` on success, `false` if the image is empty.
+///
+bool CollisionMask::initFromAlpha(const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t threshold)
+{
+    // Guard: The image must not be empty
+    if (pixels == nullptr || width == 0 || height == 0)
+    {
+        return false;
+    }
+
+    this->allocate(width, height);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            if (pixels[(y * width + x) * 4 + 3] >= threshold)
+            {
+                this->set(x, y);
+            }
+        }
+    }
+
+    return true;
+}
+
+///
+/// Build the mask from another mask that is flipped horizontally and then rotated about its center
+///
+/// @param source The mask to transform
+/// @param flipX Pass `true` to mirror the mask, e.g. for an entity facing left
+/// @param radians The rotation in radians; The mask grows to the bounding box of the rotated source.
+/// @return `true` on success, `false` if the source is empty.
+///
+bool CollisionMask::initTransformed(const CollisionMask& source, bool flipX, float radians)
+{
+    // Guard: The source must not be empty
+    if (!source.isValid())
+    {
+        return false;
+    }
+
+    float cosine = cosf(radians);
+
+    float sine = sinf(radians);
+
+    float sourceWidth = static_cast<float>(source.width);
+
+    float sourceHeight = static_cast<float>(source.height);
+
+    // The bounding box of the rotated source; The epsilon keeps right angles from adding a pixel
+    uint32_t width = std::max(1u, static_cast<uint32_t>(ceilf(fabsf(sourceWidth * cosine) + fabsf(sourceHeight * sine) - 1e-3f)));
+
+    uint32_t height = std::max(1u, static_cast<uint32_t>(ceilf(fabsf(sourceWidth * sine) + fabsf(sourceHeight * cosine) - 1e-3f)));
+
+    this->allocate(width, height);
+
+    // Sample the source at the center of each pixel through the inverse transform
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float dx = x + 0.5f - width * 0.5f;
+
+            float dy = y + 0.5f - height * 0.5f;
+
+            float sx = cosine * dx + sine * dy;
+
+            float sy = cosine * dy - sine * dx;
+
+            if (flipX)
+            {
+                sx = -sx;
+            }
+
+            sx += sourceWidth * 0.5f;
+
+            sy += sourceHeight * 0.5f;
+
+            if (sx >= 0 && sx < sourceWidth && sy >= 0 && sy < sourceHeight && source.test(static_cast<uint32_t>(sx), static_cast<uint32_t>(sy)))
+            {
+                this->set(x, y);
+            }
+        }
+    }
+
+    return true;
+}
+
+///
+/// Get a flipped and rotated version of this mask
+///
+/// @param flipX Pass `true` to mirror the mask
+/// @param radians The rotation in radians; rounded to the nearest of `NUM_ROTATIONS` steps
+/// @return This mask if no transform is needed, otherwise a cached transformed mask.
+/// @note The transformed masks are built on first use.
+///
+const CollisionMask& CollisionMask::getVariant(bool flipX, float radians)
+{
+    static constexpr float TWO_PI = 6.28318530718f;
+
+    int32_t step = static_cast<int32_t>(lroundf(radians / TWO_PI * NUM_ROTATIONS)) % static_cast<int32_t>(NUM_ROTATIONS);
+
+    if (step < 0)
+    {
+        step += NUM_ROTATIONS;
+    }
+
+    if (!flipX && step == 0)
+    {
+        return *this;
+    }
+
+    if (this->variants == nullptr)
+    {
+        this->variants.reset(new CollisionMask[2 * NUM_ROTATIONS]);
+    }
+
+    CollisionMask& variant = this->variants[(flipX ? NUM_ROTATIONS : 0) + step];
+
+    if (!variant.isValid())
+    {
+        variant.initTransformed(*this, flipX, step * TWO_PI / NUM_ROTATIONS);
+    }
+
+    return variant;
+}
+
+///
+/// Check whether two masks share an opaque pixel
+///
+/// @param first The first mask
+/// @param x1 The x-coordinate of the center of the first mask
+/// @param y1 The y-coordinate of the center of the first mask
+/// @param second The second mask
+/// @param x2 The x-coordinate of the center of the second mask
+/// @param y2 The y-coordinate of the center of the second mask
+/// @return `true` if the masks overlap, `false` otherwise.
+/// @note The masks are placed on whole pixels.
+///
+bool CollisionMask::overlaps(const CollisionMask& first, float x1, float y1, const CollisionMask& second, float x2, float y2)
+{
+    // The top left corners of the masks
+    int32_t left1 = static_cast<int32_t>(lroundf(x1 - first.width * 0.5f));
+
+    int32_t top1 = static_cast<int32_t>(lroundf(y1 - first.height * 0.5f));
+
+    int32_t left2 = static_cast<int32_t>(lroundf(x2 - second.width * 0.5f));
+
+    int32_t top2 = static_cast<int32_t>(lroundf(y2 - second.height * 0.5f));
+
+    // The overlap region
+    int32_t left = std::max(left1, left2);
+
+    int32_t right = std::min(left1 + static_cast<int32_t>(first.width), left2 + static_cast<int32_t>(second.width));
+
+    int32_t top = std::max(top1, top2);
+
+    int32_t bottom = std::min(top1 + static_cast<int32_t>(first.height), top2 + static_cast<int32_t>(second.height));
+
+    // Guard: The masks must overlap; Also rejects empty masks
+    if (left >= right || top >= bottom)
+    {
+        return false;
+    }
+
+    uint32_t width = static_cast<uint32_t>(right - left);
+
+    for (int32_t y = top; y < bottom; y++)
+    {
+        uint32_t row1 = static_cast<uint32_t>(y - top1);
+
+        uint32_t row2 = static_cast<uint32_t>(y - top2);
+
+        // AND 64 pixels at a time
+        for (uint32_t offset = 0; offset < width; offset += 64)
+        {
+            uint64_t word = first.getWord(row1, left - left1 + offset) & second.getWord(row2, left - left2 + offset);
+
+            // Drop the pixels past the overlap region
+            if (width - offset < 64)
+            {
+                word &= (1ull << (width - offset)) - 1;
+            }
+
+            if (word != 0)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+///
+/// [Private Helper] Allocate a cleared mask of the given size
+///
+void CollisionMask::allocate(uint32_t width, uint32_t height)
+{
+    this->width = width;
+
+    this->height = height;
+
+    this->wordsPerRow = (width + 63) / 64 + 1;
+
+    this->bits.assign(static_cast<size_t>(this->wordsPerRow) * height, 0);
+
+    this->variants.reset();
+}
@@ -0,0 +1,152 @@
+//
+//  CollisionMask.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-13.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionMask_hpp
+#define CollisionMask_hpp
+
+#include <memory>
+#include <vector>
+#include <stdint.h>
+
+/// A 1-bit mask of the opaque pixels of a texture
+///
+/// Each row is packed into 64-bit words, the leftmost pixel in the least significant bit,
+/// so two masks are tested for overlap by AND-ing whole words over the overlapping rows.
+/// The collision system refines AABB hits with the masks, which fixes hits on irregular sprites,
+/// and costs at most one AND per 64 pixels of the overlap region.
+class CollisionMask
+{
+public:
+    /// The default alpha value at or above which a pixel is opaque
+    static constexpr uint8_t DEF_ALPHA_THRESHOLD = 128;
+
+    /// The number of rotations cached per mask, evenly spread over a full turn
+    static constexpr uint32_t NUM_ROTATIONS = 64;
+
+    ///
+    /// Build the mask from the alpha channel of an image
+    ///
+    /// @param pixels The RGBA pixels of the image, row by row from the top
+    /// @param width The width of the image
+    /// @param height The height of the image
+    /// @param threshold The alpha value at or above which a pixel is opaque
+    /// @return `true` on success, `false` if the image is empty.
+    ///
+    bool initFromAlpha(const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t threshold = DEF_ALPHA_THRESHOLD);
+
+    ///
+    /// Build the mask from another mask that is flipped horizontally and then rotated about its center
+    ///
+    /// @param source The mask to transform
+    /// @param flipX Pass `true` to mirror the mask, e.g. for an entity facing left
+    /// @param radians The rotation in radians; The mask grows to the bounding box of the rotated source.
+    /// @return `true` on success, `false` if the source is empty.
+    ///
+    bool initTransformed(const CollisionMask& source, bool flipX, float radians);
+
+    ///
+    /// Get a flipped and rotated version of this mask
+    ///
+    /// @param flipX Pass `true` to mirror the mask
+    /// @param radians The rotation in radians; rounded to the nearest of `NUM_ROTATIONS` steps
+    /// @return This mask if no transform is needed, otherwise a cached transformed mask.
+    /// @note The transformed masks are built on first use.
+    ///
+    const CollisionMask& getVariant(bool flipX, float radians);
+
+    ///
+    /// Check whether two masks share an opaque pixel
+    ///
+    /// @param first The first mask
+    /// @param x1 The x-coordinate of the center of the first mask
+    /// @param y1 The y-coordinate of the center of the first mask
+    /// @param second The second mask
+    /// @param x2 The x-coordinate of the center of the second mask
+    /// @param y2 The y-coordinate of the center of the second mask
+    /// @return `true` if the masks overlap, `false` otherwise.
+    /// @note The masks are placed on whole pixels.
+    ///
+    static bool overlaps(const CollisionMask& first, float x1, float y1, const CollisionMask& second, float x2, float y2);
+
+    ///
+    /// [FAST] Check whether the pixel at the given position is opaque
+    ///
+    inline bool test(uint32_t x, uint32_t y) const
+    {
+        return (this->bits[y * this->wordsPerRow + x / 64] >> (x % 64)) & 1;
+    }
+
+    ///
+    /// [FAST] Check whether the mask has been built
+    ///
+    inline bool isValid() const
+    {
+        return this->width > 0 && this->height > 0;
+    }
+
+    ///
+    /// [FAST] Get the width in pixels
+    ///
+    inline uint32_t getWidth() const
+    {
+        return this->width;
+    }
+
+    ///
+    /// [FAST] Get the height in pixels
+    ///
+    inline uint32_t getHeight() const
+    {
+        return this->height;
+    }
+
+private:
+    /// The width in pixels
+    uint32_t width = 0;
+
+    /// The height in pixels
+    uint32_t height = 0;
+
+    /// The number of words per row, including a trailing zero word so that reading past the last pixel of a row is safe
+    uint32_t wordsPerRow = 0;
+
+    /// The rows of the mask
+    std::vector<uint64_t> bits;
+
+    /// Flipped and rotated versions of this mask built on first use; `nullptr` until then
+    std::unique_ptr<CollisionMask[]> variants;
+
+    ///
+    /// [Private Helper] Allocate a cleared mask of the given size
+    ///
+    void allocate(uint32_t width, uint32_t height);
+
+    ///
+    /// [Private Helper] Set the pixel at the given position
+    ///
+    inline void set(uint32_t x, uint32_t y)
+    {
+        this->bits[y * this->wordsPerRow + x / 64] |= 1ull << (x % 64);
+    }
+
+    ///
+    /// [Private Helper] Get the 64 pixels of a row starting at the given column
+    ///
+    /// @note The column must be inside the row; Pixels past the end of the row are zero.
+    ///
+    inline uint64_t getWord(uint32_t row, uint32_t column) const
+    {
+        const uint64_t* words = &this->bits[row * this->wordsPerRow + column / 64];
+
+        uint32_t shift = column % 64;
+
+        return shift == 0 ? words[0] : (words[0] >> shift) | (words[1] << (64 - shift));
+    }
+};
+
+#endif /* CollisionMask_hpp */
@@ -0,0 +1,147 @@
+//
+//  CollisionNarrowphase.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-10.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionNarrowphase.hpp"
+#include "Foundations/FrameProfiler.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SW_NARROWPHASE_BATCH_SIZE 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SW_NARROWPHASE_BATCH_SIZE 4
+#else
+#define SW_NARROWPHASE_BATCH_SIZE 1
+#endif
+
+#if SW_NARROWPHASE_BATCH_SIZE == 8
+const char* const CollisionNarrowphase::INSTRUCTION_SET = "AVX2";
+#elif SW_NARROWPHASE_BATCH_SIZE == 4
+const char* const CollisionNarrowphase::INSTRUCTION_SET = "SSE2";
+#else
+const char* const CollisionNarrowphase::INSTRUCTION_SET = "Scalar";
+#endif
+
+///
+/// Find the candidate pairs whose bounding boxes overlap
+///
+/// @param boxes The bounding boxes referred to by the pairs
+/// @param candidates The candidate pairs, e.g. found by the collision grid
+/// @return The overlapping pairs in the order of the candidates; Touching boxes overlap.
+/// @note The returned buffer is reused by the next call, and no memory is allocated once the buffers have grown.
+///
+const std::vector<CollisionBroadphase::Pair>& CollisionNarrowphase::findCollisions(const CollisionBroadphase::AABB* boxes, const std::vector<CollisionBroadphase::Pair>& candidates)
+{
+    SW_PROFILE_SCOPE(CollisionNarrowphase);
+
+    uint32_t count = static_cast<uint32_t>(candidates.size());
+
+    this->hits.clear();
+
+    // Gather the boxes of each pair into the SoA buffers
+    for (auto buffer : {&this->minX1, &this->minY1, &this->maxX1, &this->maxY1, &this->minX2, &this->minY2, &this->maxX2, &this->maxY2})
+    {
+        buffer->resize(count);
+    }
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const CollisionBroadphase::AABB& first = boxes[candidates[index].first];
+
+        const CollisionBroadphase::AABB& second = boxes[candidates[index].second];
+
+        this->minX1[index] = first.minX;
+
+        this->minY1[index] = first.minY;
+
+        this->maxX1[index] = first.maxX;
+
+        this->maxY1[index] = first.maxY;
+
+        this->minX2[index] = second.minX;
+
+        this->minY2[index] = second.minY;
+
+        this->maxX2[index] = second.maxX;
+
+        this->maxY2[index] = second.maxY;
+    }
+
+    // Test full batches and compact the hits
+    uint32_t index = 0;
+
+    for (; index + SW_NARROWPHASE_BATCH_SIZE <= count; index += SW_NARROWPHASE_BATCH_SIZE)
+    {
+        uint32_t mask = this->testBatch(index);
+
+        for (uint32_t lane = 0; mask != 0; lane++, mask >>= 1)
+        {
+            if (mask & 1)
+            {
+                this->hits.push_back(candidates[index + lane]);
+            }
+        }
+    }
+
+    // Test the remaining pairs one at a time
+    for (; index < count; index++)
+    {
+        if (this->test(index))
+        {
+            this->hits.push_back(candidates[index]);
+        }
+    }
+
+    return this->hits;
+}
+
+///
+/// [Private Helper] Test a batch of candidates starting at the given index
+///
+/// @param index The index of the first candidate in the batch
+/// @return A bit mask of the candidates in the batch whose boxes overlap.
+///
+uint32_t CollisionNarrowphase::testBatch(uint32_t index) const
+{
+#if SW_NARROWPHASE_BATCH_SIZE == 8
+    __m256 overlapsX1 = _mm256_cmp_ps(_mm256_loadu_ps(&this->minX1[index]), _mm256_loadu_ps(&this->maxX2[index]), _CMP_LE_OQ);
+
+    __m256 overlapsX2 = _mm256_cmp_ps(_mm256_loadu_ps(&this->minX2[index]), _mm256_loadu_ps(&this->maxX1[index]), _CMP_LE_OQ);
+
+    __m256 overlapsY1 = _mm256_cmp_ps(_mm256_loadu_ps(&this->minY1[index]), _mm256_loadu_ps(&this->maxY2[index]), _CMP_LE_OQ);
+
+    __m256 overlapsY2 = _mm256_cmp_ps(_mm256_loadu_ps(&this->minY2[index]), _mm256_loadu_ps(&this->maxY1[index]), _CMP_LE_OQ);
+
+    __m256 overlaps = _mm256_and_ps(_mm256_and_ps(overlapsX1, overlapsX2), _mm256_and_ps(overlapsY1, overlapsY2));
+
+    return static_cast<uint32_t>(_mm256_movemask_ps(overlaps));
+#elif SW_NARROWPHASE_BATCH_SIZE == 4
+    __m128 overlapsX1 = _mm_cmple_ps(_mm_loadu_ps(&this->minX1[index]), _mm_loadu_ps(&this->maxX2[index]));
+
+    __m128 overlapsX2 = _mm_cmple_ps(_mm_loadu_ps(&this->minX2[index]), _mm_loadu_ps(&this->maxX1[index]));
+
+    __m128 overlapsY1 = _mm_cmple_ps(_mm_loadu_ps(&this->minY1[index]), _mm_loadu_ps(&this->maxY2[index]));
+
+    __m128 overlapsY2 = _mm_cmple_ps(_mm_loadu_ps(&this->minY2[index]), _mm_loadu_ps(&this->maxY1[index]));
+
+    __m128 overlaps = _mm_and_ps(_mm_and_ps(overlapsX1, overlapsX2), _mm_and_ps(overlapsY1, overlapsY2));
+
+    return static_cast<uint32_t>(_mm_movemask_ps(overlaps));
+#else
+    return this->test(index) ? 1 : 0;
+#endif
+}
+
+///
+/// [Private Helper] Test a single candidate
+///
+bool CollisionNarrowphase::test(uint32_t index) const
+{
+    return this->minX1[index] <= this->maxX2[index] && this->minX2[index] <= this->maxX1[index] &&
+           this->minY1[index] <= this->maxY2[index] && this->minY2[index] <= this->maxY1[index];
+}
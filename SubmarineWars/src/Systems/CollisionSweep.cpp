@@ -0,0 +1,188 @@
+//
+//  CollisionSweep.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionSweep.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+#include <math.h>
+
+///
+/// Stretch the boxes of the fast colliders over their paths during the tick
+///
+/// @param boxes The bounding boxes of all colliders at the end of the tick
+/// @param motions The velocity of each collider
+/// @param count The number of colliders
+/// @param ms The duration of the tick in milliseconds
+/// @return The boxes to hand to the broadphase; Slow colliders keep their boxes.
+/// @note The returned buffer is reused by the next call.
+///
+const std::vector<CollisionSweep::AABB>& CollisionSweep::build(const AABB* boxes, const Motion* motions, uint32_t count, float ms)
+{
+    SW_PROFILE_SCOPE(CollisionBroadphase);
+
+    this->displacementsX.resize(count);
+
+    this->displacementsY.resize(count);
+
+    this->fast.resize(count);
+
+    this->swept.assign(boxes, boxes + count);
+
+    this->numFastColliders = 0;
+
+    float threshold = this->speedThreshold * this->speedThreshold;
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const Motion& motion = motions[index];
+
+        // Compare squared speeds to avoid the square root
+        bool fast = motion.vx * motion.vx + motion.vy * motion.vy > threshold;
+
+        this->fast[index] = fast;
+
+        // Slow colliders rest at their end positions, which their unstretched boxes cover
+        if (!fast)
+        {
+            this->displacementsX[index] = 0;
+
+            this->displacementsY[index] = 0;
+
+            continue;
+        }
+
+        float dx = motion.vx * ms / 1000;
+
+        float dy = motion.vy * ms / 1000;
+
+        this->displacementsX[index] = dx;
+
+        this->displacementsY[index] = dy;
+
+        this->numFastColliders++;
+
+        // The box at the start of the tick lies one displacement behind
+        AABB& box = this->swept[index];
+
+        box.minX -= std::max(dx, 0.f);
+
+        box.maxX -= std::min(dx, 0.f);
+
+        box.minY -= std::max(dy, 0.f);
+
+        box.maxY -= std::min(dy, 0.f);
+    }
+
+    return this->swept;
+}
+
+///
+/// Find the candidate pairs that touch during the tick
+///
+/// @param boxes The bounding boxes of all colliders at the end of the tick, as passed to `build()`
+/// @param candidates The candidate pairs found by the broadphase in the stretched boxes
+/// @return The pairs that touch in the order of the candidates; Pairs of slow colliders are tested at the end of the tick.
+/// @note The returned buffer is reused by the next call.
+///
+const std::vector<CollisionSweep::Impact>& CollisionSweep::findImpacts(const AABB* boxes, const std::vector<CollisionBroadphase::Pair>& candidates)
+{
+    SW_PROFILE_SCOPE(CollisionNarrowphase);
+
+    this->impacts.clear();
+
+    for (const CollisionBroadphase::Pair& candidate : candidates)
+    {
+        uint32_t first = candidate.first;
+
+        uint32_t second = candidate.second;
+
+        const AABB& a = boxes[first];
+
+        const AABB& b = boxes[second];
+
+        // Slow pairs are tested where they stand
+        if (!this->fast[first] && !this->fast[second])
+        {
+            if (a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY)
+            {
+                this->impacts.push_back({first, second, 1.f});
+            }
+
+            continue;
+        }
+
+        // Sweep the first box relative to the second one from their start positions
+        float dx1 = this->displacementsX[first], dy1 = this->displacementsY[first];
+
+        float dx2 = this->displacementsX[second], dy2 = this->displacementsY[second];
+
+        AABB start1 = {a.minX - dx1, a.minY - dy1, a.maxX - dx1, a.maxY - dy1};
+
+        AABB start2 = {b.minX - dx2, b.minY - dy2, b.maxX - dx2, b.maxY - dy2};
+
+        float time = 0;
+
+        if (CollisionSweep::sweep(start1, dx1 - dx2, dy1 - dy2, start2, &time))
+        {
+            this->impacts.push_back({first, second, time});
+        }
+    }
+
+    return this->impacts;
+}
+
+///
+/// Sweep a moving box against a box at rest
+///
+/// @param box The moving box at the start of the tick
+/// @param dx The distance moved along the x-axis during the tick
+/// @param dy The distance moved along the y-axis during the tick
+/// @param target The box at rest
+/// @param time The fraction of the tick at which the boxes first touch on return; 0 if they touch at the start
+/// @return `true` if the boxes touch during the tick, `false` otherwise.
+///
+bool CollisionSweep::sweep(const AABB& box, float dx, float dy, const AABB& target, float* time)
+{
+    float enter = 0;
+
+    float exit = 1;
+
+    // A convenient lambda function that narrows the interval of contact along one axis
+    auto narrow = [&] (float min, float max, float targetMin, float targetMax, float distance) -> bool
+    {
+        if (distance == 0)
+        {
+            // The boxes never touch if they are apart along an axis they do not move along
+            return min <= targetMax && targetMin <= max;
+        }
+
+        float t0 = (targetMin - max) / distance;
+
+        float t1 = (targetMax - min) / distance;
+
+        if (distance < 0)
+        {
+            std::swap(t0, t1);
+        }
+
+        enter = std::max(enter, t0);
+
+        exit = std::min(exit, t1);
+
+        return enter <= exit;
+    };
+
+    if (!narrow(box.minX, box.maxX, target.minX, target.maxX, dx) || !narrow(box.minY, box.maxY, target.minY, target.maxY, dy))
+    {
+        return false;
+    }
+
+    *time = enter;
+
+    return true;
+}
@@ -0,0 +1,131 @@
+//
+//  CollisionSweep.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionSweep_hpp
+#define CollisionSweep_hpp
+
+#include "CollisionBroadphase.hpp"
+#include <vector>
+#include <stdint.h>
+
+/// Continuous collision detection for fast colliders such as torpedoes and missiles
+///
+/// A collider that moves farther than a thin target in a single tick jumps over it
+/// if only its boxes at the end of the ticks are tested.
+/// The box of each fast collider is therefore stretched over its whole path during the tick before the broadphase,
+/// and each candidate pair with a fast collider is swept: the boxes move linearly from their start to their end positions,
+/// and the pair hits if they touch at any time during the tick.
+/// Slow colliders rest at their end positions during the sweep, so the broadphase never misses a pair the sweep would hit.
+/// The simulation can thus run at a lower fixed rate without losing hits.
+class CollisionSweep
+{
+public:
+    /// An axis-aligned bounding box
+    using AABB = CollisionBroadphase::AABB;
+
+    /// The velocity of a collider in pixels per second
+    struct Motion
+    {
+        float vx;
+
+        float vy;
+    };
+
+    /// A pair of colliders that touch during the tick
+    struct Impact
+    {
+        /// The smaller index
+        uint32_t first;
+
+        /// The larger index
+        uint32_t second;
+
+        /// The fraction of the tick in [0, 1] at which the boxes first touch; 1 for a pair of slow colliders
+        float time;
+    };
+
+    /// The default speed in pixels per second above which a collider is swept; 4 pixels per frame at 60 FPS
+    static constexpr float DEF_SPEED_THRESHOLD = 240.f;
+
+    ///
+    /// Stretch the boxes of the fast colliders over their paths during the tick
+    ///
+    /// @param boxes The bounding boxes of all colliders at the end of the tick
+    /// @param motions The velocity of each collider
+    /// @param count The number of colliders
+    /// @param ms The duration of the tick in milliseconds
+    /// @return The boxes to hand to the broadphase; Slow colliders keep their boxes.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    const std::vector<AABB>& build(const AABB* boxes, const Motion* motions, uint32_t count, float ms);
+
+    ///
+    /// Find the candidate pairs that touch during the tick
+    ///
+    /// @param boxes The bounding boxes of all colliders at the end of the tick, as passed to `build()`
+    /// @param candidates The candidate pairs found by the broadphase in the stretched boxes
+    /// @return The pairs that touch in the order of the candidates; Pairs of slow colliders are tested at the end of the tick.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    const std::vector<Impact>& findImpacts(const AABB* boxes, const std::vector<CollisionBroadphase::Pair>& candidates);
+
+    ///
+    /// Sweep a moving box against a box at rest
+    ///
+    /// @param box The moving box at the start of the tick
+    /// @param dx The distance moved along the x-axis during the tick
+    /// @param dy The distance moved along the y-axis during the tick
+    /// @param target The box at rest
+    /// @param time The fraction of the tick at which the boxes first touch on return; 0 if they touch at the start
+    /// @return `true` if the boxes touch during the tick, `false` otherwise.
+    ///
+    static bool sweep(const AABB& box, float dx, float dy, const AABB& target, float* time);
+
+    ///
+    /// Set the speed above which a collider is swept
+    ///
+    /// @param threshold The speed in pixels per second; Pass 0 to sweep all moving colliders.
+    ///
+    inline void setSpeedThreshold(float threshold)
+    {
+        this->speedThreshold = threshold;
+    }
+
+    ///
+    /// [FAST] Get the number of fast colliders in the last build
+    ///
+    /// @note The caller may skip the sweep and use the narrow phase when no collider is fast.
+    ///
+    inline uint32_t getNumFastColliders() const
+    {
+        return this->numFastColliders;
+    }
+
+private:
+    /// The speed above which a collider is swept
+    float speedThreshold = DEF_SPEED_THRESHOLD;
+
+    /// The distance moved by each collider during the tick; 0 for slow colliders
+    std::vector<float> displacementsX;
+
+    std::vector<float> displacementsY;
+
+    /// Indicates whether each collider is swept
+    std::vector<uint8_t> fast;
+
+    /// The number of fast colliders
+    uint32_t numFastColliders = 0;
+
+    /// The stretched boxes
+    std::vector<AABB> swept;
+
+    /// The buffer of pairs that touch
+    std::vector<Impact> impacts;
+};
+
+#endif /* CollisionSweep_hpp */
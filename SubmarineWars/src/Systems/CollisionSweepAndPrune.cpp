@@ -0,0 +1,187 @@
+//
+//  CollisionSweepAndPrune.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-11.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "CollisionSweepAndPrune.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+#include <math.h>
+
+///
+/// Reserve memory for the given number of colliders
+///
+void CollisionSweepAndPrune::reserve(uint32_t capacity)
+{
+    this->endpoints.reserve(2 * capacity);
+
+    this->active.reserve(capacity);
+
+    this->activeIndices.reserve(capacity);
+
+    this->pairs.reserve(capacity);
+}
+
+///
+/// Update the endpoint list with the bounding boxes of this frame
+///
+/// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+/// @param count The number of boxes
+/// @note Entries that keep their indices across frames keep their places in the list,
+///       so the list only needs a few swaps when the colliders move a little.
+///
+void CollisionSweepAndPrune::build(const AABB* boxes, uint32_t count)
+{
+    SW_PROFILE_SCOPE(CollisionBroadphase);
+
+    // Drop the endpoints of entries that are gone
+    if (count < this->count)
+    {
+        auto removed = [count] (const Endpoint& endpoint) -> bool
+        {
+            return (endpoint.entry & ~LOWER) >= count;
+        };
+
+        this->endpoints.erase(std::remove_if(this->endpoints.begin(), this->endpoints.end(), removed), this->endpoints.end());
+    }
+
+    size_t numSorted = this->endpoints.size();
+
+    // Append the endpoints of new entries
+    for (uint32_t index = this->count; index < count; index++)
+    {
+        this->endpoints.push_back({0, index | LOWER});
+
+        this->endpoints.push_back({0, index});
+    }
+
+    // Pick up the positions of this frame
+    for (auto& endpoint : this->endpoints)
+    {
+        const AABB& box = boxes[endpoint.entry & ~LOWER];
+
+        endpoint.value = (endpoint.entry & LOWER) ? box.minX : box.maxX;
+
+        // NaN compares false to everything and would stop the insertion sort, so such boxes are moved out of the way
+        if (isnan(endpoint.value))
+        {
+            endpoint.value = -INFINITY;
+        }
+    }
+
+    // The old endpoints are nearly sorted, so an insertion sort restores their order with a few swaps
+    this->numSwaps = 0;
+
+    for (size_t index = 1; index < numSorted; index++)
+    {
+        Endpoint endpoint = this->endpoints[index];
+
+        size_t position = index;
+
+        while (position > 0 && CollisionSweepAndPrune::precedes(endpoint, this->endpoints[position - 1]))
+        {
+            this->endpoints[position] = this->endpoints[position - 1];
+
+            position--;
+
+            this->numSwaps++;
+        }
+
+        this->endpoints[position] = endpoint;
+    }
+
+    // New endpoints are in no particular order, so they are sorted on their own and merged in
+    if (numSorted < this->endpoints.size())
+    {
+        auto middle = this->endpoints.begin() + numSorted;
+
+        std::sort(middle, this->endpoints.end(), CollisionSweepAndPrune::precedes);
+
+        std::inplace_merge(this->endpoints.begin(), middle, this->endpoints.end(), CollisionSweepAndPrune::precedes);
+    }
+
+    this->boxes = boxes;
+
+    this->count = count;
+}
+
+///
+/// Find all pairs of entries whose boxes overlap
+///
+/// @return The candidate pairs; each pair is reported once.
+/// @note The returned buffer is reused by the next call.
+///       The boxes passed to `build()` must still be valid.
+///
+const std::vector<CollisionBroadphase::Pair>& CollisionSweepAndPrune::findCandidatePairs()
+{
+    SW_PROFILE_SCOPE(CollisionBroadphase);
+
+    this->pairs.clear();
+
+    this->active.clear();
+
+    this->activeIndices.assign(this->count, uint32_t(INACTIVE));
+
+    for (const auto& endpoint : this->endpoints)
+    {
+        uint32_t entry = endpoint.entry & ~LOWER;
+
+        if (endpoint.entry & LOWER)
+        {
+            // Guard: Colliders that collide with nothing never enter the sweep
+            if (!this->isCollidable(entry))
+            {
+                continue;
+            }
+
+            // The box enters the sweep and overlaps all active boxes on the x-axis
+            const AABB& box = this->boxes[entry];
+
+            for (auto other : this->active)
+            {
+                // Layers that never collide cost a bit test
+                if (!this->canCollide(entry, other))
+                {
+                    continue;
+                }
+
+                const AABB& otherBox = this->boxes[other];
+
+                if (box.minY <= otherBox.maxY && otherBox.minY <= box.maxY)
+                {
+                    this->pairs.push_back({std::min(entry, other), std::max(entry, other)});
+                }
+            }
+
+            this->activeIndices[entry] = static_cast<uint32_t>(this->active.size());
+
+            this->active.push_back(entry);
+        }
+        else
+        {
+            // The box leaves the sweep
+            uint32_t index = this->activeIndices[entry];
+
+            // Guard: The box never entered, or its upper endpoint is NaN and it leaves before it enters
+            if (index == INACTIVE)
+            {
+                continue;
+            }
+
+            uint32_t last = this->active.back();
+
+            this->active[index] = last;
+
+            this->activeIndices[last] = index;
+
+            this->active.pop_back();
+
+            this->activeIndices[entry] = INACTIVE;
+        }
+    }
+
+    return this->pairs;
+}
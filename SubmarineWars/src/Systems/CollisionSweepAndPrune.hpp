@@ -0,0 +1,111 @@
+//
+//  CollisionSweepAndPrune.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-11.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef CollisionSweepAndPrune_hpp
+#define CollisionSweepAndPrune_hpp
+
+#include "CollisionBroadphase.hpp"
+
+/// A sort-and-sweep broadphase along the x-axis
+///
+/// The interval endpoints of all boxes on the x-axis are kept in a list that stays sorted between frames.
+/// Submarines and fish move a few pixels per frame, so the list is nearly sorted at the start of a frame,
+/// and an insertion sort restores the order in close to linear time.
+/// A sweep over the sorted endpoints then reports the boxes whose x-intervals overlap and whose y-intervals also overlap.
+class CollisionSweepAndPrune: public CollisionBroadphase
+{
+public:
+    ///
+    /// Reserve memory for the given number of colliders
+    ///
+    void reserve(uint32_t capacity);
+
+    ///
+    /// Update the endpoint list with the bounding boxes of this frame
+    ///
+    /// @param boxes The bounding boxes of all colliders; Entry `i` refers to `boxes[i]`
+    /// @param count The number of boxes
+    /// @note Entries that keep their indices across frames keep their places in the list,
+    ///       so the list only needs a few swaps when the colliders move a little.
+    ///
+    void build(const AABB* boxes, uint32_t count) override;
+
+    ///
+    /// Find all pairs of entries whose boxes overlap
+    ///
+    /// @return The candidate pairs; each pair is reported once.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    const std::vector<Pair>& findCandidatePairs() override;
+
+    ///
+    /// Get the type of this broadphase
+    ///
+    Type getType() const override
+    {
+        return Type::SweepAndPrune;
+    }
+
+    ///
+    /// [FAST] Get the number of endpoint swaps done by the last build
+    ///
+    inline uint32_t getNumSwaps() const
+    {
+        return this->numSwaps;
+    }
+
+private:
+    /// An endpoint of a box on the x-axis
+    struct Endpoint
+    {
+        /// The x-coordinate of the endpoint
+        float value;
+
+        /// The entry index; The most significant bit is set for the lower endpoint
+        uint32_t entry;
+    };
+
+    /// The flag that marks a lower endpoint
+    static constexpr uint32_t LOWER = 0x80000000;
+
+    /// Marks an entry that is not in the active list
+    static constexpr uint32_t INACTIVE = UINT32_MAX;
+
+    /// The endpoints sorted by their x-coordinates
+    std::vector<Endpoint> endpoints;
+
+    /// The boxes of this frame
+    const AABB* boxes = nullptr;
+
+    /// The number of boxes of this frame
+    uint32_t count = 0;
+
+    /// The number of endpoint swaps done by the last build
+    uint32_t numSwaps = 0;
+
+    /// Entries whose x-intervals contain the sweep position
+    std::vector<uint32_t> active;
+
+    /// The position of each entry in the active list
+    std::vector<uint32_t> activeIndices;
+
+    /// The buffer of candidate pairs
+    std::vector<Pair> pairs;
+
+    ///
+    /// [Private Helper] Check whether the first endpoint must precede the second one
+    ///
+    /// @note Lower endpoints precede upper endpoints at the same position, so that touching boxes overlap.
+    ///
+    static inline bool precedes(const Endpoint& first, const Endpoint& second)
+    {
+        return first.value < second.value || (first.value == second.value && (first.entry & LOWER) > (second.entry & LOWER));
+    }
+};
+
+#endif /* CollisionSweepAndPrune_hpp */
@@ -0,0 +1,246 @@
+//
+//  ContactCache.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-13.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "ContactCache.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include <algorithm>
+
+///
+/// Reserve memory for the given number of contacts
+///
+void ContactCache::reserve(uint32_t capacity)
+{
+    this->contacts.reserve(capacity);
+
+    this->events.reserve(capacity);
+
+    // Keep the load factor at or below one half
+    uint32_t numSlots = ContactCache::MIN_NUM_SLOTS;
+
+    while (numSlots < 2 * capacity)
+    {
+        numSlots *= 2;
+    }
+
+    if (numSlots > this->slots.size())
+    {
+        this->rehash(numSlots);
+    }
+}
+
+///
+/// Feed the overlapping pairs of this frame
+///
+/// @param overlaps Pairs of entity identifiers that overlap in this frame, in any order; Duplicates are ignored.
+/// @param count The number of pairs
+/// @return The changes of the contacts since the last frame, including the exits caused by `removeEntity()`.
+/// @note The returned buffer is reused by the next call.
+///
+const std::vector<ContactCache::Event>& ContactCache::update(const CollisionBroadphase::Pair* overlaps, uint32_t count)
+{
+    SW_PROFILE_SCOPE(CollisionNarrowphase);
+
+    this->frame++;
+
+    this->events.assign(this->pendingExits.begin(), this->pendingExits.end());
+
+    this->pendingExits.clear();
+
+    // Pass 1: Stamp the contacts that persist and insert the new ones
+    for (uint32_t index = 0; index < count; index++)
+    {
+        uint64_t key = ContactCache::makeKey(overlaps[index].first, overlaps[index].second);
+
+        // Grow the table before it becomes more than half full
+        if (2 * (this->contacts.size() + 1) > this->slots.size())
+        {
+            this->rehash(std::max(uint32_t(ContactCache::MIN_NUM_SLOTS), 2 * static_cast<uint32_t>(this->slots.size())));
+        }
+
+        uint32_t slot = this->findSlot(key);
+
+        Event event = {Event::Type::Enter, static_cast<uint32_t>(key >> 32), static_cast<uint32_t>(key)};
+
+        if (this->slots[slot] == EMPTY)
+        {
+            this->contacts.push_back({key, this->frame});
+
+            this->slots[slot] = static_cast<uint32_t>(this->contacts.size());
+
+            this->events.push_back(event);
+
+            continue;
+        }
+
+        Contact& contact = this->contacts[this->slots[slot] - 1];
+
+        // Guard: The pair has been seen in this frame already
+        if (contact.frame == this->frame)
+        {
+            continue;
+        }
+
+        contact.frame = this->frame;
+
+        if (this->reportsStay)
+        {
+            event.type = Event::Type::Stay;
+
+            this->events.push_back(event);
+        }
+    }
+
+    // Pass 2: Remove the contacts that were not seen in this frame
+    uint32_t index = 0;
+
+    while (index < this->contacts.size())
+    {
+        const Contact& contact = this->contacts[index];
+
+        if (contact.frame == this->frame)
+        {
+            index++;
+
+            continue;
+        }
+
+        this->events.push_back({Event::Type::Exit, static_cast<uint32_t>(contact.key >> 32), static_cast<uint32_t>(contact.key)});
+
+        // The last contact takes its place, so the same index is checked again
+        this->removeContact(index);
+    }
+
+    return this->events;
+}
+
+///
+/// Drop all contacts of an entity that has been removed
+///
+/// @param entity The identifier of the removed entity
+/// @note The exits are reported by the next update,
+///       so that a recycled identifier that overlaps the same entity enters again.
+///
+void ContactCache::removeEntity(uint32_t entity)
+{
+    uint32_t index = 0;
+
+    while (index < this->contacts.size())
+    {
+        const Contact& contact = this->contacts[index];
+
+        uint32_t first = static_cast<uint32_t>(contact.key >> 32);
+
+        uint32_t second = static_cast<uint32_t>(contact.key);
+
+        if (first != entity && second != entity)
+        {
+            index++;
+
+            continue;
+        }
+
+        this->pendingExits.push_back({Event::Type::Exit, first, second});
+
+        this->removeContact(index);
+    }
+}
+
+///
+/// Drop all contacts without reporting any exits
+///
+void ContactCache::clear()
+{
+    this->contacts.clear();
+
+    std::fill(this->slots.begin(), this->slots.end(), uint32_t(EMPTY));
+
+    this->events.clear();
+
+    this->pendingExits.clear();
+}
+
+///
+/// [Private Helper] Find the slot of a key
+///
+/// @return The slot that holds the key, or the empty slot where it would be inserted.
+///
+uint32_t ContactCache::findSlot(uint64_t key) const
+{
+    uint32_t slot = this->getHomeSlot(key);
+
+    while (this->slots[slot] != EMPTY && this->contacts[this->slots[slot] - 1].key != key)
+    {
+        slot = (slot + 1) & this->mask;
+    }
+
+    return slot;
+}
+
+///
+/// [Private Helper] Empty a slot and shift back the slots that follow it
+///
+/// @note Shifting instead of leaving a tombstone keeps the probe sequences short without periodic cleanups.
+///
+void ContactCache::eraseSlot(uint32_t slot)
+{
+    uint32_t hole = slot;
+
+    uint32_t next = (hole + 1) & this->mask;
+
+    while (this->slots[next] != EMPTY)
+    {
+        uint32_t home = this->getHomeSlot(this->contacts[this->slots[next] - 1].key);
+
+        // The entry may fill the hole if the hole lies between its home slot and its current slot
+        if (((next - home) & this->mask) >= ((next - hole) & this->mask))
+        {
+            this->slots[hole] = this->slots[next];
+
+            hole = next;
+        }
+
+        next = (next + 1) & this->mask;
+    }
+
+    this->slots[hole] = EMPTY;
+}
+
+///
+/// [Private Helper] Remove the contact at the given index from both the array and the table
+///
+void ContactCache::removeContact(uint32_t index)
+{
+    this->eraseSlot(this->findSlot(this->contacts[index].key));
+
+    uint32_t last = static_cast<uint32_t>(this->contacts.size()) - 1;
+
+    // Move the last contact into the gap and point its slot to the new index
+    if (index != last)
+    {
+        this->contacts[index] = this->contacts[last];
+
+        this->slots[this->findSlot(this->contacts[index].key)] = index + 1;
+    }
+
+    this->contacts.pop_back();
+}
+
+///
+/// [Private Helper] Resize the hash table and reinsert all contacts
+///
+void ContactCache::rehash(uint32_t numSlots)
+{
+    this->slots.assign(numSlots, uint32_t(EMPTY));
+
+    this->mask = numSlots - 1;
+
+    for (uint32_t index = 0; index < this->contacts.size(); index++)
+    {
+        this->slots[this->findSlot(this->contacts[index].key)] = index + 1;
+    }
+}
@@ -0,0 +1,177 @@
+//
+//  ContactCache.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-13.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef ContactCache_hpp
+#define ContactCache_hpp
+
+#include "CollisionBroadphase.hpp"
+#include <vector>
+#include <stdint.h>
+
+/// Remembers which pairs of entities overlap across frames
+///
+/// Contacts are keyed by the pair of entity identifiers, the smaller one first,
+/// and live in an open-addressing hash table with linear probing that points into a dense array of contacts.
+/// Each frame the overlapping pairs are fed in, and only the changes come out:
+/// a pair that starts to overlap enters, and a pair that stops overlapping exits.
+/// A long overlap, e.g. an explosion sitting over a school of fish, thus generates work only once.
+class ContactCache
+{
+public:
+    /// A change of a contact
+    struct Event
+    {
+        /// Enumerates all kinds of changes
+        enum class Type: uint8_t
+        {
+            /// The pair starts to overlap in this frame
+            Enter,
+
+            /// The pair still overlaps; Only reported if enabled
+            Stay,
+
+            /// The pair no longer overlaps, or one of its entities has been removed
+            Exit
+        };
+
+        /// The kind of the change
+        Type type;
+
+        /// The smaller entity identifier
+        uint32_t first;
+
+        /// The larger entity identifier
+        uint32_t second;
+    };
+
+    ///
+    /// Reserve memory for the given number of contacts
+    ///
+    void reserve(uint32_t capacity);
+
+    ///
+    /// Feed the overlapping pairs of this frame
+    ///
+    /// @param overlaps Pairs of entity identifiers that overlap in this frame, in any order; Duplicates are ignored.
+    /// @param count The number of pairs
+    /// @return The changes of the contacts since the last frame, including the exits caused by `removeEntity()`.
+    /// @note The returned buffer is reused by the next call.
+    ///
+    const std::vector<Event>& update(const CollisionBroadphase::Pair* overlaps, uint32_t count);
+
+    ///
+    /// Drop all contacts of an entity that has been removed
+    ///
+    /// @param entity The identifier of the removed entity
+    /// @note The exits are reported by the next update,
+    ///       so that a recycled identifier that overlaps the same entity enters again.
+    ///
+    void removeEntity(uint32_t entity);
+
+    ///
+    /// Drop all contacts without reporting any exits
+    ///
+    void clear();
+
+    ///
+    /// Set whether contacts that persist are reported every frame
+    ///
+    /// @param enabled Pass `true` to report `Stay` events; Disabled by default.
+    ///
+    inline void setReportsStay(bool enabled)
+    {
+        this->reportsStay = enabled;
+    }
+
+    ///
+    /// [FAST] Get the number of pairs that overlap
+    ///
+    inline uint32_t getNumContacts() const
+    {
+        return static_cast<uint32_t>(this->contacts.size());
+    }
+
+private:
+    /// A pair of entities that overlap
+    struct Contact
+    {
+        /// The smaller identifier in the upper half and the larger one in the lower half
+        uint64_t key;
+
+        /// The frame in which the pair last overlapped
+        uint32_t frame;
+    };
+
+    /// Marks an empty slot in the hash table
+    static constexpr uint32_t EMPTY = 0;
+
+    /// The minimum number of slots in the hash table
+    static constexpr uint32_t MIN_NUM_SLOTS = 64;
+
+    /// Contacts in no particular order
+    std::vector<Contact> contacts;
+
+    /// The hash table; Each slot holds the index of a contact plus one, or `EMPTY`
+    std::vector<uint32_t> slots;
+
+    /// The number of slots minus one; The number of slots is a power of two
+    uint32_t mask = 0;
+
+    /// The current frame number
+    uint32_t frame = 0;
+
+    /// Indicates whether contacts that persist are reported
+    bool reportsStay = false;
+
+    /// The buffer of changes
+    std::vector<Event> events;
+
+    /// Exits caused by removed entities that are reported by the next update
+    std::vector<Event> pendingExits;
+
+    ///
+    /// [Private Helper] Make the key of a pair
+    ///
+    static inline uint64_t makeKey(uint32_t first, uint32_t second)
+    {
+        return first < second ? (static_cast<uint64_t>(first) << 32) | second : (static_cast<uint64_t>(second) << 32) | first;
+    }
+
+    ///
+    /// [Private Helper] Get the home slot of a key
+    ///
+    inline uint32_t getHomeSlot(uint64_t key) const
+    {
+        // Fibonacci hashing spreads consecutive identifiers over the table
+        return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & this->mask;
+    }
+
+    ///
+    /// [Private Helper] Find the slot of a key
+    ///
+    /// @return The slot that holds the key, or the empty slot where it would be inserted.
+    ///
+    uint32_t findSlot(uint64_t key) const;
+
+    ///
+    /// [Private Helper] Empty a slot and shift back the slots that follow it
+    ///
+    void eraseSlot(uint32_t slot);
+
+    ///
+    /// [Private Helper] Remove the contact at the given index from both the array and the table
+    ///
+    void removeContact(uint32_t index);
+
+    ///
+    /// [Private Helper] Resize the hash table and reinsert all contacts
+    ///
+    void rehash(uint32_t numSlots);
+};
+
+#endif /* ContactCache_hpp */
@@ -0,0 +1,124 @@
+//
+//  ShaderProgram.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "ShaderProgram.hpp"
+#include <fstream>
+#include <sstream>
+#include <string>
+
+///
+/// [Helper] Compile a shader from a file
+///
+/// @param type The type of the shader
+/// @param path The path to the shader source
+/// @return The shader on success, 0 otherwise.
+///
+static GLuint compileShader(GLenum type, const char* path)
+{
+    std::ifstream file(path);
+
+    // Guard: The source must be readable
+    if (!file.is_open())
+    {
+        pserror("Failed to open the shader %s.", path);
+
+        return 0;
+    }
+
+    std::stringstream stream;
+
+    stream << file.rdbuf();
+
+    std::string source = stream.str();
+
+    const GLchar* sources[] = { source.c_str() };
+
+    GLuint shader = glCreateShader(type);
+
+    glShaderSource(shader, 1, sources, nullptr);
+
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+    // Guard: The shader must compile
+    if (compiled == GL_FALSE)
+    {
+        GLchar log[512];
+
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+
+        pserror("Failed to compile the shader %s: %s", path, log);
+
+        glDeleteShader(shader);
+
+        return 0;
+    }
+
+    return shader;
+}
+
+///
+/// Compile and link a shader program from files
+///
+/// @param vertexShaderPath The path to the vertex shader
+/// @param fragmentShaderPath The path to the fragment shader
+/// @return The program on success, 0 otherwise.
+/// @note Compile and link errors are logged with the path of the failing shader.
+///
+GLuint loadShaderProgram(const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderPath);
+
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderPath);
+
+    // Guard: Both shaders must compile
+    if (vertexShader == 0 || fragmentShader == 0)
+    {
+        glDeleteShader(vertexShader);
+
+        glDeleteShader(fragmentShader);
+
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+
+    glAttachShader(program, vertexShader);
+
+    glAttachShader(program, fragmentShader);
+
+    glLinkProgram(program);
+
+    // The program keeps the shaders alive
+    glDeleteShader(vertexShader);
+
+    glDeleteShader(fragmentShader);
+
+    GLint linked = GL_FALSE;
+
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    // Guard: The program must link
+    if (linked == GL_FALSE)
+    {
+        GLchar log[512];
+
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+
+        pserror("Failed to link the shaders %s and %s: %s", vertexShaderPath, fragmentShaderPath, log);
+
+        glDeleteProgram(program);
+
+        return 0;
+    }
+
+    return program;
+}
@@ -0,0 +1,24 @@
+//
+//  ShaderProgram.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef ShaderProgram_hpp
+#define ShaderProgram_hpp
+
+#include "Foundations/Foundations.hpp"
+
+///
+/// Compile and link a shader program from files
+///
+/// @param vertexShaderPath The path to the vertex shader
+/// @param fragmentShaderPath The path to the fragment shader
+/// @return The program on success, 0 otherwise.
+/// @note Compile and link errors are logged with the path of the failing shader.
+///
+GLuint loadShaderProgram(const char* vertexShaderPath, const char* fragmentShaderPath);
+
+#endif /* ShaderProgram_hpp */
@@ -0,0 +1,335 @@
+//
+//  SpatialIndex.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "SpatialIndex.hpp"
+#include <algorithm>
+#include <math.h>
+
+/// Private instance
+SpatialIndex* SpatialIndex::instance = nullptr;
+
+/// Get the shared instance
+SpatialIndex* SpatialIndex::shared()
+{
+    if (SpatialIndex::instance == nullptr)
+    {
+        SpatialIndex::instance = new SpatialIndex();
+    }
+
+    return SpatialIndex::instance;
+}
+
+///
+/// Set up the index
+///
+/// @param width The width of the covered area
+/// @param height The height of the covered area
+/// @param cellSize The side length of a grid cell
+/// @param capacity The number of entities to reserve memory for
+/// @return `true` on success, `false` if the given size is invalid.
+/// @note Entities outside the covered area are still found; They are kept in the border cells.
+///
+bool SpatialIndex::init(float width, float height, float cellSize, uint32_t capacity)
+{
+    // Guard: Initialize the grid
+    if (!this->grid.init(width, height, cellSize, capacity))
+    {
+        return false;
+    }
+
+    this->cellSize = cellSize;
+
+    this->boxes.reserve(capacity);
+
+    this->entities.reserve(capacity);
+
+    this->categories.reserve(capacity);
+
+    this->candidates.reserve(capacity);
+
+    this->clear();
+
+    this->build();
+
+    return true;
+}
+
+///
+/// Remove all entities before they are added for a new frame
+///
+void SpatialIndex::clear()
+{
+    this->boxes.clear();
+
+    this->entities.clear();
+
+    this->categories.clear();
+}
+
+///
+/// Add an entity
+///
+/// @param entity The identifier of the entity
+/// @param type The type of the entity in [0, MAX_NUM_TYPES)
+/// @param box The bounding box of the entity
+///
+void SpatialIndex::add(uint32_t entity, uint32_t type, const AABB& box)
+{
+    this->boxes.push_back(box);
+
+    this->entities.push_back(entity);
+
+    // An out of range type matches no mask
+    this->categories.push_back(type < SpatialIndex::MAX_NUM_TYPES ? 1u << type : 0);
+}
+
+///
+/// Rebuild the index with the entities added since the last `clear()`
+///
+void SpatialIndex::build()
+{
+    this->grid.build(this->boxes.data(), static_cast<uint32_t>(this->boxes.size()));
+
+    // Nearest and ray queries stop once they have covered all boxes
+    this->bounds = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    for (const AABB& box : this->boxes)
+    {
+        this->bounds.minX = std::min(this->bounds.minX, box.minX);
+
+        this->bounds.minY = std::min(this->bounds.minY, box.minY);
+
+        this->bounds.maxX = std::max(this->bounds.maxX, box.maxX);
+
+        this->bounds.maxY = std::max(this->bounds.maxY, box.maxY);
+    }
+}
+
+///
+/// Find the entities whose boxes overlap the given box
+///
+/// @param box The box to query
+/// @param types A bit mask of the entity types to find
+/// @param result The identifiers of the entities on return, each reported once in no particular order
+///
+void SpatialIndex::queryAABB(const AABB& box, uint32_t types, std::vector<uint32_t>& result)
+{
+    result.clear();
+
+    this->grid.query(box, this->candidates);
+
+    for (uint32_t entry : this->candidates)
+    {
+        const AABB& other = this->boxes[entry];
+
+        if ((this->categories[entry] & types) != 0 &&
+            other.minX <= box.maxX && box.minX <= other.maxX && other.minY <= box.maxY && box.minY <= other.maxY)
+        {
+            result.push_back(this->entities[entry]);
+        }
+    }
+}
+
+///
+/// Find the entities whose boxes lie within the given distance of a point
+///
+/// @param x The x-coordinate of the point
+/// @param y The y-coordinate of the point
+/// @param radius The distance
+/// @param types A bit mask of the entity types to find
+/// @param result The identifiers of the entities on return, each reported once in no particular order
+///
+void SpatialIndex::queryRadius(float x, float y, float radius, uint32_t types, std::vector<uint32_t>& result)
+{
+    result.clear();
+
+    this->grid.query({x - radius, y - radius, x + radius, y + radius}, this->candidates);
+
+    for (uint32_t entry : this->candidates)
+    {
+        if ((this->categories[entry] & types) != 0 && SpatialIndex::distanceToBox(x, y, this->boxes[entry]) <= radius)
+        {
+            result.push_back(this->entities[entry]);
+        }
+    }
+}
+
+///
+/// Find the entity closest to a point
+///
+/// @param x The x-coordinate of the point
+/// @param y The y-coordinate of the point
+/// @param types A bit mask of the entity types to consider
+/// @param hit The closest entity on return
+/// @param maxDistance Entities farther away are ignored
+/// @return `true` if an entity is found, `false` otherwise.
+/// @note The search starts with the cells around the point and widens until an entity is found,
+///       so the cost depends on the distance to the closest entity rather than the number of entities.
+///
+bool SpatialIndex::nearestOfType(float x, float y, uint32_t types, Hit* hit, float maxDistance)
+{
+    // Guard: The index must not be empty
+    if (this->boxes.empty())
+    {
+        return false;
+    }
+
+    float radius = std::min(this->cellSize, maxDistance);
+
+    while (true)
+    {
+        AABB square = {x - radius, y - radius, x + radius, y + radius};
+
+        this->grid.query(square, this->candidates);
+
+        Hit best = {0, FLT_MAX};
+
+        for (uint32_t entry : this->candidates)
+        {
+            float distance = SpatialIndex::distanceToBox(x, y, this->boxes[entry]);
+
+            if ((this->categories[entry] & types) != 0 && distance < best.distance)
+            {
+                best = {this->entities[entry], distance};
+            }
+        }
+
+        // An entity within the radius lies in the square, so nothing outside the square is closer
+        bool covered = square.minX <= this->bounds.minX && square.minY <= this->bounds.minY &&
+                       square.maxX >= this->bounds.maxX && square.maxY >= this->bounds.maxY;
+
+        if (best.distance <= radius || covered || radius >= maxDistance)
+        {
+            if (best.distance > maxDistance)
+            {
+                return false;
+            }
+
+            *hit = best;
+
+            return true;
+        }
+
+        radius = std::min(2 * radius, maxDistance);
+    }
+}
+
+///
+/// Find the first entity hit by a ray
+///
+/// @param x The x-coordinate of the origin
+/// @param y The y-coordinate of the origin
+/// @param dx The x-component of the direction; need not be normalized
+/// @param dy The y-component of the direction; need not be normalized
+/// @param types A bit mask of the entity types to consider
+/// @param hit The first entity on return; The distance is measured along the ray from the origin.
+/// @param maxDistance The length of the ray
+/// @return `true` if an entity is hit, `false` otherwise.
+/// @note The ray is walked one cell at a time and stops at the first cell that yields a hit.
+///
+bool SpatialIndex::raycast(float x, float y, float dx, float dy, uint32_t types, Hit* hit, float maxDistance)
+{
+    float length = sqrtf(dx * dx + dy * dy);
+
+    // Guard: The index must not be empty and the direction must be valid
+    if (this->boxes.empty() || !(length > 0))
+    {
+        return false;
+    }
+
+    dx /= length;
+
+    dy /= length;
+
+    // Division by zero yields infinities that the slab test handles
+    float inverseDX = 1.f / dx;
+
+    float inverseDY = 1.f / dy;
+
+    // Only walk the part of the ray that crosses the boxes
+    float begin = 0, end = 0;
+
+    if (!SpatialIndex::intersect(x, y, inverseDX, inverseDY, this->bounds, &begin, &end))
+    {
+        return false;
+    }
+
+    end = std::min(end, maxDistance);
+
+    Hit best = {0, FLT_MAX};
+
+    for (float start = begin; start <= end; start += this->cellSize)
+    {
+        float stop = std::min(start + this->cellSize, end);
+
+        float x0 = x + dx * start, y0 = y + dy * start;
+
+        float x1 = x + dx * stop, y1 = y + dy * stop;
+
+        this->grid.query({std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1)}, this->candidates);
+
+        for (uint32_t entry : this->candidates)
+        {
+            float enter = 0, exit = 0;
+
+            if ((this->categories[entry] & types) != 0 &&
+                SpatialIndex::intersect(x, y, inverseDX, inverseDY, this->boxes[entry], &enter, &exit) &&
+                enter <= maxDistance && enter < best.distance)
+            {
+                best = {this->entities[entry], enter};
+            }
+        }
+
+        // A box entered before the end of this step overlaps one of the steps walked so far
+        if (best.distance <= stop)
+        {
+            *hit = best;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+///
+/// [Private Helper] Find the distance from a point to a box
+///
+float SpatialIndex::distanceToBox(float x, float y, const AABB& box)
+{
+    float dx = std::max(std::max(box.minX - x, x - box.maxX), 0.f);
+
+    float dy = std::max(std::max(box.minY - y, y - box.maxY), 0.f);
+
+    return sqrtf(dx * dx + dy * dy);
+}
+
+///
+/// [Private Helper] Intersect a ray with a box
+///
+/// @param enter The distance along the ray at which it enters the box on return; 0 if the origin lies inside the box
+/// @param exit The distance along the ray at which it leaves the box on return
+/// @return `true` if the ray crosses the box in front of the origin, `false` otherwise.
+///
+bool SpatialIndex::intersect(float x, float y, float inverseDX, float inverseDY, const AABB& box, float* enter, float* exit)
+{
+    float tx0 = (box.minX - x) * inverseDX, tx1 = (box.maxX - x) * inverseDX;
+
+    float ty0 = (box.minY - y) * inverseDY, ty1 = (box.maxY - y) * inverseDY;
+
+    // A ray parallel to an axis yields NaN on the slab boundary, which fmax and fmin ignore
+    float near = fmaxf(fmaxf(fminf(tx0, tx1), fminf(ty0, ty1)), 0.f);
+
+    float far = fminf(fmaxf(tx0, tx1), fmaxf(ty0, ty1));
+
+    *enter = near;
+
+    *exit = far;
+
+    return near <= far;
+}
@@ -0,0 +1,182 @@
+//
+//  SpatialIndex.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef SpatialIndex_hpp
+#define SpatialIndex_hpp
+
+#include "CollisionGrid.hpp"
+#include <float.h>
+#include <vector>
+#include <stdint.h>
+
+/// A singleton that answers spatial queries about the entities on screen
+///
+/// The owner of the index adds the bounding box of each entity once per frame and rebuilds the index,
+/// which is backed by a collision grid, so that the entities in a box, within a radius,
+/// closest to a point or along a ray are found without looping over all entities.
+/// Entities are filtered by type with a bit mask, where bit `t` selects the entities of type `t`, e.g. `Collision::eType`.
+/// Results are written to buffers provided by the caller, so a query does not allocate memory once the buffers have grown.
+/// @note Queries see the entities added before the last `build()`, and must be made from the main thread.
+/// @note No system in the game fills the index yet; It is only exercised by the bench.
+class SpatialIndex
+{
+public:
+    /// An axis-aligned bounding box
+    using AABB = CollisionBroadphase::AABB;
+
+    /// The entity found by a nearest or a ray query
+    struct Hit
+    {
+        /// The identifier of the entity
+        uint32_t entity;
+
+        /// The distance from the query point to the box of the entity; 0 if the point lies inside the box
+        float distance;
+    };
+
+    /// Selects the entities of all types
+    static constexpr uint32_t ALL_TYPES = UINT32_MAX;
+
+    /// The maximum number of entity types
+    static constexpr uint32_t MAX_NUM_TYPES = 32;
+
+    /// Get the shared instance
+    static SpatialIndex* shared();
+
+    ///
+    /// Set up the index
+    ///
+    /// @param width The width of the covered area
+    /// @param height The height of the covered area
+    /// @param cellSize The side length of a grid cell
+    /// @param capacity The number of entities to reserve memory for
+    /// @return `true` on success, `false` if the given size is invalid.
+    /// @note Entities outside the covered area are still found; They are kept in the border cells.
+    ///
+    bool init(float width, float height, float cellSize = CollisionBroadphase::DEF_CELL_SIZE, uint32_t capacity = 0);
+
+    ///
+    /// Remove all entities before they are added for a new frame
+    ///
+    void clear();
+
+    ///
+    /// Add an entity
+    ///
+    /// @param entity The identifier of the entity
+    /// @param type The type of the entity in [0, MAX_NUM_TYPES); An entity of another type is never found.
+    /// @param box The bounding box of the entity
+    ///
+    void add(uint32_t entity, uint32_t type, const AABB& box);
+
+    ///
+    /// Rebuild the index with the entities added since the last `clear()`
+    ///
+    void build();
+
+    ///
+    /// Find the entities whose boxes overlap the given box
+    ///
+    /// @param box The box to query
+    /// @param types A bit mask of the entity types to find
+    /// @param result The identifiers of the entities on return, each reported once in no particular order
+    ///
+    void queryAABB(const AABB& box, uint32_t types, std::vector<uint32_t>& result);
+
+    ///
+    /// Find the entities whose boxes lie within the given distance of a point
+    ///
+    /// @param x The x-coordinate of the point
+    /// @param y The y-coordinate of the point
+    /// @param radius The distance
+    /// @param types A bit mask of the entity types to find
+    /// @param result The identifiers of the entities on return, each reported once in no particular order
+    ///
+    void queryRadius(float x, float y, float radius, uint32_t types, std::vector<uint32_t>& result);
+
+    ///
+    /// Find the entity closest to a point
+    ///
+    /// @param x The x-coordinate of the point
+    /// @param y The y-coordinate of the point
+    /// @param types A bit mask of the entity types to consider
+    /// @param hit The closest entity on return
+    /// @param maxDistance Entities farther away are ignored
+    /// @return `true` if an entity is found, `false` otherwise.
+    /// @note The search starts with the cells around the point and widens until an entity is found,
+    ///       so the cost depends on the distance to the closest entity rather than the number of entities.
+    ///
+    bool nearestOfType(float x, float y, uint32_t types, Hit* hit, float maxDistance = FLT_MAX);
+
+    ///
+    /// Find the first entity hit by a ray
+    ///
+    /// @param x The x-coordinate of the origin
+    /// @param y The y-coordinate of the origin
+    /// @param dx The x-component of the direction; need not be normalized
+    /// @param dy The y-component of the direction; need not be normalized
+    /// @param types A bit mask of the entity types to consider
+    /// @param hit The first entity on return; The distance is measured along the ray from the origin.
+    /// @param maxDistance The length of the ray
+    /// @return `true` if an entity is hit, `false` otherwise.
+    /// @note The ray is walked one cell at a time and stops at the first cell that yields a hit.
+    ///
+    bool raycast(float x, float y, float dx, float dy, uint32_t types, Hit* hit, float maxDistance = FLT_MAX);
+
+    ///
+    /// [FAST] Get the number of entities in the index
+    ///
+    inline uint32_t getNumEntities() const
+    {
+        return static_cast<uint32_t>(this->entities.size());
+    }
+
+private:
+    /// Private instance
+    static SpatialIndex* instance;
+
+    /// The grid that holds the entities
+    CollisionGrid grid;
+
+    /// The side length of a grid cell
+    float cellSize = CollisionBroadphase::DEF_CELL_SIZE;
+
+    /// The bounding boxes of the entities
+    std::vector<AABB> boxes;
+
+    /// The identifiers of the entities
+    std::vector<uint32_t> entities;
+
+    /// The type of each entity as a bit mask
+    std::vector<uint32_t> categories;
+
+    /// The union of all boxes at the last build
+    AABB bounds = {0, 0, 0, 0};
+
+    /// Grid entries found by a query
+    std::vector<uint32_t> candidates;
+
+    /// Private constructor
+    SpatialIndex() = default;
+
+    ///
+    /// [Private Helper] Find the distance from a point to a box
+    ///
+    static float distanceToBox(float x, float y, const AABB& box);
+
+    ///
+    /// [Private Helper] Intersect a ray with a box
+    ///
+    /// @param enter The distance along the ray at which it enters the box on return; 0 if the origin lies inside the box
+    /// @param exit The distance along the ray at which it leaves the box on return
+    /// @return `true` if the ray crosses the box in front of the origin, `false` otherwise.
+    ///
+    static bool intersect(float x, float y, float inverseDX, float inverseDY, const AABB& box, float* enter, float* exit);
+};
+
+#endif /* SpatialIndex_hpp */
@@ -0,0 +1,349 @@
+//
+//  SpriteBatch.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "SpriteBatch.hpp"
+#include "ShaderProgram.hpp"
+#include "Foundations/TraceRecorder.hpp"
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+
+/// Private instance
+SpriteBatch* SpriteBatch::instance = nullptr;
+
+/// Get the shared instance
+SpriteBatch* SpriteBatch::shared()
+{
+    if (SpriteBatch::instance == nullptr)
+    {
+        SpriteBatch::instance = new SpriteBatch();
+    }
+
+    return SpriteBatch::instance;
+}
+
+///
+/// Create the buffers and compile the instanced shaders
+///
+/// @param capacity The number of instances to reserve memory for; The buffers grow on demand.
+/// @param vertexShaderPath The path to the vertex shader
+/// @param fragmentShaderPath The path to the fragment shader
+/// @return `true` on success, `false` otherwise.
+/// @note A GL context must be current.
+///
+bool SpriteBatch::init(uint32_t capacity, const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+    // Guard: Compile the shaders
+    if (!this->loadProgram(vertexShaderPath, fragmentShaderPath))
+    {
+        return false;
+    }
+
+    // The unit quad centered at the origin with its texture coordinates
+    static const GLfloat vertices[] =
+    {
+        -0.5f, +0.5f, 0.f,  0.f, 1.f,
+        +0.5f, +0.5f, 0.f,  1.f, 1.f,
+        +0.5f, -0.5f, 0.f,  1.f, 0.f,
+        -0.5f, -0.5f, 0.f,  0.f, 0.f,
+    };
+
+    static const GLushort indices[] = { 0, 3, 1, 1, 3, 2 };
+
+    glGenVertexArrays(1, &this->vao);
+
+    glBindVertexArray(this->vao);
+
+    glGenBuffers(1, &this->quadVBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<void*>(0));
+
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<void*>(3 * sizeof(GLfloat)));
+
+    // The index buffer is part of the vertex array state
+    glGenBuffers(1, &this->quadIBO);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->quadIBO);
+
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // Attributes 2 to 6 advance once per instance
+    glGenBuffers(1, &this->instanceVBO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+
+    this->capacity = std::max(capacity, 1u);
+
+    glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+
+    for (GLuint location = 2; location <= 6; location++)
+    {
+        glEnableVertexAttribArray(location);
+
+        glVertexAttribDivisor(location, 1);
+    }
+
+    this->bindInstanceAttributes(0);
+
+    glBindVertexArray(0);
+
+    this->queue.reserve(this->capacity);
+
+    this->keys.reserve(this->capacity);
+
+    this->sorted.reserve(this->capacity);
+
+    return glGetError() == GL_NO_ERROR;
+}
+
+///
+/// Release the buffers and the shaders
+///
+void SpriteBatch::destroy()
+{
+    glDeleteBuffers(1, &this->instanceVBO);
+
+    glDeleteBuffers(1, &this->quadIBO);
+
+    glDeleteBuffers(1, &this->quadVBO);
+
+    glDeleteVertexArrays(1, &this->vao);
+
+    glDeleteProgram(this->program);
+
+    this->instanceVBO = this->quadIBO = this->quadVBO = this->vao = this->program = 0;
+
+    this->capacity = 0;
+
+    this->framesMap.clear();
+}
+
+///
+/// Set the regions of a texture that the frame indices of its instances refer to
+///
+/// @param texture The texture
+/// @param frames The regions in texture coordinates, each as the origin in `xy` and the size in `zw`
+/// @param count The number of regions
+/// @return `true` on success, `false` if there are more than `MAX_NUM_FRAMES` regions.
+/// @note A texture without regions is drawn as a whole, i.e. frame 0 covers the entire texture.
+///
+bool SpriteBatch::setFrames(GLuint texture, const vec4* frames, uint32_t count)
+{
+    // Guard: The regions must fit in the uniform array
+    if (count > SpriteBatch::MAX_NUM_FRAMES)
+    {
+        pserror("A texture can have at most %u frames, but %u are given.", SpriteBatch::MAX_NUM_FRAMES, count);
+
+        return false;
+    }
+
+    this->framesMap[texture].assign(frames, frames + count);
+
+    return true;
+}
+
+///
+/// Start a new batch of sprites
+///
+/// @param projection The projection matrix shared by all sprites
+/// @param time The elapsed time used by the distortion effect
+///
+void SpriteBatch::begin(const mat3& projection, float time)
+{
+    this->queue.clear();
+
+    this->keys.clear();
+
+    this->numDrawCalls = 0;
+
+    this->numInstances = 0;
+
+    glUseProgram(this->program);
+
+    glUniformMatrix3fv(this->projectionUniform, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&projection));
+
+    glUniform1f(this->timeUniform, time);
+
+    glUniform1i(this->samplerUniform, 0);
+}
+
+///
+/// Draw all sprites queued since `begin()`
+///
+void SpriteBatch::end()
+{
+    SW_TRACE_SCOPE("SpriteBatch::end", "render");
+
+    // Guard: Nothing to draw
+    if (this->queue.empty())
+    {
+        return;
+    }
+
+    auto count = static_cast<uint32_t>(this->queue.size());
+
+    // Group the sprites by layer and then by texture
+    std::sort(this->keys.begin(), this->keys.end());
+
+    this->sorted.resize(count);
+
+    for (uint32_t index = 0; index < count; index++)
+    {
+        this->sorted[index] = this->queue[this->keys[index].index];
+    }
+
+    // Stream all instances at once
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+
+    while (this->capacity < count)
+    {
+        this->capacity *= 2;
+    }
+
+    // Orphan the old storage, so the driver does not wait for the last frame to finish with it
+    glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Instance), this->sorted.data());
+
+    glUseProgram(this->program);
+
+    glBindVertexArray(this->vao);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    // The whole texture if a texture has no regions
+    static const vec4 wholeTexture = { 0.f, 0.f, 1.f, 1.f };
+
+    uint32_t first = 0;
+
+    while (first < count)
+    {
+        uint64_t batch = this->keys[first].batch;
+
+        uint32_t last = first + 1;
+
+        while (last < count && this->keys[last].batch == batch)
+        {
+            last++;
+        }
+
+        auto texture = static_cast<GLuint>(batch);
+
+        auto iterator = this->framesMap.find(texture);
+
+        if (iterator == this->framesMap.end() || iterator->second.empty())
+        {
+            glUniform4fv(this->framesUniform, 1, reinterpret_cast<const GLfloat*>(&wholeTexture));
+        }
+        else
+        {
+            glUniform4fv(this->framesUniform, static_cast<GLsizei>(iterator->second.size()), reinterpret_cast<const GLfloat*>(iterator->second.data()));
+        }
+
+        glBindTexture(GL_TEXTURE_2D, texture);
+
+        this->bindInstanceAttributes(first);
+
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr, last - first);
+
+        this->numDrawCalls++;
+
+        first = last;
+    }
+
+    this->numInstances += count;
+
+    glBindVertexArray(0);
+
+    // Sprites queued after this call start a new batch on top of the ones just drawn
+    this->queue.clear();
+
+    this->keys.clear();
+}
+
+///
+/// Make the transform of a sprite
+///
+/// @param position The center of the sprite
+/// @param radians The rotation of the sprite
+/// @param size The size of the sprite including its scale; A negative width flips the sprite horizontally.
+/// @return The transform that maps the unit quad to the sprite.
+///
+mat3 SpriteBatch::makeTransform(vec2 position, float radians, vec2 size)
+{
+    float c = cosf(radians);
+
+    float s = sinf(radians);
+
+    // Translate * Rotate * Scale in column-major order
+    return
+    {
+        {  c * size.x, s * size.x, 0.f },
+        { -s * size.y, c * size.y, 0.f },
+        { position.x, position.y, 1.f },
+    };
+}
+
+///
+/// [Private Helper] Compile and link the shader program
+///
+/// @return `true` on success, `false` otherwise.
+///
+bool SpriteBatch::loadProgram(const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+    this->program = loadShaderProgram(vertexShaderPath, fragmentShaderPath);
+
+    // Guard: The shaders must compile and link
+    if (this->program == 0)
+    {
+        return false;
+    }
+
+    this->projectionUniform = glGetUniformLocation(this->program, "projection");
+
+    this->timeUniform = glGetUniformLocation(this->program, "time");
+
+    this->framesUniform = glGetUniformLocation(this->program, "frames");
+
+    this->samplerUniform = glGetUniformLocation(this->program, "sampler0");
+
+    return true;
+}
+
+///
+/// [Private Helper] Point the instance attributes to the given instance in the buffer
+///
+/// @note OpenGL 3.3 has no base instance, so each run of sprites starts at its own offset.
+///
+void SpriteBatch::bindInstanceAttributes(uint32_t first)
+{
+    auto base = static_cast<uintptr_t>(first) * sizeof(Instance);
+
+    auto offset = [base] (size_t member) { return reinterpret_cast<void*>(base + member); };
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), offset(offsetof(Instance, transform)));
+
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), offset(offsetof(Instance, transform) + sizeof(vec3)));
+
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), offset(offsetof(Instance, transform) + 2 * sizeof(vec3)));
+
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), offset(offsetof(Instance, color)));
+
+    // The distort flag and the frame index are adjacent, so they travel as a single vec2
+    glVertexAttribPointer(6, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), offset(offsetof(Instance, distort)));
+}
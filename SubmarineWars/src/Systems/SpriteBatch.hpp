@@ -0,0 +1,218 @@
+//
+//  SpriteBatch.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef SpriteBatch_hpp
+#define SpriteBatch_hpp
+
+#include "Foundations/Foundations.hpp"
+#include "ProjectPath.hpp"
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+/// A singleton that draws sprites with instanced draw calls
+///
+/// Sprites are queued between `begin()` and `end()` instead of being drawn one by one with their own uniform uploads.
+/// On `end()` the queue is sorted by layer and texture, the per-instance attributes of all sprites are streamed
+/// into a single buffer, and each run of sprites that share a layer and a texture becomes one instanced draw.
+/// A renderer that submits through the batch thus issues a handful of draw calls per frame regardless of the number of sprites.
+/// @note The render system does not submit its sprites through the batch yet; Only the bench does.
+class SpriteBatch
+{
+public:
+    /// The per-instance attributes of a sprite
+    struct Instance
+    {
+        /// Maps the unit quad centered at the origin to the world, including the size of the sprite
+        mat3 transform;
+
+        /// The color that the texture is multiplied with
+        vec4 color;
+
+        /// 1 to wave and tint the sprite below the water surface, 0 otherwise
+        float distort;
+
+        /// The index of the region of the texture to draw; See `setFrames()`
+        float frame;
+    };
+
+    /// The maximum number of frames per texture; Must match the size of `frames` in the vertex shader
+    static constexpr uint32_t MAX_NUM_FRAMES = 64;
+
+    /// The default number of instances to reserve memory for
+    static constexpr uint32_t DEF_CAPACITY = 4096;
+
+    /// Get the shared instance
+    static SpriteBatch* shared();
+
+    ///
+    /// Create the buffers and compile the instanced shaders
+    ///
+    /// @param capacity The number of instances to reserve memory for; The buffers grow on demand.
+    /// @param vertexShaderPath The path to the vertex shader
+    /// @param fragmentShaderPath The path to the fragment shader
+    /// @return `true` on success, `false` otherwise.
+    /// @note A GL context must be current.
+    ///
+    bool init(uint32_t capacity = DEF_CAPACITY,
+              const char* vertexShaderPath = SWShaderPath("instanced.vs.glsl"),
+              const char* fragmentShaderPath = SWShaderPath("instanced.fs.glsl"));
+
+    ///
+    /// Release the buffers and the shaders
+    ///
+    void destroy();
+
+    ///
+    /// Set the regions of a texture that the frame indices of its instances refer to
+    ///
+    /// @param texture The texture
+    /// @param frames The regions in texture coordinates, each as the origin in `xy` and the size in `zw`
+    /// @param count The number of regions
+    /// @return `true` on success, `false` if there are more than `MAX_NUM_FRAMES` regions.
+    /// @note A texture without regions is drawn as a whole, i.e. frame 0 covers the entire texture.
+    ///
+    bool setFrames(GLuint texture, const vec4* frames, uint32_t count);
+
+    ///
+    /// Start a new batch of sprites
+    ///
+    /// @param projection The projection matrix shared by all sprites
+    /// @param time The elapsed time used by the distortion effect
+    ///
+    void begin(const mat3& projection, float time);
+
+    ///
+    /// [FAST] Queue a sprite
+    ///
+    /// @param texture The texture of the sprite
+    /// @param instance The per-instance attributes of the sprite
+    /// @param layer The layer of the sprite; Lower layers are drawn first.
+    /// @note Sprites on the same layer are drawn in the order they are queued if they share a texture.
+    ///
+    inline void draw(GLuint texture, const Instance& instance, uint32_t layer = 0)
+    {
+        this->keys.push_back({(static_cast<uint64_t>(layer) << 32) | texture, static_cast<uint32_t>(this->queue.size())});
+
+        this->queue.push_back(instance);
+    }
+
+    ///
+    /// Draw all sprites queued since `begin()`
+    ///
+    void end();
+
+    ///
+    /// Make the transform of a sprite
+    ///
+    /// @param position The center of the sprite
+    /// @param radians The rotation of the sprite
+    /// @param size The size of the sprite including its scale; A negative width flips the sprite horizontally.
+    /// @return The transform that maps the unit quad to the sprite.
+    ///
+    static mat3 makeTransform(vec2 position, float radians, vec2 size);
+
+    ///
+    /// [FAST] Get the number of draw calls issued since the last `begin()`
+    ///
+    inline uint32_t getNumDrawCalls() const
+    {
+        return this->numDrawCalls;
+    }
+
+    ///
+    /// [FAST] Get the number of sprites drawn since the last `begin()`
+    ///
+    inline uint32_t getNumInstances() const
+    {
+        return this->numInstances;
+    }
+
+private:
+    /// The sort key of a queued sprite
+    struct Key
+    {
+        /// The layer in the upper half and the texture in the lower half
+        uint64_t batch;
+
+        /// The index of the sprite in the queue; Breaks ties so that the sort is stable
+        uint32_t index;
+
+        inline bool operator<(const Key& other) const
+        {
+            return this->batch < other.batch || (this->batch == other.batch && this->index < other.index);
+        }
+    };
+
+    /// The vertex array that binds the quad and the instance attributes
+    GLuint vao = 0;
+
+    /// The vertices of the unit quad
+    GLuint quadVBO = 0;
+
+    /// The indices of the unit quad
+    GLuint quadIBO = 0;
+
+    /// The per-instance attributes streamed every batch
+    GLuint instanceVBO = 0;
+
+    /// The number of instances that fit in the instance buffer
+    uint32_t capacity = 0;
+
+    /// The shader program
+    GLuint program = 0;
+
+    /// Uniform locations
+    GLint projectionUniform = -1;
+
+    GLint timeUniform = -1;
+
+    GLint framesUniform = -1;
+
+    GLint samplerUniform = -1;
+
+    /// Sprites queued since `begin()`
+    std::vector<Instance> queue;
+
+    /// The sort keys of the queued sprites
+    std::vector<Key> keys;
+
+    /// The queued sprites in the order they are drawn
+    std::vector<Instance> sorted;
+
+    /// Maps a texture to its regions
+    std::unordered_map<GLuint, std::vector<vec4>> framesMap;
+
+    /// The number of draw calls issued since `begin()`
+    uint32_t numDrawCalls = 0;
+
+    /// The number of sprites drawn since `begin()`
+    uint32_t numInstances = 0;
+
+    /// Private instance
+    static SpriteBatch* instance;
+
+    ///
+    /// [Private Helper] Compile and link the shader program
+    ///
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool loadProgram(const char* vertexShaderPath, const char* fragmentShaderPath);
+
+    ///
+    /// [Private Helper] Point the instance attributes to the given instance in the buffer
+    ///
+    /// @note OpenGL 3.3 has no base instance, so each run of sprites starts at its own offset.
+    ///
+    void bindInstanceAttributes(uint32_t first);
+
+    /// Private constructor
+    SpriteBatch() = default;
+};
+
+#endif /* SpriteBatch_hpp */
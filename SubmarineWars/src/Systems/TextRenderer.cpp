@@ -0,0 +1,523 @@
+//
+//  TextRenderer.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "TextRenderer.hpp"
+#include "ShaderProgram.hpp"
+#include "Foundations/TraceRecorder.hpp"
+#include <algorithm>
+#include <string.h>
+#include <stddef.h>
+
+/// Private instance
+TextRenderer* TextRenderer::instance = nullptr;
+
+///
+/// [Helper] Write the digits of a number from right to left, padded with zeros
+///
+/// @param digits The buffer of at least `width` characters; Not terminated.
+/// @param width The number of digits
+/// @param value The number
+/// @note A number that needs more than `width` digits saturates to all nines, e.g. 99999999,
+///       so that a counter that overflows its label never appears to wrap around.
+///
+static void writeDigits(char* digits, uint32_t width, uint64_t value)
+{
+    for (uint32_t index = width; index > 0; index--)
+    {
+        digits[index - 1] = static_cast<char>('0' + value % 10);
+
+        value /= 10;
+    }
+
+    // Guard: Saturate if some digits are left
+    if (value != 0)
+    {
+        memset(digits, '9', width);
+    }
+}
+
+///
+/// Create a number label that is not made yet
+///
+/// @param prefix The text in front of the number; Must outlive the number label.
+/// @param width The number of digits; Clamped to `MAX_NUM_DIGITS`.
+/// @param value The initial number
+///
+TextRenderer::NumberLabel::NumberLabel(const char* prefix, uint32_t width, uint64_t value)
+{
+    this->prefix = prefix;
+
+    this->width = width < TextRenderer::MAX_NUM_DIGITS ? width : TextRenderer::MAX_NUM_DIGITS;
+
+    this->value = value;
+}
+
+/// Get the shared instance
+TextRenderer* TextRenderer::shared()
+{
+    if (TextRenderer::instance == nullptr)
+    {
+        TextRenderer::instance = new TextRenderer();
+    }
+
+    return TextRenderer::instance;
+}
+
+///
+/// Compile the text shaders
+///
+/// @param vertexShaderPath The path to the vertex shader
+/// @param fragmentShaderPath The path to the fragment shader of coverage atlases
+/// @param distanceFieldShaderPath The path to the fragment shader of distance field atlases
+/// @return `true` on success, `false` otherwise.
+/// @note A GL context must be current.
+///
+bool TextRenderer::init(const char* vertexShaderPath, const char* fragmentShaderPath, const char* distanceFieldShaderPath)
+{
+    return TextRenderer::loadProgram(this->programs[0], vertexShaderPath, fragmentShaderPath) &&
+           TextRenderer::loadProgram(this->programs[1], vertexShaderPath, distanceFieldShaderPath);
+}
+
+///
+/// Release all labels and the shaders
+///
+void TextRenderer::destroy()
+{
+    for (auto& state : this->labels)
+    {
+        if (state.alive)
+        {
+            glDeleteBuffers(1, &state.vbo);
+
+            glDeleteVertexArrays(1, &state.vao);
+        }
+    }
+
+    this->labels.clear();
+
+    this->freeLabels.clear();
+
+    for (auto& program : this->programs)
+    {
+        glDeleteProgram(program.program);
+
+        program = Program();
+    }
+}
+
+///
+/// Make a label
+///
+/// @param atlas The glyph atlas of the font; Must outlive the label.
+/// @param pixelSize The height of the characters in pixels; Ignored unless the atlas holds distance fields.
+/// @param position The pen position of the first character on the baseline
+/// @param color The color of the text
+/// @param text The text; Truncated to `MAX_NUM_CHARS` characters.
+/// @return The new label.
+///
+TextRenderer::Label TextRenderer::make(const GlyphAtlas* atlas, uint32_t pixelSize, vec2 position, vec4 color, const char* text)
+{
+    uint32_t slot;
+
+    // Reuse the slot of a removed label if possible
+    if (this->freeLabels.empty())
+    {
+        slot = static_cast<uint32_t>(this->labels.size());
+
+        this->labels.emplace_back();
+    }
+    else
+    {
+        slot = this->freeLabels.back();
+
+        this->freeLabels.pop_back();
+    }
+
+    State& state = this->labels[slot];
+
+    state.alive = true;
+
+    state.text.assign(text, strnlen(text, TextRenderer::MAX_NUM_CHARS));
+
+    state.atlas = atlas;
+
+    state.scale = atlas->isDistanceField() ? static_cast<float>(pixelSize) / atlas->getPixelSize() : 1.f;
+
+    state.position = position;
+
+    state.color = color;
+
+    state.width = 0;
+
+    // Glyph quads have a position and texture coordinates
+    glGenVertexArrays(1, &state.vao);
+
+    glBindVertexArray(state.vao);
+
+    glGenBuffers(1, &state.vbo);
+
+    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
+
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texcoord)));
+
+    glBindVertexArray(0);
+
+    this->generate(state);
+
+    return slot + 1;
+}
+
+///
+/// Change the text of a label
+///
+/// @param label The label; 0 is silently ignored.
+/// @param text The new text
+/// @note The glyph quads are only generated if the text differs.
+///       Only the quads of the characters that change are uploaded if the length stays the same.
+///
+void TextRenderer::setText(Label label, const char* text)
+{
+    // Guard: The label must have been made
+    if (label == 0)
+    {
+        return;
+    }
+
+    State& state = this->labels[label - 1];
+
+    size_t length = strnlen(text, TextRenderer::MAX_NUM_CHARS);
+
+    // Guard: Text of the same length is changed in place
+    if (state.text.size() == length)
+    {
+        this->update(state, 0, text, static_cast<uint32_t>(length));
+
+        return;
+    }
+
+    state.text.assign(text, length);
+
+    this->generate(state);
+}
+
+///
+/// Make a number label
+///
+/// @param numberLabel The number label to make; An existing label is replaced.
+/// @param atlas The glyph atlas of the font; Must outlive the label.
+/// @param pixelSize The height of the characters in pixels; Ignored unless the atlas holds distance fields.
+/// @param position The pen position of the first character on the baseline
+/// @param color The color of the text
+///
+void TextRenderer::makeNumber(NumberLabel& numberLabel, const GlyphAtlas* atlas, uint32_t pixelSize, vec2 position, vec4 color)
+{
+    char text[TextRenderer::MAX_NUM_CHARS + 1] = {};
+
+    // The prefix gives way to the digits if the label is too long
+    size_t length = strnlen(numberLabel.prefix, TextRenderer::MAX_NUM_CHARS - numberLabel.width);
+
+    memcpy(text, numberLabel.prefix, length);
+
+    writeDigits(text + length, numberLabel.width, numberLabel.value);
+
+    this->remove(numberLabel.label);
+
+    numberLabel.label = this->make(atlas, pixelSize, position, color, text);
+}
+
+///
+/// [FAST] Change the number of a number label
+///
+/// @param numberLabel A number label that has been made
+/// @param value The new number; Rendered as all nines if it needs more than `width` digits.
+/// @note Digits are computed without formatting, and only the quads of the digits that change are uploaded.
+///
+void TextRenderer::setNumber(NumberLabel& numberLabel, uint64_t value)
+{
+    // Guard: Nothing to do if the number is the same
+    if (numberLabel.value == value)
+    {
+        return;
+    }
+
+    numberLabel.value = value;
+
+    // Guard: The label must have been made
+    if (numberLabel.label == 0)
+    {
+        return;
+    }
+
+    char digits[TextRenderer::MAX_NUM_DIGITS];
+
+    writeDigits(digits, numberLabel.width, value);
+
+    State& state = this->labels[numberLabel.label - 1];
+
+    // The digits are always the last characters of the label
+    this->update(state, static_cast<uint32_t>(state.text.size()) - numberLabel.width, digits, numberLabel.width);
+}
+
+///
+/// Change the color of a label
+///
+/// @param label The label; 0 is silently ignored.
+/// @param color The new color
+///
+void TextRenderer::setColor(Label label, vec4 color)
+{
+    // Guard: The label must exist
+    if (label == 0 || label > this->labels.size() || !this->labels[label - 1].alive)
+    {
+        return;
+    }
+
+    this->labels[label - 1].color = color;
+}
+
+///
+/// Remove a label
+///
+/// @param label The label; 0 is silently ignored.
+///
+void TextRenderer::remove(Label label)
+{
+    // Guard: The label must exist
+    if (label == 0 || label > this->labels.size() || !this->labels[label - 1].alive)
+    {
+        return;
+    }
+
+    State& state = this->labels[label - 1];
+
+    glDeleteBuffers(1, &state.vbo);
+
+    glDeleteVertexArrays(1, &state.vao);
+
+    state.alive = false;
+
+    state.text.clear();
+
+    state.vertices.clear();
+
+    state.pens.clear();
+
+    this->freeLabels.push_back(label - 1);
+}
+
+///
+/// Draw all labels
+///
+/// @param projection The projection matrix that maps the screen to the normalized device coordinates
+///
+void TextRenderer::draw(const mat3& projection)
+{
+    SW_TRACE_SCOPE("TextRenderer::draw", "render");
+
+    this->numDrawCalls = 0;
+
+    glActiveTexture(GL_TEXTURE0);
+
+    glEnable(GL_BLEND);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Labels of coverage atlases first, then labels of distance field atlases, so each program is bound once
+    for (uint32_t distanceField = 0; distanceField < 2; distanceField++)
+    {
+        const Program& program = this->programs[distanceField];
+
+        bool bound = false;
+
+        for (const auto& state : this->labels)
+        {
+            if (!state.alive || state.vertices.empty() || state.atlas->isDistanceField() != (distanceField == 1))
+            {
+                continue;
+            }
+
+            // Bind the program only if some label needs it
+            if (!bound)
+            {
+                glUseProgram(program.program);
+
+                glUniformMatrix3fv(program.projectionUniform, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&projection));
+
+                glUniform1i(program.samplerUniform, 0);
+
+                bound = true;
+            }
+
+            glBindTexture(GL_TEXTURE_2D, state.atlas->getTexture());
+
+            glUniform4fv(program.colorUniform, 1, reinterpret_cast<const GLfloat*>(&state.color));
+
+            glBindVertexArray(state.vao);
+
+            glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(state.vertices.size()));
+
+            this->numDrawCalls++;
+        }
+    }
+
+    glBindVertexArray(0);
+}
+
+///
+/// [Private Helper] Generate the glyph quads of a label and upload them
+///
+void TextRenderer::generate(State& state)
+{
+    size_t length = state.text.size();
+
+    state.vertices.resize(6 * length);
+
+    state.pens.resize(length);
+
+    float pen = state.position.x;
+
+    for (size_t index = 0; index < length; index++)
+    {
+        const GlyphAtlas::Glyph& glyph = state.atlas->getGlyph(state.text[index]);
+
+        state.pens[index] = pen;
+
+        TextRenderer::writeQuad(&state.vertices[6 * index], glyph, pen, state.position.y, state.scale);
+
+        pen += glyph.advance * state.scale / 64.f;
+    }
+
+    state.width = pen - state.position.x;
+
+    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
+
+    glBufferData(GL_ARRAY_BUFFER, state.vertices.size() * sizeof(Vertex), state.vertices.data(), GL_DYNAMIC_DRAW);
+}
+
+///
+/// [Private Helper] Change a range of characters in place and upload the quads that change
+///
+/// @param state The label
+/// @param first The index of the first character to change
+/// @param characters The new characters
+/// @param count The number of characters to change; `first + count` must not exceed the length of the text.
+/// @note The label is generated again if a character changes its advance.
+///
+void TextRenderer::update(State& state, uint32_t first, const char* characters, uint32_t count)
+{
+    uint32_t lowest = UINT32_MAX, highest = 0;
+
+    for (uint32_t index = first; index < first + count; index++)
+    {
+        char character = characters[index - first];
+
+        // Guard: Skip the characters that stay the same
+        if (state.text[index] == character)
+        {
+            continue;
+        }
+
+        const GlyphAtlas::Glyph& oldGlyph = state.atlas->getGlyph(state.text[index]);
+
+        const GlyphAtlas::Glyph& newGlyph = state.atlas->getGlyph(character);
+
+        // Guard: A different advance moves the characters behind, so lay out the whole label again
+        if (oldGlyph.advance != newGlyph.advance)
+        {
+            state.text.replace(index, first + count - index, characters + (index - first), first + count - index);
+
+            this->generate(state);
+
+            return;
+        }
+
+        state.text[index] = character;
+
+        TextRenderer::writeQuad(&state.vertices[6 * index], newGlyph, state.pens[index], state.position.y, state.scale);
+
+        lowest = std::min(lowest, index);
+
+        highest = std::max(highest, index);
+    }
+
+    // Guard: Nothing to upload if the characters are the same
+    if (lowest > highest)
+    {
+        return;
+    }
+
+    // Upload the quads from the first to the last changed character at once
+    glBindBuffer(GL_ARRAY_BUFFER, state.vbo);
+
+    glBufferSubData(GL_ARRAY_BUFFER, 6 * lowest * sizeof(Vertex), 6 * (highest - lowest + 1) * sizeof(Vertex), &state.vertices[6 * lowest]);
+}
+
+///
+/// [Private Helper] Write the quad of a glyph at the given pen position
+///
+void TextRenderer::writeQuad(Vertex* quad, const GlyphAtlas::Glyph& glyph, float pen, float baseline, float scale)
+{
+    // Spaces only advance the pen, yet keep a degenerate quad so that each character owns the same vertices
+    if (glyph.width == 0 || glyph.height == 0)
+    {
+        std::fill(quad, quad + 6, Vertex{{pen, baseline}, {0.f, 0.f}});
+
+        return;
+    }
+
+    // The screen y-axis points down, so the bitmap starts `bearingY` pixels above the baseline
+    float left = pen + glyph.bearingX * scale;
+
+    float top = baseline - glyph.bearingY * scale;
+
+    float right = left + glyph.width * scale;
+
+    float bottom = top + glyph.height * scale;
+
+    float u0 = glyph.uv.x, v0 = glyph.uv.y, u1 = glyph.uv.x + glyph.uv.z, v1 = glyph.uv.y + glyph.uv.w;
+
+    quad[0] = {{left, top}, {u0, v0}};
+
+    quad[1] = {{left, bottom}, {u0, v1}};
+
+    quad[2] = {{right, top}, {u1, v0}};
+
+    quad[3] = {{right, top}, {u1, v0}};
+
+    quad[4] = {{left, bottom}, {u0, v1}};
+
+    quad[5] = {{right, bottom}, {u1, v1}};
+}
+
+///
+/// [Private Helper] Compile a program and look up its uniforms
+///
+bool TextRenderer::loadProgram(Program& program, const char* vertexShaderPath, const char* fragmentShaderPath)
+{
+    program.program = loadShaderProgram(vertexShaderPath, fragmentShaderPath);
+
+    // Guard: The shaders must compile and link
+    if (program.program == 0)
+    {
+        return false;
+    }
+
+    program.projectionUniform = glGetUniformLocation(program.program, "projection");
+
+    program.colorUniform = glGetUniformLocation(program.program, "fcolor");
+
+    program.samplerUniform = glGetUniformLocation(program.program, "sampler0");
+
+    return true;
+}
@@ -0,0 +1,284 @@
+//
+//  TextRenderer.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef TextRenderer_hpp
+#define TextRenderer_hpp
+
+#include "Foundations/Foundations.hpp"
+#include "GlyphAtlas.hpp"
+#include "ProjectPath.hpp"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/// A singleton that owns and draws text labels
+///
+/// A label holds a string, the glyph atlas of its font, its size, a color and the pen position of its first character.
+/// The glyphs of a distance field atlas are scaled to the size of the label, so one atlas serves any size;
+/// Coverage atlases are drawn at their own size.
+/// Its glyph quads are generated into a vertex buffer of its own only when the text changes,
+/// so a label is a single object instead of one entity per character, never runs through the other systems,
+/// and is drawn with one draw call from the texture of its atlas.
+/// Every character owns the six vertices at six times its index, so changing a character of the same advance,
+/// e.g. a digit of a monospaced font, only rewrites its quad and uploads the changed range of the buffer.
+class TextRenderer
+{
+public:
+    /// Identifies a label; 0 is never a valid label
+    typedef uint32_t Label;
+
+    /// The maximum number of characters in a label
+    static constexpr uint32_t MAX_NUM_CHARS = 128;
+
+    /// The maximum number of digits in a number label
+    static constexpr uint32_t MAX_NUM_DIGITS = 20;
+
+    /// A label of a prefix followed by a zero padded number of a fixed width, e.g. "SCORE:00000042"
+    struct NumberLabel
+    {
+        /// The label; 0 until the number label is made
+        Label label = 0;
+
+        /// The text in front of the number
+        const char* prefix;
+
+        /// The number of digits
+        uint32_t width;
+
+        /// The number rendered
+        uint64_t value;
+
+        ///
+        /// Create a number label that is not made yet
+        ///
+        /// @param prefix The text in front of the number; Must outlive the number label.
+        /// @param width The number of digits; Clamped to `MAX_NUM_DIGITS`.
+        /// @param value The initial number
+        ///
+        NumberLabel(const char* prefix, uint32_t width, uint64_t value = 0);
+    };
+
+    /// Get the shared instance
+    static TextRenderer* shared();
+
+    ///
+    /// Compile the text shaders
+    ///
+    /// @param vertexShaderPath The path to the vertex shader
+    /// @param fragmentShaderPath The path to the fragment shader of coverage atlases
+    /// @param distanceFieldShaderPath The path to the fragment shader of distance field atlases
+    /// @return `true` on success, `false` otherwise.
+    /// @note A GL context must be current.
+    ///
+    bool init(const char* vertexShaderPath = SWShaderPath("text.vs.glsl"),
+              const char* fragmentShaderPath = SWShaderPath("character.fs.glsl"),
+              const char* distanceFieldShaderPath = SWShaderPath("character_sdf.fs.glsl"));
+
+    ///
+    /// Release all labels and the shaders
+    ///
+    void destroy();
+
+    ///
+    /// Make a label
+    ///
+    /// @param atlas The glyph atlas of the font; Must outlive the label.
+    /// @param pixelSize The height of the characters in pixels; Ignored unless the atlas holds distance fields.
+    /// @param position The pen position of the first character on the baseline
+    /// @param color The color of the text
+    /// @param text The text; Truncated to `MAX_NUM_CHARS` characters.
+    /// @return The new label.
+    ///
+    Label make(const GlyphAtlas* atlas, uint32_t pixelSize, vec2 position, vec4 color, const char* text);
+
+    ///
+    /// Change the text of a label
+    ///
+    /// @param label The label; 0 is silently ignored.
+    /// @param text The new text
+    /// @note The glyph quads are only generated if the text differs.
+    ///
+    void setText(Label label, const char* text);
+
+    ///
+    /// Make a number label
+    ///
+    /// @param numberLabel The number label to make; An existing label is replaced.
+    /// @param atlas The glyph atlas of the font; Must outlive the label.
+    /// @param pixelSize The height of the characters in pixels; Ignored unless the atlas holds distance fields.
+    /// @param position The pen position of the first character on the baseline
+    /// @param color The color of the text
+    ///
+    void makeNumber(NumberLabel& numberLabel, const GlyphAtlas* atlas, uint32_t pixelSize, vec2 position, vec4 color);
+
+    ///
+    /// [FAST] Change the number of a number label
+    ///
+    /// @param numberLabel A number label that has been made
+    /// @param value The new number; Rendered as all nines if it needs more than `width` digits.
+    /// @note Digits are computed without formatting, and only the quads of the digits that change are uploaded.
+    ///
+    void setNumber(NumberLabel& numberLabel, uint64_t value);
+
+    ///
+    /// Change the color of a label
+    ///
+    /// @param label The label; 0 is silently ignored.
+    /// @param color The new color
+    ///
+    void setColor(Label label, vec4 color);
+
+    ///
+    /// Remove a label
+    ///
+    /// @param label The label; 0 is silently ignored.
+    ///
+    void remove(Label label);
+
+    ///
+    /// Draw all labels
+    ///
+    /// @param projection The projection matrix that maps the screen to the normalized device coordinates
+    ///
+    void draw(const mat3& projection);
+
+    ///
+    /// [FAST] Get the width of a label in pixels
+    ///
+    /// @return The width, or 0 if the label does not exist.
+    ///
+    inline float getWidth(Label label) const
+    {
+        // Guard: The label must exist
+        if (label == 0 || label > this->labels.size() || !this->labels[label - 1].alive)
+        {
+            return 0;
+        }
+
+        return this->labels[label - 1].width;
+    }
+
+    ///
+    /// [FAST] Get the number of labels
+    ///
+    inline uint32_t getNumLabels() const
+    {
+        return static_cast<uint32_t>(this->labels.size() - this->freeLabels.size());
+    }
+
+    ///
+    /// [FAST] Get the number of draw calls issued by the last `draw()`
+    ///
+    inline uint32_t getNumDrawCalls() const
+    {
+        return this->numDrawCalls;
+    }
+
+private:
+    /// A vertex of a glyph quad
+    struct Vertex
+    {
+        /// The position on screen
+        vec2 position;
+
+        /// The texture coordinates in the atlas
+        vec2 texcoord;
+    };
+
+    /// The state of a label
+    struct State
+    {
+        /// Indicates whether the slot is in use
+        bool alive;
+
+        /// The text
+        std::string text;
+
+        /// The glyph atlas
+        const GlyphAtlas* atlas;
+
+        /// The ratio of the size of the label to the size of the glyphs in the atlas
+        float scale;
+
+        /// The pen position of the first character
+        vec2 position;
+
+        /// The color
+        vec4 color;
+
+        /// The width of the text in pixels
+        float width;
+
+        /// The glyph quads, six vertices per character; Empty glyphs have degenerate quads.
+        std::vector<Vertex> vertices;
+
+        /// The pen position of each character
+        std::vector<float> pens;
+
+        /// The vertex array and the vertex buffer of the glyph quads
+        GLuint vao, vbo;
+    };
+
+    /// A shader program and its uniform locations
+    struct Program
+    {
+        GLuint program = 0;
+
+        GLint projectionUniform = -1;
+
+        GLint colorUniform = -1;
+
+        GLint samplerUniform = -1;
+    };
+
+    /// The programs of coverage atlases and distance field atlases, indexed by `GlyphAtlas::isDistanceField()`
+    Program programs[2];
+
+    /// Labels indexed by their identifier minus one
+    std::vector<State> labels;
+
+    /// The slots of removed labels
+    std::vector<uint32_t> freeLabels;
+
+    /// The number of draw calls issued by the last `draw()`
+    uint32_t numDrawCalls = 0;
+
+    /// Private instance
+    static TextRenderer* instance;
+
+    ///
+    /// [Private Helper] Generate the glyph quads of a label and upload them
+    ///
+    void generate(State& state);
+
+    ///
+    /// [Private Helper] Change a range of characters in place and upload the quads that change
+    ///
+    /// @param state The label
+    /// @param first The index of the first character to change
+    /// @param characters The new characters
+    /// @param count The number of characters to change; `first + count` must not exceed the length of the text.
+    /// @note The label is generated again if a character changes its advance.
+    ///
+    void update(State& state, uint32_t first, const char* characters, uint32_t count);
+
+    ///
+    /// [Private Helper] Write the quad of a glyph at the given pen position
+    ///
+    static void writeQuad(Vertex* quad, const GlyphAtlas::Glyph& glyph, float pen, float baseline, float scale);
+
+    ///
+    /// [Private Helper] Compile a program and look up its uniforms
+    ///
+    static bool loadProgram(Program& program, const char* vertexShaderPath, const char* fragmentShaderPath);
+
+    /// Private constructor
+    TextRenderer() = default;
+};
+
+#endif /* TextRenderer_hpp */
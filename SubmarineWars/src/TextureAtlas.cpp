@@ -0,0 +1,444 @@
+//
+//  TextureAtlas.cpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#include "TextureAtlas.hpp"
+#include <algorithm>
+#include <numeric>
+#include <string.h>
+#include <stb_image.h>
+
+///
+/// [Helper] Hash the size and the pixels of an image with FNV-1a
+///
+static uint64_t hashImage(const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    auto combine = [&hash] (uint8_t byte)
+    {
+        hash = (hash ^ byte) * 0x100000001B3ull;
+    };
+
+    for (uint32_t shift = 0; shift < 32; shift += 8)
+    {
+        combine(static_cast<uint8_t>(width >> shift));
+
+        combine(static_cast<uint8_t>(height >> shift));
+    }
+
+    size_t numBytes = static_cast<size_t>(width) * height * 4;
+
+    for (size_t index = 0; index < numBytes; index++)
+    {
+        combine(pixels[index]);
+    }
+
+    return hash;
+}
+
+///
+/// Create an empty atlas
+///
+/// @param pageSize The side length of a page; Larger images get a page of their own.
+/// @param maxNumRegionsPerPage The maximum number of regions on a page, e.g. the number of frames a sprite batch supports
+///
+TextureAtlas::TextureAtlas(uint32_t pageSize, uint32_t maxNumRegionsPerPage)
+{
+    this->pageSize = pageSize;
+
+    this->maxNumRegionsPerPage = std::max(maxNumRegionsPerPage, 1u);
+}
+
+///
+/// Add an image file
+///
+/// @param path The path to the image file
+/// @return The index of the region of the image, or -1 if the image cannot be loaded.
+/// @note Adding the same path or the same pixels again returns the same region.
+///
+int32_t TextureAtlas::add(const char* path)
+{
+    auto iterator = this->pathsMap.find(path);
+
+    // Guard: The file has been read already
+    if (iterator != this->pathsMap.end())
+    {
+        const Region& region = this->regions[iterator->second];
+
+        this->numImages++;
+
+        this->bytesWithoutAtlas += static_cast<uint64_t>(region.width) * region.height * 4;
+
+        return static_cast<int32_t>(iterator->second);
+    }
+
+    int width = 0, height = 0, channels = 0;
+
+    // Always ask for 4 channels, so every page has the same format
+    stbi_uc* pixels = stbi_load(path, &width, &height, &channels, 4);
+
+    // Guard: The image must be readable
+    if (pixels == nullptr)
+    {
+        pserror("Failed to load the image at %s: %s.", path, stbi_failure_reason());
+
+        return -1;
+    }
+
+    int32_t index = this->add(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+    stbi_image_free(pixels);
+
+    if (index >= 0)
+    {
+        this->pathsMap[path] = static_cast<uint32_t>(index);
+    }
+
+    return index;
+}
+
+///
+/// Add an image from memory
+///
+/// @param pixels The RGBA pixels of the image, row by row from the top
+/// @param width The width of the image
+/// @param height The height of the image
+/// @return The index of the region of the image, or -1 if the image is empty or the atlas has been built.
+/// @note Adding the same pixels again returns the same region.
+///
+int32_t TextureAtlas::add(const uint8_t* pixels, uint32_t width, uint32_t height)
+{
+    // Guard: The pixels of the other images have been released
+    if (this->built)
+    {
+        pserror("API Usage Error: Cannot add images to an atlas that has been built.");
+
+        return -1;
+    }
+
+    // Guard: The image must not be empty
+    if (width == 0 || height == 0)
+    {
+        return -1;
+    }
+
+    size_t numBytes = static_cast<size_t>(width) * height * 4;
+
+    this->numImages++;
+
+    this->bytesWithoutAtlas += numBytes;
+
+    uint64_t hash = hashImage(pixels, width, height);
+
+    // Guard: Reuse the region of an image with the same pixels
+    auto range = this->hashesMap.equal_range(hash);
+
+    for (auto iterator = range.first; iterator != range.second; iterator++)
+    {
+        const Region& region = this->regions[iterator->second];
+
+        // The hash may collide, so compare the pixels as well
+        if (region.width == width && region.height == height && memcmp(this->images[iterator->second].pixels.data(), pixels, numBytes) == 0)
+        {
+            return static_cast<int32_t>(iterator->second);
+        }
+    }
+
+    auto index = static_cast<uint32_t>(this->regions.size());
+
+    this->images.push_back({std::vector<uint8_t>(pixels, pixels + numBytes), hash});
+
+    this->regions.push_back({0, 0, 0, 0, width, height, {0.f, 0.f, 0.f, 0.f}});
+
+    this->hashesMap.emplace(hash, index);
+
+    return static_cast<int32_t>(index);
+}
+
+///
+/// Pack all images added so far and upload the pages
+///
+/// @return `true` on success, `false` otherwise.
+/// @note The pixels of the images are released afterwards, so no more images can be added.
+///
+bool TextureAtlas::build()
+{
+    // Guard: Build only once
+    if (this->built)
+    {
+        return true;
+    }
+
+    // Tall images first, so that each shelf wastes little space above the shorter images on it
+    std::vector<uint32_t> order(this->regions.size());
+
+    std::iota(order.begin(), order.end(), 0);
+
+    std::stable_sort(order.begin(), order.end(), [this] (uint32_t lhs, uint32_t rhs)
+    {
+        const Region& first = this->regions[lhs];
+
+        const Region& second = this->regions[rhs];
+
+        return first.height > second.height || (first.height == second.height && first.width > second.width);
+    });
+
+    for (uint32_t index : order)
+    {
+        this->place(this->regions[index]);
+    }
+
+    // Fill and upload each page
+    std::vector<std::vector<uint8_t>> pixels(this->pages.size());
+
+    for (uint32_t page = 0; page < this->pages.size(); page++)
+    {
+        pixels[page].assign(static_cast<size_t>(this->pages[page].width) * this->pages[page].height * 4, 0);
+    }
+
+    for (uint32_t index = 0; index < this->regions.size(); index++)
+    {
+        Region& region = this->regions[index];
+
+        const Page& page = this->pages[region.page];
+
+        TextureAtlas::blit(this->images[index], region, pixels[region.page], page.width);
+
+        region.uv = { static_cast<float>(region.x) / page.width,
+                      static_cast<float>(region.y) / page.height,
+                      static_cast<float>(region.width) / page.width,
+                      static_cast<float>(region.height) / page.height };
+    }
+
+    for (uint32_t index = 0; index < this->pages.size(); index++)
+    {
+        Page& page = this->pages[index];
+
+        glGenTextures(1, &page.texture);
+
+        glBindTexture(GL_TEXTURE_2D, page.texture);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, page.width, page.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels[index].data());
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    // Release the pixels but keep the maps, so that added paths still resolve to their regions
+    std::vector<Image>().swap(this->images);
+
+    this->hashesMap.clear();
+
+    this->built = true;
+
+    return glGetError() == GL_NO_ERROR;
+}
+
+///
+/// Release the pages
+///
+void TextureAtlas::destroy()
+{
+    for (auto& page : this->pages)
+    {
+        glDeleteTextures(1, &page.texture);
+    }
+
+    this->pages.clear();
+
+    this->regions.clear();
+
+    this->images.clear();
+
+    this->pathsMap.clear();
+
+    this->hashesMap.clear();
+
+    this->numImages = 0;
+
+    this->bytesWithoutAtlas = 0;
+
+    this->built = false;
+}
+
+///
+/// Get the frames of a page, i.e. the rectangles of its regions in texture coordinates ordered by `Region::frame`
+///
+std::vector<vec4> TextureAtlas::getFrames(uint32_t page) const
+{
+    std::vector<vec4> frames(this->pages[page].numRegions);
+
+    for (const auto& region : this->regions)
+    {
+        if (region.page == page)
+        {
+            frames[region.frame] = region.uv;
+        }
+    }
+
+    return frames;
+}
+
+///
+/// Get a summary of the packing
+///
+TextureAtlas::Statistics TextureAtlas::getStatistics() const
+{
+    Statistics statistics = {this->numImages, static_cast<uint32_t>(this->regions.size()), static_cast<uint32_t>(this->pages.size()), 0.f, this->bytesWithoutAtlas, 0};
+
+    uint64_t usedArea = 0;
+
+    uint64_t pageArea = 0;
+
+    for (const auto& region : this->regions)
+    {
+        usedArea += static_cast<uint64_t>(region.width) * region.height;
+    }
+
+    for (const auto& page : this->pages)
+    {
+        pageArea += static_cast<uint64_t>(page.width) * page.height;
+    }
+
+    statistics.occupancy = pageArea == 0 ? 0.f : static_cast<float>(usedArea) / pageArea;
+
+    statistics.bytesWithAtlas = pageArea * 4;
+
+    return statistics;
+}
+
+///
+/// [Private Helper] Find space for a region and assign its page and position
+///
+void TextureAtlas::place(Region& region)
+{
+    uint32_t width = region.width + 2 * TextureAtlas::PADDING;
+
+    uint32_t height = region.height + 2 * TextureAtlas::PADDING;
+
+    // Returns `true` if the region fits on the given shelf
+    auto fits = [&] (const Page& page, const Shelf& shelf)
+    {
+        return shelf.height >= height && shelf.x + width <= page.size;
+    };
+
+    // Returns `true` if the region fits on a new shelf below the existing ones
+    auto fitsBelow = [&] (const Page& page)
+    {
+        uint32_t top = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().height;
+
+        return top + height <= page.size && width <= page.size;
+    };
+
+    Page* target = nullptr;
+
+    Shelf* shelf = nullptr;
+
+    // Pass 1: Find the first shelf with enough room
+    for (auto& page : this->pages)
+    {
+        if (page.numRegions >= this->maxNumRegionsPerPage)
+        {
+            continue;
+        }
+
+        for (auto& candidate : page.shelves)
+        {
+            if (fits(page, candidate))
+            {
+                target = &page;
+
+                shelf = &candidate;
+
+                break;
+            }
+        }
+
+        if (shelf != nullptr)
+        {
+            break;
+        }
+    }
+
+    // Pass 2: Open a shelf on the first page with enough room below its shelves
+    if (shelf == nullptr)
+    {
+        for (auto& page : this->pages)
+        {
+            if (page.numRegions < this->maxNumRegionsPerPage && fitsBelow(page))
+            {
+                target = &page;
+
+                break;
+            }
+        }
+
+        // Pass 3: Open a page; An image larger than a page gets a page of its own size
+        if (target == nullptr)
+        {
+            this->pages.push_back({0, std::max(this->pageSize, std::max(width, height)), 0, 0, 0, {}});
+
+            target = &this->pages.back();
+        }
+
+        uint32_t top = target->shelves.empty() ? 0 : target->shelves.back().y + target->shelves.back().height;
+
+        target->shelves.push_back({top, height, 0});
+
+        shelf = &target->shelves.back();
+    }
+
+    region.page = static_cast<uint32_t>(target - this->pages.data());
+
+    region.frame = target->numRegions++;
+
+    region.x = shelf->x + TextureAtlas::PADDING;
+
+    region.y = shelf->y + TextureAtlas::PADDING;
+
+    shelf->x += width;
+
+    // Trim the page to the area in use
+    target->width = std::max(target->width, shelf->x);
+
+    target->height = std::max(target->height, shelf->y + shelf->height);
+}
+
+///
+/// [Private Helper] Copy an image into the pixels of its page and extrude its border into the padding
+///
+void TextureAtlas::blit(const Image& image, const Region& region, std::vector<uint8_t>& pixels, uint32_t pageWidth)
+{
+    auto padding = static_cast<int32_t>(TextureAtlas::PADDING);
+
+    auto width = static_cast<int32_t>(region.width);
+
+    auto height = static_cast<int32_t>(region.height);
+
+    for (int32_t y = -padding; y < height + padding; y++)
+    {
+        // Rows and columns in the padding repeat the nearest pixel of the image
+        int32_t sourceY = std::min(std::max(y, 0), height - 1);
+
+        for (int32_t x = -padding; x < width + padding; x++)
+        {
+            int32_t sourceX = std::min(std::max(x, 0), width - 1);
+
+            const uint8_t* source = &image.pixels[(static_cast<size_t>(sourceY) * width + sourceX) * 4];
+
+            uint8_t* destination = &pixels[(static_cast<size_t>(region.y + y) * pageWidth + region.x + x) * 4];
+
+            memcpy(destination, source, 4);
+        }
+    }
+}
@@ -0,0 +1,243 @@
+//
+//  TextureAtlas.hpp
+//  SubmarineWars
+//
+//  Created by FireWolf on 2019-12-14.
+//  Copyright © 2019 FireWolf. All rights reserved.
+//
+
+#ifndef TextureAtlas_hpp
+#define TextureAtlas_hpp
+
+#include "Foundations/Foundations.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+/// Packs many small images into a few large textures
+///
+/// Images are deduplicated twice: by path, so a frame listed several times is read once,
+/// and by content, so two files with identical pixels share a region.
+/// The unique images are then sorted by height and packed on shelves, i.e. rows of images,
+/// into pages that are trimmed to the area actually used.
+/// Sprites refer to their image by a region, which holds the page and the rectangle in texture coordinates,
+/// so sprites of different entity types can share a texture bind and be drawn by the same batch.
+class TextureAtlas
+{
+public:
+    /// The default side length of a page
+    static constexpr uint32_t DEF_PAGE_SIZE = 2048;
+
+    /// The default maximum number of regions per page
+    static constexpr uint32_t DEF_MAX_NUM_REGIONS_PER_PAGE = 64;
+
+    /// The number of pixels around each image, filled with its border pixels so that filtering does not bleed
+    static constexpr uint32_t PADDING = 1;
+
+    /// The place of an image in the atlas
+    struct Region
+    {
+        /// The index of the page
+        uint32_t page;
+
+        /// The index of the region among the regions on the same page
+        uint32_t frame;
+
+        /// The rectangle in pixels without the padding
+        uint32_t x, y, width, height;
+
+        /// The rectangle in texture coordinates, the origin in `xy` and the size in `zw`
+        vec4 uv;
+    };
+
+    /// A summary of the packing
+    struct Statistics
+    {
+        /// The number of images added, including duplicates
+        uint32_t numImages;
+
+        /// The number of unique images
+        uint32_t numUniqueImages;
+
+        /// The number of pages
+        uint32_t numPages;
+
+        /// The fraction of the page area covered by images
+        float occupancy;
+
+        /// The bytes needed by one texture per image added
+        uint64_t bytesWithoutAtlas;
+
+        /// The bytes of all pages
+        uint64_t bytesWithAtlas;
+    };
+
+    ///
+    /// Create an empty atlas
+    ///
+    /// @param pageSize The side length of a page; Larger images get a page of their own.
+    /// @param maxNumRegionsPerPage The maximum number of regions on a page, e.g. the number of frames a sprite batch supports
+    ///
+    TextureAtlas(uint32_t pageSize = DEF_PAGE_SIZE, uint32_t maxNumRegionsPerPage = DEF_MAX_NUM_REGIONS_PER_PAGE);
+
+    ///
+    /// Add an image file
+    ///
+    /// @param path The path to the image file
+    /// @return The index of the region of the image, or -1 if the image cannot be loaded.
+    /// @note Adding the same path or the same pixels again returns the same region.
+    ///
+    int32_t add(const char* path);
+
+    ///
+    /// Add an image from memory
+    ///
+    /// @param pixels The RGBA pixels of the image, row by row from the top
+    /// @param width The width of the image
+    /// @param height The height of the image
+    /// @return The index of the region of the image, or -1 if the image is empty or the atlas has been built.
+    /// @note Adding the same pixels again returns the same region.
+    ///
+    int32_t add(const uint8_t* pixels, uint32_t width, uint32_t height);
+
+    ///
+    /// Pack all images added so far and upload the pages
+    ///
+    /// @return `true` on success, `false` otherwise.
+    /// @note The pixels of the images are released afterwards, so no more images can be added.
+    ///
+    bool build();
+
+    ///
+    /// Release the pages
+    ///
+    void destroy();
+
+    ///
+    /// Get the frames of a page, i.e. the rectangles of its regions in texture coordinates ordered by `Region::frame`
+    ///
+    std::vector<vec4> getFrames(uint32_t page) const;
+
+    ///
+    /// Get a summary of the packing
+    ///
+    Statistics getStatistics() const;
+
+    ///
+    /// [FAST] Get the region of an image
+    ///
+    inline const Region& getRegion(uint32_t index) const
+    {
+        return this->regions[index];
+    }
+
+    ///
+    /// [FAST] Get the texture of a page
+    ///
+    inline GLuint getTexture(uint32_t page) const
+    {
+        return this->pages[page].texture;
+    }
+
+    ///
+    /// [FAST] Get the number of pages
+    ///
+    inline uint32_t getNumPages() const
+    {
+        return static_cast<uint32_t>(this->pages.size());
+    }
+
+    ///
+    /// [FAST] Check whether the atlas has been built
+    ///
+    inline bool isBuilt() const
+    {
+        return this->built;
+    }
+
+private:
+    /// A row of images on a page
+    struct Shelf
+    {
+        /// The top of the shelf
+        uint32_t y;
+
+        /// The height of the tallest image on the shelf
+        uint32_t height;
+
+        /// The left of the free space on the shelf
+        uint32_t x;
+    };
+
+    /// A texture that holds many images
+    struct Page
+    {
+        /// The texture; 0 until the atlas is built
+        GLuint texture;
+
+        /// The side length available for packing
+        uint32_t size;
+
+        /// The size of the page after trimming
+        uint32_t width, height;
+
+        /// The number of regions on the page
+        uint32_t numRegions;
+
+        /// The shelves from top to bottom
+        std::vector<Shelf> shelves;
+    };
+
+    /// An image waiting to be packed
+    struct Image
+    {
+        /// The RGBA pixels
+        std::vector<uint8_t> pixels;
+
+        /// The hash of the size and the pixels
+        uint64_t hash;
+    };
+
+    /// The side length of a page
+    uint32_t pageSize;
+
+    /// The maximum number of regions on a page
+    uint32_t maxNumRegionsPerPage;
+
+    /// Indicates whether the atlas has been built
+    bool built = false;
+
+    /// Unique images indexed by region; Emptied by `build()`
+    std::vector<Image> images;
+
+    /// The regions of the unique images
+    std::vector<Region> regions;
+
+    /// The pages
+    std::vector<Page> pages;
+
+    /// Maps a path to the region of its image
+    std::unordered_map<std::string, uint32_t> pathsMap;
+
+    /// Maps the hash of an image to the regions with that hash
+    std::unordered_multimap<uint64_t, uint32_t> hashesMap;
+
+    /// The number of images added, including duplicates
+    uint32_t numImages = 0;
+
+    /// The bytes needed by one texture per image added
+    uint64_t bytesWithoutAtlas = 0;
+
+    ///
+    /// [Private Helper] Find space for a region and assign its page and position
+    ///
+    void place(Region& region);
+
+    ///
+    /// [Private Helper] Copy an image into the pixels of its page and extrude its border into the padding
+    ///
+    static void blit(const Image& image, const Region& region, std::vector<uint8_t>& pixels, uint32_t pageWidth);
+};
+
+#endif /* TextureAtlas_hpp */
@@ -25,9 +25,10 @@ WindowController::~WindowController()
 ///
 /// @param title The window title
 /// @param size The window size
+/// @param visible Pass `false` to create a hidden window without vsync, e.g. to run headless
 /// @return A non-null pointer to the newly created window controller on success, `nullptr` otherwise.
 ///
-WindowController* WindowController::create(const char* title, ScreenSize& size)
+WindowController* WindowController::create(const char* title, ScreenSize& size, bool visible)
 {
     // Guard: Create the window controller instance
     WindowController* instance = new WindowController();
@@ -48,6 +49,7 @@ WindowController* WindowController::create(const char* title, ScreenSize& size)
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
     glfwWindowHint(GLFW_RESIZABLE, 0);
+    glfwWindowHint(GLFW_VISIBLE, visible ? 1 : 0);
     
     // Create the main window
     instance->window = glfwCreateWindow(size.width, size.height, title, nullptr, nullptr);
@@ -62,7 +64,7 @@ WindowController* WindowController::create(const char* title, ScreenSize& size)
     }
     
     glfwMakeContextCurrent(instance->window);
-    glfwSwapInterval(1); // vsync
+    glfwSwapInterval(visible ? 1 : 0); // vsync
     
     // Load OpenGL function pointers
     gl3w_init();
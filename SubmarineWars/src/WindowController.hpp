@@ -45,9 +45,10 @@ public:
     ///
     /// @param title The window title
     /// @param size The window size
+    /// @param visible Pass `false` to create a hidden window without vsync, e.g. to run headless
     /// @return A non-null pointer to the newly created window controller on success, `nullptr` otherwise.
     ///
-    static WindowController* create(const char* title, ScreenSize& size);
+    static WindowController* create(const char* title, ScreenSize& size, bool visible = true);
     
     ///
     /// [Convenient] Destroy the given window controller
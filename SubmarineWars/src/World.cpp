@@ -10,6 +10,9 @@
 #include "Foundations/Foundations.hpp"
 #include "Entities/Submarine.hpp"
 #include "Sounds/SoundPlayer.hpp"
+#include "Replay.hpp"
+#include "SpriteFactory.hpp"
+#include "Systems/TextRenderer.hpp"
 #include <iostream>
 #include <fstream>
 
@@ -20,7 +23,7 @@ static void glfwErrorCallback(int error, const char* description)
     pserror("OpenGL Error %d: %s", error, description);
 }
 
-bool World::init(ScreenSize size)
+bool World::init(ScreenSize size, bool headless)
 {
     // Initialize OpenGL and GLFW
     glfwSetErrorCallback(glfwErrorCallback);
@@ -40,7 +43,7 @@ bool World::init(ScreenSize size)
     }
     
     // Initialize the window controller
-    this->windowController = WindowController::create("Submarine Wars", size);
+    this->windowController = WindowController::create("Submarine Wars", size, !headless);
     
     if (this->windowController == nullptr)
     {
@@ -54,13 +57,28 @@ bool World::init(ScreenSize size)
     
     glfwSetWindowUserPointer(this->windowController->getMainWindow(), this);
     
+    // Live input events are recorded if requested and ignored while a replay is playing back
     auto movcb = [](GLFWwindow* window, double xpos, double ypos)
     {
+        if (Replay::shared()->isPlaying())
+        {
+            return;
+        }
+
+        Replay::shared()->recordMouseMoveEvent(xpos, ypos);
+
         ((World*) glfwGetWindowUserPointer(window))->onMouseMoveEvent(window, xpos, ypos);
     };
     
     auto mobcb = [](GLFWwindow* window, int button, int action, int mods)
     {
+        if (Replay::shared()->isPlaying())
+        {
+            return;
+        }
+
+        Replay::shared()->recordMouseButtonEvent(button, action, mods);
+
         ((World*) glfwGetWindowUserPointer(window))->onMouseButtonEvent(window, button, action, mods);
     };
     
@@ -97,6 +115,21 @@ bool World::init(ScreenSize size)
         
         return false;
     }
+
+    // Menu, tutorial and overlay text is drawn as one mesh per label
+    if (!TextRenderer::shared()->init())
+    {
+        pserror("Failed to initialize the text renderer.");
+
+        return false;
+    }
+
+    // Labels are positioned in screen coordinates with the origin at the top left corner
+    this->textProjection = { { 2.f / size.width, 0.f, 0.f }, { 0.f, -2.f / size.height, 0.f }, { -1.f, 1.f, 1.f } };
+
+    // Generate the glyphs of the HUD, the menus and the tutorial while the rest of the world is set up
+    // One distance field atlas serves all text sizes
+    SpriteFactory::shared()->preloadDistanceFieldAtlas(Character::Font::SFMonoRegular);
     
     this->motionSystem = new MotionSystem(Components::makeBitMap<Position, Velocity>(), this->entityManager);
     
@@ -232,8 +265,18 @@ bool World::init(ScreenSize size)
     lKey = false;
     rKey = false;
     mouseIsOverNewGame = false;
-    
-    passert(SoundPlayer::shared()->playBackgroundMusic(), "Failed to play the BGM.");
+    mouseIsOverLoadGame = false;
+    cursorPosition = {0, 0};
+    this->headless = headless;
+    profilerOverlayVisible = false;
+    sinceOverlayRefresh = 0;
+    soakMonitor = nullptr;
+    idleModeEnabled = true;
+    
+    if (!headless)
+    {
+        passert(SoundPlayer::shared()->playBackgroundMusic(), "Failed to play the BGM.");
+    }
 
     return true;
 }
@@ -261,6 +304,8 @@ void World::destroy()
     delete this->pathingSystem;
 
     delete this->animationSystem;
+
+    TextRenderer::shared()->destroy();
     
     SoundPlayer::sharedFinalize();
     
@@ -275,36 +320,246 @@ void World::destroy()
 ///
 bool World::update(float ms)
 {
+    SW_TRACE_SCOPE("Frame", "frame");
+
+    FrameProfiler::shared()->beginFrame();
+
     // TODO: IMP THIS
     if(!this->entityManager->checkIfGameOver())
     {
+        SW_PROFILE_SCOPE(StageController);
+
         this->stageController->update(ms);
     } else
     {
         this->stageController->signalGameActive(false);
     }
-    this->motionSystem->update(ms);
 
-    this->inputSystem->update(ms);
+    // Nothing moves or collides on the menu screens, so only input, animations and rendering are updated
+    bool idle = this->idleModeEnabled && this->isIdle();
 
-    this->collisionSystem->update(ms);
+    if (!idle)
+    {
+        SW_PROFILE_SCOPE(MotionSystem);
+
+        this->motionSystem->update(ms);
+    }
 
-    this->renderSystem->update(ms);
+    {
+        SW_PROFILE_SCOPE(InputSystem);
 
-    this->attackSystem->update(ms);
+        this->inputSystem->update(ms);
+    }
 
-    if(!this->entityManager->checkIfGameOver())
+    if (!idle)
+    {
+        SW_PROFILE_SCOPE(CollisionSystem);
+
+        this->collisionSystem->update(ms);
+    }
+
+    if (!this->headless)
+    {
+        SW_PROFILE_SCOPE(RenderSystem);
+
+        this->renderSystem->update(ms);
+
+        // Labels are not entities, so the text is drawn over the sprites here
+        TextRenderer::shared()->draw(this->textProjection);
+    }
+
+    if (!idle)
     {
+        SW_PROFILE_SCOPE(AttackSystem);
+
+        this->attackSystem->update(ms);
+    }
+
+    if(!idle && !this->entityManager->checkIfGameOver())
+    {
+        SW_PROFILE_SCOPE(PathingSystem);
+
         this->pathingSystem->update(ms);
     }
     
-    this->animationSystem->update(ms);
+    {
+        SW_PROFILE_SCOPE(AnimationSystem);
+
+        this->animationSystem->update(ms);
+    }
+
+    this->snapshots.update(ms, this->entityManager, this->stageController);
+
+    FrameProfiler::shared()->endFrame();
+
+    this->updateProfilerOverlay(ms);
+
+    if (this->soakMonitor != nullptr)
+    {
+        this->soakMonitor->frameDidEnd(this->entityManager, this->stageController);
+    }
 
     return true;
 }
 
+///
+/// Check whether the world is idle
+///
+/// @return `true` if the intro, the tutorial or the outro is showing and nothing is animating.
+/// @note An idle world only needs to be updated on input events and animation ticks.
+///
+bool World::isIdle()
+{
+    // Guard: The game is running
+    if (this->stageController->isGameActive())
+    {
+        return false;
+    }
+
+    // Explosions and smoke remove themselves at the end of their animations, so they must run at full rate
+    auto counts = this->entityManager->getEntityCounts();
+
+    return counts.explosions == 0 && counts.smokes == 0;
+}
+
+///
+/// Enable or disable the idle mode
+///
+/// @param enabled Pass `false` to run all systems at full rate on the menu screens as well.
+/// @note The idle mode is enabled by default.
+///
+void World::setIdleModeEnabled(bool enabled)
+{
+    this->idleModeEnabled = enabled;
+}
+
+///
+/// Keep snapshots of the last few seconds of play so that it can be rewound by pressing F3
+///
+/// @param duration The play time to keep in milliseconds; 0 to disable rewinding
+/// @param interval The interval between two snapshots in milliseconds
+/// @return `true` on success, `false` otherwise.
+///
+bool World::setRewindBuffer(float duration, float interval)
+{
+    return this->snapshots.configure(duration, interval);
+}
+
+///
+/// Skip the intro screen and start a soak test that loops all stages unattended
+///
+/// @param monitor A non-null monitor that has been started; the world does not manage its memory
+///
+void World::startSoak(SoakMonitor* monitor)
+{
+    this->entityManager->removeIntroUI();
+
+    this->stageController->enterSoak();
+
+    this->soakMonitor = monitor;
+}
+
+///
+/// Show or hide the frame statistics overlay
+///
+/// @param visible Pass `true` to show the overlay, `false` to hide it.
+/// @note Showing the overlay also starts the frame profiler.
+///
+void World::setProfilerOverlayVisible(bool visible)
+{
+    if (visible)
+    {
+        FrameProfiler::shared()->setEnabled(true);
+
+        // Refresh the overlay on the next tick
+        this->sinceOverlayRefresh = World::PROFILER_OVERLAY_REFRESH_INTERVAL;
+    }
+    else
+    {
+        this->removeProfilerOverlayLabels();
+    }
+
+    this->profilerOverlayVisible = visible;
+}
+
+///
+/// [Private Helper] Refresh the frame statistics overlay periodically
+///
+/// @param ms The elapsed time since the last tick
+///
+void World::updateProfilerOverlay(float ms)
+{
+    // Guard: The overlay must be visible
+    if (!this->profilerOverlayVisible)
+    {
+        return;
+    }
+
+    this->sinceOverlayRefresh += ms;
+
+    // Guard: Formatting the statistics every frame would make the overlay unreadable, so only do it once in a while
+    if (this->sinceOverlayRefresh < World::PROFILER_OVERLAY_REFRESH_INTERVAL)
+    {
+        return;
+    }
+
+    this->sinceOverlayRefresh = 0;
+
+    auto profiler = FrameProfiler::shared();
+
+    auto frame = profiler->getStatistics(ProfileSection::Frame);
+
+    // Find the most expensive system or stage controller by its p95
+    auto slowest = ProfileSection::StageController;
+
+    auto slowestStatistics = profiler->getStatistics(slowest);
+
+    for (auto section = static_cast<uint32_t>(ProfileSection::MotionSystem); section <= static_cast<uint32_t>(ProfileSection::AnimationSystem); section++)
+    {
+        auto statistics = profiler->getStatistics(static_cast<ProfileSection>(section));
+
+        if (statistics.p95 > slowestStatistics.p95)
+        {
+            slowest = static_cast<ProfileSection>(section);
+
+            slowestStatistics = statistics;
+        }
+    }
+
+    // The labels are made once and only regenerate their glyph quads afterwards
+    if (this->profilerLabels[0] == 0)
+    {
+        Position position(16, 690);
+
+        this->entityManager->makeTextLabel(this->profilerLabels[0], position, Character::Font::SFMonoRegular, Color::black, 14, "");
+
+        position = {16, 706};
+
+        this->entityManager->makeTextLabel(this->profilerLabels[1], position, Character::Font::SFMonoRegular, Color::black, 14, "");
+    }
+
+    this->entityManager->updateTextLabel(this->profilerLabels[0], "FRAME P50 %.2f P95 %.2f P99 %.2f MAX %.2f MS",
+                                         frame.p50, frame.p95, frame.p99, frame.max);
+
+    this->entityManager->updateTextLabel(this->profilerLabels[1], "%s P95 %.2f MAX %.2f MS",
+                                         FrameProfiler::nameForSection(slowest), slowestStatistics.p95, slowestStatistics.max);
+}
+
+///
+/// [Private Helper] Remove the labels of the frame statistics overlay
+///
+void World::removeProfilerOverlayLabels()
+{
+    for (auto& label : this->profilerLabels)
+    {
+        this->entityManager->removeTextLabel(label);
+    }
+}
+
 void World::saveGame()
 {
+    SW_TRACE_SCOPE("World::saveGame", "io");
+
     SaveGame saveGameData;
     // Save data from the StageController
     stageController->saveGame(&saveGameData.scData);
@@ -684,6 +939,8 @@ bool World::ReadSaveFromFile(SaveGame* saveData)
 
 bool World::loadGame()
 {
+    SW_TRACE_SCOPE("World::loadGame", "io");
+
     SaveGame saveData;
     if(ReadSaveFromFile(&saveData))
     {
@@ -694,6 +951,9 @@ bool World::loadGame()
         entityManager->updateStageLabel(saveData.scData.stage);
         entityManager->updateMoneyLabel(saveData.scData.money);
         entityManager->updateScoreLabel(saveData.scData.score);
+
+        // Snapshots of the game before the load must not be rewound into
+        this->snapshots.clear();
         return true;
     }
     SoundPlayer::shared()->playErrorSoundEffect();
@@ -750,6 +1010,15 @@ void World::onKeyEvent(GLFWwindow* window, int key, int scancode, int action, in
         saveGame();
     } else if (key == GLFW_KEY_R && action == GLFW_PRESS) {
         loadGame();
+    } else if (key == GLFW_KEY_F1 && action == GLFW_PRESS) {
+        this->setProfilerOverlayVisible(!this->profilerOverlayVisible);
+    } else if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+        // Stopping the recorder flushes the events to its output file
+        TraceRecorder::shared()->setEnabled(!TraceRecorder::shared()->isEnabled());
+    } else if (key == GLFW_KEY_F3 && action == GLFW_PRESS && this->stageController->canTakeSnapshot()) {
+        if (!this->snapshots.rewind(World::REWIND_STEP, this->entityManager, this->stageController)) {
+            SoundPlayer::shared()->playErrorSoundEffect();
+        }
     }
 
     if (lKey && rKey) {
@@ -772,6 +1041,8 @@ void World::onKeyEvent(GLFWwindow* window, int key, int scancode, int action, in
 ///
 void World::onMouseMoveEvent(GLFWwindow* window, double xpos, double ypos)
 {
+    cursorPosition = {(float) xpos, (float) ypos};
+
     // TODO: IMP THIS
     mouseIsOverNewGame = false;
     if(xpos > 394.f && xpos < 628.f)
@@ -803,12 +1074,7 @@ void World::onMouseMoveEvent(GLFWwindow* window, double xpos, double ypos)
 void World::onMouseButtonEvent(GLFWwindow* window, int button, int action, int mods)
 {
     if (this->stageController->isGameActive() && button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-        double xPos;
-        double yPos;
-        glfwGetCursorPos(window, &xPos, &yPos);
-        float xPosF = (float) xPos;
-        float yPosF = (float) yPos;
-        this->inputSystem->doLeftClick({xPosF, yPosF});
+        this->inputSystem->doLeftClick(cursorPosition);
     }
     
     // If we are in the tutorial then we should exit as the user has clicked
@@ -839,6 +1105,13 @@ void World::onMouseButtonEvent(GLFWwindow* window, int button, int action, int m
             GLFWwindow* window = this->windowController->getMainWindow();
             auto keycb = [](GLFWwindow* window, int key, int scancode, int action, int mods)
             {
+                if (Replay::shared()->isPlaying())
+                {
+                    return;
+                }
+
+                Replay::shared()->recordKeyEvent(key, scancode, action, mods);
+
                 ((World*) glfwGetWindowUserPointer(window))->onKeyEvent(window, key, scancode, action, mods);
             };
             glfwSetKeyCallback(window, keycb);
@@ -849,8 +1122,51 @@ void World::onMouseButtonEvent(GLFWwindow* window, int button, int action, int m
             
             if(mouseIsOverNewGame)
             {
+                // Snapshots of the previous run must not be rewound into
+                this->snapshots.clear();
+
                 this->stageController->enterTutorial();
             }
         }
     }
 }
+
+//
+// MARK:- Replay Delegate IMP
+//
+
+///
+/// Called when the replay plays back a key event
+///
+/// @param key The keyboard key that was pressed or released
+/// @param scancode The system-specific scancode of the key
+/// @param action One of key action `GLFW_PRESS`, `GLFW_RELEASE` or `GLFW_REPEAT`
+/// @param mods Bit field describing which modifier keys were held down
+///
+void World::replayDidPlayKeyEvent(int key, int scancode, int action, int mods)
+{
+    this->onKeyEvent(this->windowController->getMainWindow(), key, scancode, action, mods);
+}
+
+///
+/// Called when the replay plays back a mouse move event
+///
+/// @param xpos The new cursor x-coordinate, relative to the left edge of the content area
+/// @param ypos The new cursor y-coordinate, relative to the top edge of the content area
+///
+void World::replayDidPlayMouseMoveEvent(double xpos, double ypos)
+{
+    this->onMouseMoveEvent(this->windowController->getMainWindow(), xpos, ypos);
+}
+
+///
+/// Called when the replay plays back a mouse button event
+///
+/// @param button The mouse button that was pressed or released.
+/// @param action One of button action `GLFW_PRESS` or `GLFW_RELEASE`
+/// @param mods Bit field describing which modifier keys were held down
+///
+void World::replayDidPlayMouseButtonEvent(int button, int action, int mods)
+{
+    this->onMouseButtonEvent(this->windowController->getMainWindow(), button, action, mods);
+}
@@ -10,6 +10,7 @@
 #define World_hpp
 
 #include "Foundations/Foundations.hpp"
+#include "Foundations/FrameProfiler.hpp"
 #include "Systems/RenderSystem.hpp"
 #include "Systems/MotionSystem.hpp"
 #include "Systems/InputSystem.hpp"
@@ -19,18 +20,25 @@
 #include "Systems/PathingSystem.hpp"
 #include "WindowController.hpp"
 #include "StageController.hpp"
+#include "ReplayDelegate.hpp"
+#include "SoakMonitor.hpp"
+#include "SnapshotRing.hpp"
 
 /// Submarine Wars World
-class World
+class World : public ReplayDelegate
 {
+    /// Microbenchmarks measure the save file and the collision system directly
+    friend class Benchmarks;
+
 public:
     ///
     /// Initialize the game world
     ///
     /// @param size The screen size (width, height)
+    /// @param headless Pass `true` to run without a visible window, rendering and vsync, e.g. to play back a replay
     /// @return `true` on successfully initialized the world, `false` otherwise.
     ///
-    bool init(ScreenSize size);
+    bool init(ScreenSize size, bool headless = false);
     
     ///
     /// Destory the game world and release allocated resources
@@ -52,6 +60,49 @@ public:
     ///
     bool isOver() const;
 
+    ///
+    /// Check whether the world is idle
+    ///
+    /// @return `true` if the intro, the tutorial or the outro is showing and nothing is animating.
+    /// @note An idle world only needs to be updated on input events and animation ticks.
+    ///
+    bool isIdle();
+
+    ///
+    /// Enable or disable the idle mode
+    ///
+    /// @param enabled Pass `false` to run all systems at full rate on the menu screens as well.
+    /// @note The idle mode is enabled by default.
+    ///
+    void setIdleModeEnabled(bool enabled);
+
+    ///
+    /// Show or hide the frame statistics overlay
+    ///
+    /// @param visible Pass `true` to show the overlay, `false` to hide it.
+    /// @note Showing the overlay also starts the frame profiler.
+    ///
+    void setProfilerOverlayVisible(bool visible);
+
+    ///
+    /// Skip the intro screen and start a soak test that loops all stages unattended
+    ///
+    /// @param monitor A non-null monitor that has been started; the world does not manage its memory
+    ///
+    void startSoak(SoakMonitor* monitor);
+
+    ///
+    /// Keep snapshots of the last few seconds of play so that it can be rewound by pressing F3
+    ///
+    /// @param duration The play time to keep in milliseconds; 0 to disable rewinding
+    /// @param interval The interval between two snapshots in milliseconds
+    /// @return `true` on success, `false` otherwise.
+    ///
+    bool setRewindBuffer(float duration, float interval = SnapshotRing::DEF_INTERVAL);
+
+    /// The interval between two animation ticks while the world is idle in milliseconds
+    static constexpr float IDLE_FRAME_INTERVAL = 100.f;
+
     EntityManager* entityManager;
     
 private:
@@ -97,6 +148,52 @@ private:
     
     /// Indicates the mouse is over the "load game" button on the intro UI
     bool mouseIsOverLoadGame;
+
+    /// The last cursor position reported by a mouse move event
+    /// @note Mouse button events use this position rather than querying the window so that they can be replayed.
+    vec2 cursorPosition;
+
+    /// Indicates the world runs without a visible window and skips rendering
+    bool headless;
+
+    /// Indicates the simulation systems are skipped while the world is idle
+    bool idleModeEnabled;
+
+    /// The play time rewound by each press of F3 in milliseconds
+    static constexpr float REWIND_STEP = 1000.f;
+
+    /// Snapshots of the last few seconds of play
+    SnapshotRing snapshots;
+
+    /// The interval between two refreshes of the frame statistics overlay in milliseconds
+    static constexpr float PROFILER_OVERLAY_REFRESH_INTERVAL = 500.f;
+
+    /// Indicates the frame statistics overlay is visible
+    bool profilerOverlayVisible;
+
+    /// Time since the last refresh of the frame statistics overlay
+    float sinceOverlayRefresh;
+
+    /// Labels of the frame statistics overlay
+    TextRenderer::Label profilerLabels[2] = {};
+
+    /// Maps the screen coordinates of the text labels to the normalized device coordinates
+    mat3 textProjection;
+
+    /// The soak test monitor; `nullptr` if no soak test is running
+    SoakMonitor* soakMonitor;
+
+    ///
+    /// [Private Helper] Refresh the frame statistics overlay periodically
+    ///
+    /// @param ms The elapsed time since the last tick
+    ///
+    void updateProfilerOverlay(float ms);
+
+    ///
+    /// [Private Helper] Remove the labels of the frame statistics overlay
+    ///
+    void removeProfilerOverlayLabels();
     
     struct SaveGame
     {
@@ -143,6 +240,37 @@ private:
     /// @param mods Bit field describing which modifier keys were held down
     ///
     void onMouseButtonEvent(GLFWwindow* window, int button, int action, int mods);
+
+    //
+    // MARK:- Replay Delegate IMP
+    //
+
+    ///
+    /// Called when the replay plays back a key event
+    ///
+    /// @param key The keyboard key that was pressed or released
+    /// @param scancode The system-specific scancode of the key
+    /// @param action One of key action `GLFW_PRESS`, `GLFW_RELEASE` or `GLFW_REPEAT`
+    /// @param mods Bit field describing which modifier keys were held down
+    ///
+    void replayDidPlayKeyEvent(int key, int scancode, int action, int mods) override;
+
+    ///
+    /// Called when the replay plays back a mouse move event
+    ///
+    /// @param xpos The new cursor x-coordinate, relative to the left edge of the content area
+    /// @param ypos The new cursor y-coordinate, relative to the top edge of the content area
+    ///
+    void replayDidPlayMouseMoveEvent(double xpos, double ypos) override;
+
+    ///
+    /// Called when the replay plays back a mouse button event
+    ///
+    /// @param button The mouse button that was pressed or released.
+    /// @param action One of button action `GLFW_PRESS` or `GLFW_RELEASE`
+    /// @param mods Bit field describing which modifier keys were held down
+    ///
+    void replayDidPlayMouseButtonEvent(int button, int action, int mods) override;
 };
 
 #endif /* World_hpp */
@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <chrono>
+#include <ctime>
+#include <string.h>
 
 #define GL3W_IMPLEMENTATION
 #include <gl3w.h>
@@ -22,6 +24,10 @@
 
 #include "Foundations/Foundations.hpp"
 #include "World.hpp"
+#include "Foundations/FrameProfiler.hpp"
+#include "Replay.hpp"
+#include "StageGenerator.hpp"
+#include "SoakMonitor.hpp"
 
 using Clock = std::chrono::high_resolution_clock;
 
@@ -30,24 +36,283 @@ int main(int argc, const char * argv[])
     World world;
     
     ScreenSize size = { 1280, 720 };
+
+    // Parse the command line options
+    bool showsProfilerOverlay = false;
+
+    const char* profilerDumpPath = nullptr;
+
+    float profilerDumpInterval = 1000.f;
+
+    const char* tracePath = nullptr;
+
+    float traceHitchThreshold = 0;
+
+    float traceHitchWindow = TraceRecorder::DEF_HITCH_WINDOW;
+
+    const char* recordPath = nullptr;
+
+    const char* replayPath = nullptr;
+
+    bool headless = false;
+
+    const char* stagesGenerationPath = nullptr;
+
+    StageGenerator::Parameters stagesParameters = StageGenerator::defaultParameters();
+
+    float soakDuration = 0;
+
+    float soakInterval = SoakMonitor::DEF_LOG_INTERVAL;
+
+    const char* soakLogPath = SoakMonitor::DEF_LOG_PATH;
+
+    bool idleModeEnabled = true;
+
+    float rewindDuration = 0;
+
+    float rewindInterval = SnapshotRing::DEF_INTERVAL;
+
+    for (int index = 1; index < argc; index++)
+    {
+        const char* option = argv[index];
+
+        bool hasValue = index + 1 < argc;
+
+        if (strcmp(option, "--profile") == 0)
+        {
+            FrameProfiler::shared()->setEnabled(true);
+        }
+        else if (strcmp(option, "--profile-overlay") == 0)
+        {
+            showsProfilerOverlay = true;
+        }
+        else if (strcmp(option, "--profile-window") == 0 && hasValue)
+        {
+            FrameProfiler::shared()->setWindowSize((uint32_t) atoi(argv[++index]));
+        }
+        else if (strcmp(option, "--profile-dump") == 0 && hasValue)
+        {
+            profilerDumpPath = argv[++index];
+        }
+        else if (strcmp(option, "--profile-dump-interval") == 0 && hasValue)
+        {
+            profilerDumpInterval = (float) atof(argv[++index]);
+        }
+        else if (strcmp(option, "--trace") == 0 && hasValue)
+        {
+            tracePath = argv[++index];
+        }
+        else if (strcmp(option, "--trace-capacity") == 0 && hasValue)
+        {
+            TraceRecorder::shared()->setCapacity((uint32_t) atoi(argv[++index]));
+        }
+        else if (strcmp(option, "--trace-hitch") == 0 && hasValue)
+        {
+            traceHitchThreshold = (float) atof(argv[++index]);
+        }
+        else if (strcmp(option, "--trace-hitch-window") == 0 && hasValue)
+        {
+            traceHitchWindow = (float) atof(argv[++index]);
+        }
+        else if (strcmp(option, "--record") == 0 && hasValue)
+        {
+            recordPath = argv[++index];
+        }
+        else if (strcmp(option, "--replay") == 0 && hasValue)
+        {
+            replayPath = argv[++index];
+        }
+        else if (strcmp(option, "--headless") == 0)
+        {
+            headless = true;
+        }
+        else if (strcmp(option, "--no-idle") == 0)
+        {
+            idleModeEnabled = false;
+        }
+        else if (strcmp(option, "--rewind") == 0 && hasValue)
+        {
+            rewindDuration = (float) atof(argv[++index]) * 1000;
+        }
+        else if (strcmp(option, "--rewind-interval") == 0 && hasValue)
+        {
+            rewindInterval = (float) atof(argv[++index]);
+        }
+        else if (strcmp(option, "--stages") == 0 && hasValue)
+        {
+            Stage::setDirectory(argv[++index]);
+        }
+        else if (strcmp(option, "--generate-stages") == 0 && hasValue)
+        {
+            stagesGenerationPath = argv[++index];
+        }
+        else if (strcmp(option, "--gen-stages") == 0 && hasValue)
+        {
+            stagesParameters.numStages = (uint32_t) atoi(argv[++index]);
+        }
+        else if (strcmp(option, "--gen-subs") == 0 && hasValue)
+        {
+            unsigned int counts[3] = {};
+
+            sscanf(argv[++index], "%u,%u,%u", &counts[0], &counts[1], &counts[2]);
+
+            stagesParameters.subcounts[Submarine::Type::I] = counts[0];
+
+            stagesParameters.subcounts[Submarine::Type::II] = counts[1];
+
+            stagesParameters.subcounts[Submarine::Type::III] = counts[2];
+        }
+        else if (strcmp(option, "--gen-fish") == 0 && hasValue)
+        {
+            stagesParameters.fishcount = (uint32_t) atoi(argv[++index]);
+        }
+        else if (strcmp(option, "--gen-spawn-interval") == 0 && hasValue)
+        {
+            stagesParameters.spawnInterval = (float) atof(argv[++index]);
+        }
+        else if (strcmp(option, "--gen-wave-size") == 0 && hasValue)
+        {
+            stagesParameters.spawnWaveSize = (uint32_t) atoi(argv[++index]);
+        }
+        else if (strcmp(option, "--gen-radar") == 0 && hasValue)
+        {
+            sscanf(argv[++index], "%f,%f", &stagesParameters.subrrrange.lower, &stagesParameters.subrrrange.upper);
+        }
+        else if (strcmp(option, "--soak") == 0 && hasValue)
+        {
+            soakDuration = (float) atof(argv[++index]) * 60000;
+        }
+        else if (strcmp(option, "--soak-interval") == 0 && hasValue)
+        {
+            soakInterval = (float) atof(argv[++index]) * 1000;
+        }
+        else if (strcmp(option, "--soak-log") == 0 && hasValue)
+        {
+            soakLogPath = argv[++index];
+        }
+        else
+        {
+            pwarning("Ignored the unknown command line option %s.", option);
+        }
+    }
+
+    // Generating stress stages does not need the game
+    if (stagesGenerationPath != nullptr)
+    {
+        return StageGenerator::generate(stagesGenerationPath, stagesParameters) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // A soak test runs unattended and needs the frame time percentiles
+    SoakMonitor soakMonitor;
+
+    if (soakDuration > 0)
+    {
+        headless = true;
+
+        FrameProfiler::shared()->setEnabled(true);
+
+        if (!soakMonitor.start(soakLogPath, soakDuration, soakInterval))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (profilerDumpPath != nullptr)
+    {
+        // The format is determined by the file extension
+        auto extension = strrchr(profilerDumpPath, '.');
+
+        bool isJSON = extension != nullptr && strcmp(extension, ".json") == 0;
+
+        FrameProfiler::shared()->setPeriodicDump(profilerDumpPath, profilerDumpInterval, isJSON ? FrameProfiler::Format::JSON : FrameProfiler::Format::CSV);
+
+        FrameProfiler::shared()->setEnabled(true);
+    }
+
+    // Record from launch so that the asset loading is captured as well
+    if (tracePath != nullptr)
+    {
+        TraceRecorder::shared()->setOutputPath(tracePath);
+
+        TraceRecorder::shared()->setEnabled(true);
+    }
+
+    TraceRecorder::shared()->setHitchCapture(traceHitchThreshold, traceHitchWindow);
+
+    if (traceHitchThreshold > 0)
+    {
+        TraceRecorder::shared()->setEnabled(true);
+    }
     
-    if (!world.init(size))
+    if (!world.init(size, headless))
     {
         pserror("Failed to initialize the game world.");
         
         return EXIT_FAILURE;
     }
+
+    if (replayPath != nullptr)
+    {
+        if (!Replay::shared()->startPlaying(replayPath))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    else if (recordPath != nullptr)
+    {
+        passert(Replay::shared()->startRecording(recordPath), "Failed to start recording the replay.");
+    }
+
+    world.setProfilerOverlayVisible(showsProfilerOverlay);
+
+    world.setIdleModeEnabled(idleModeEnabled);
+
+    if (!world.setRewindBuffer(rewindDuration, rewindInterval))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (soakDuration > 0)
+    {
+        world.startSoak(&soakMonitor);
+    }
+
     //printf("Boat mass is now %f\n\n", world.entityManager->componentsForType<Physics>()[0].mass);
     
     auto t = Clock::now();
 
+    // The processor time and the wall time spent on the menu screens in milliseconds
+    std::clock_t cpuTime = std::clock();
+
+    double menuCPUTime = 0;
+
+    double menuWallTime = 0;
+
     //printf("First world update. ");
 
     // variable timestep loop.. can be improved (:
     while (!world.isOver())
     {
+        bool idle = world.isIdle();
+
+        // The time spent waiting for events in milliseconds, which is not part of the frame
+        float waited_sec = 0;
+
         // Processes system messages, if this wasn't present the window would become unresponsive
-        glfwPollEvents();
+        // Nothing moves on the menu screens, so sleep until an input event arrives or the next animation tick is due
+        // A replay does not wait since its input events are not delivered by the window
+        if (idle && idleModeEnabled && !Replay::shared()->isPlaying())
+        {
+            auto waitStart = Clock::now();
+
+            glfwWaitEventsTimeout(World::IDLE_FRAME_INTERVAL / 1000);
+
+            waited_sec = (float)(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - waitStart)).count() / 1000;
+        }
+        else
+        {
+            glfwPollEvents();
+        }
         
         // Calculating elapsed times in milliseconds from the previous iteration
         auto now = Clock::now();
@@ -55,13 +320,65 @@ int main(int argc, const char * argv[])
         float elapsed_sec = (float)(std::chrono::duration_cast<std::chrono::microseconds>(now - t)).count() / 1000;
         
         t = now;
+
+        std::clock_t cpuNow = std::clock();
+
+        if (idle)
+        {
+            menuCPUTime += (double) (cpuNow - cpuTime) * 1000 / CLOCKS_PER_SEC;
+
+            menuWallTime += elapsed_sec;
+        }
+
+        cpuTime = cpuNow;
+
+        // A soak test simulates 60 FPS regardless of how fast the frames are actually processed
+        if (soakDuration > 0)
+        {
+            elapsed_sec = 1000.f / 60;
+        }
+
+        // On playback, the recorded input events are dispatched and the recorded frame time replaces the measured one
+        // A headless session has nothing left to do once the replay ends
+        if (!Replay::shared()->advanceFrame(elapsed_sec, &world) && headless)
+        {
+            break;
+        }
+
         //printf("Boat mass or bass if you will is %f before update, and ", world.entityManager->componentsForType<Physics>()[0].mass);
         world.update(elapsed_sec);
         //printf(" %f after. \n\n", world.entityManager->componentsForType<Physics>()[0].mass);
 
+        // An idle frame sleeps on purpose, so only the time it actually worked counts towards a hitch
+        TraceRecorder::shared()->frameDidEnd(elapsed_sec - waited_sec);
+
+        if (soakMonitor.isFinished())
+        {
+            break;
+        }
+
     }
     
+    if (menuWallTime > 0)
+    {
+        pinfo("Spent %.1f seconds on the menu screens at %.1f%% CPU usage with the idle mode %s.",
+              menuWallTime / 1000, 100 * menuCPUTime / menuWallTime, idleModeEnabled ? "on" : "off");
+    }
+
+    Replay::shared()->stop();
+
+    soakMonitor.stop();
+
     world.destroy();
+
+    // Flush the remaining events to the output file
+    TraceRecorder::shared()->setEnabled(false);
+
+    // A replay that no longer matches the game is a failure, e.g. for regression runs
+    if (Replay::shared()->isDesynchronized())
+    {
+        return EXIT_FAILURE;
+    }
     
     return 0;
 }